@@ -0,0 +1,156 @@
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <ctime>
+#include "algorithmProfiler.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "observableTracker.hpp"
+#include "measurementSink.hpp"
+#include "latticeEquilibrationFactory.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    AlgorithmProfile::AlgorithmProfile(const string& algorithm, double delta) :
+        equilibrationAlgorithm {algorithm},
+        deltaMetro       {delta},
+        Nsteps           {0},
+        measureEvery     {1},
+        cpuTime          {0.},
+        costPerStep      {0.},
+        tauMax           {0.},
+        samplesPerSecond {0.} {}
+
+    string AlgorithmProfile::getName() const
+    {
+        stringstream name;
+        name << equilibrationAlgorithm;
+        if (equilibrationAlgorithm == "metropolis")
+            name << "_delta" << deltaMetro;
+        return name.str();
+    }
+
+    ostream& operator<<(ostream& out, const AlgorithmProfile& a)
+    {
+        out << a.getName() << endl;
+        out << "\t steps          = " << a.Nsteps << " (measured every " << a.measureEvery << ")" << endl;
+        out << "\t cost per step  = " << a.costPerStep << " s" << endl;
+        out << "\t tau q          = " << a.tauQ << endl;
+        out << "\t tau action     = " << a.tauAction << endl;
+        out << "\t tau meanPhiSq  = " << a.tauMeanPhiSq << endl;
+        out << "\t samples per s  = " << a.samplesPerSecond << endl;
+        return out;
+    }
+
+
+    AlgorithmProfiler::AlgorithmProfiler(const ParameterContainer& p) :
+        parameters {p}
+    {
+        profiles.push_back(AlgorithmProfile("metropolis", 0.5 * p.deltaMetro));
+        profiles.push_back(AlgorithmProfile("metropolis", p.deltaMetro));
+        profiles.push_back(AlgorithmProfile("metropolis", 2. * p.deltaMetro));
+        profiles.push_back(AlgorithmProfile("cluster", p.deltaMetro));
+    }
+
+    void AlgorithmProfiler::run(mt19937_64& generator)
+    {
+        for (unsigned int i=0; i<profiles.size(); i++)
+        {
+            runProfile(profiles[i], generator);
+            if (parameters.verbosity > 2)
+                cout << profiles[i];
+        }
+    }
+
+    void AlgorithmProfiler::runProfile(AlgorithmProfile& profile, mt19937_64& generator)
+    {
+        typedef chrono::steady_clock Clock;
+
+        ParameterContainer p = parameters;
+        p.equilibrationAlgorithm = profile.equilibrationAlgorithm;
+        p.deltaMetro = profile.deltaMetro;
+
+        LatticeContainer lattice(p);
+        lattice.setBoundaries(p);
+        lattice.setRandom(generator);
+
+        LatticeEquilibration *latticeEquilibration = NewLatticeEquilibrationFor(&lattice, p);
+        latticeEquilibration->run(generator, p.Nthermal, 1, NULL);
+
+        lattice.mod2Pi();
+        ObservableTracker tracker(&lattice, p);
+        latticeEquilibration->setTracker(&tracker);
+
+        // estimate cost per step with doubling number of steps
+        double cost = 0.;
+        for (int n=64; ; n*=2)
+        {
+            clock_t start = clock();
+            latticeEquilibration->run(generator, n, 1, NULL);
+            cost = (clock() - start) / (double)CLOCKS_PER_SEC / n;
+            if ((n * cost > 0.02 * p.profileTime) || (n >= (1 << 24)))
+                break;
+        }
+        if (cost <= 0.)
+            cost = 1E-9;
+
+        // thin measurements, run in chunks of about 1/20 of the budget
+        long NstepsEstimate = (long)(p.profileTime / cost);
+        profile.measureEvery = max(1L, NstepsEstimate / maxProfileSamples);
+        long chunk = max(1L, (long)(0.05 * p.profileTime / cost) / profile.measureEvery) * profile.measureEvery;
+
+        SeriesSink sink(&tracker);
+        Clock::time_point wallStart = Clock::now();
+        clock_t cpuStart = clock();
+        profile.Nsteps = 0;
+        while (chrono::duration<double>(Clock::now() - wallStart).count() < p.profileTime)
+        {
+            latticeEquilibration->run(generator, (int)chunk, profile.measureEvery, &sink);
+            profile.Nsteps += chunk;
+        }
+        profile.cpuTime = (clock() - cpuStart) / (double)CLOCKS_PER_SEC;
+        profile.costPerStep = profile.cpuTime / profile.Nsteps;
+
+        profile.tauQ.analyse(sink.q);
+        profile.tauAction.analyse(sink.action);
+        profile.tauMeanPhiSq.analyse(sink.meanPhiSq);
+
+        // the slowest observable limits the number of independent samples
+        profile.tauMax = profile.measureEvery * max(profile.tauQ.tauInt,
+                                                    max(profile.tauAction.tauInt, profile.tauMeanPhiSq.tauInt));
+        profile.samplesPerSecond = profile.Nsteps / (2. * profile.tauMax) / profile.cpuTime;
+
+        delete latticeEquilibration;
+    }
+
+    const AlgorithmProfile& AlgorithmProfiler::getBest()
+    {
+        int best = 0;
+        for (unsigned int i=1; i<profiles.size(); i++)
+            if (profiles[i].samplesPerSecond > profiles[best].samplesPerSecond)
+                best = i;
+        return profiles[best];
+    }
+
+    void AlgorithmProfiler::writeToFile()
+    {
+        FileObs fProfile("AlgorithmProfile", parameters);
+        fProfile.create();
+
+        fProfile.f << "# algorithm\tdeltaMetro\tNsteps\tcostPerStep\ttauQ\ttauAction\ttauMeanPhiSq\tsamplesPerSecond" << endl;
+        for (unsigned int i=0; i<profiles.size(); i++)
+        {
+            const AlgorithmProfile& a = profiles[i];
+            fProfile.f << a.equilibrationAlgorithm << "\t" << a.deltaMetro << "\t" << a.Nsteps << "\t"
+                       << a.costPerStep << "\t"
+                       << a.measureEvery * a.tauQ.tauInt << "\t"
+                       << a.measureEvery * a.tauAction.tauInt << "\t"
+                       << a.measureEvery * a.tauMeanPhiSq.tauInt << "\t"
+                       << a.samplesPerSecond << endl;
+        }
+    }
+
+} // TopoOsciSim
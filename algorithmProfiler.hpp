@@ -0,0 +1,109 @@
+#ifndef ALGORITHMPROFILER_H
+#define ALGORITHMPROFILER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include "parameters.hpp"
+#include "autocorrelation.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Maximal number of stored measurements per observable
+    const int maxProfileSamples = 100000;
+
+    // Result of profiling one algorithm
+    class AlgorithmProfile
+    {
+    public:
+
+        string equilibrationAlgorithm;
+        double deltaMetro;
+
+        // Production steps, steps between measurements and their cpu time
+        long Nsteps;
+        int measureEvery;
+        double cpuTime;
+
+        // cpu seconds per step
+        double costPerStep;
+
+        // Autocorrelation in units of measurements
+        AutocorrelationContainer tauQ;
+        AutocorrelationContainer tauAction;
+        AutocorrelationContainer tauMeanPhiSq;
+
+        // Largest integrated autocorrelation time in units of steps
+        double tauMax;
+
+        // Effective independent samples per cpu second
+        double samplesPerSecond;
+
+        AlgorithmProfile(const string& algorithm, double delta);
+
+        // Name of algorithm including its tuning
+        string getName() const;
+
+        /**
+           Return ostream for AlgorithmProfile class
+
+           @param out Ostream where output goes
+           @param a   This class
+           @return    Ostream including a
+        */
+        friend ostream& operator<<(ostream& out, const AlgorithmProfile& a);
+    };
+
+
+    /**
+       Run each LatticeEquilibration for profileTime wall-clock seconds
+       on the same parameters and compare the effective independent
+       samples per cpu second
+    */
+    class AlgorithmProfiler
+    {
+
+    public:
+
+        ParameterContainer parameters;
+
+        vector<AlgorithmProfile> profiles;
+
+        /**
+           Create profiler with metropolis at 0.5, 1 and 2 times
+           deltaMetro and cluster as candidates
+
+           @param p Parameters
+        */
+        AlgorithmProfiler(const ParameterContainer& p);
+
+        /**
+           Profile all candidates
+
+           @param generator Random generator
+        */
+        void run(mt19937_64& generator);
+
+        /**
+           Thermalize, estimate cost per step and run for profileTime
+           seconds. Measurements are thinned to maxProfileSamples.
+
+           @param profile   Candidate to profile
+           @param generator Random generator
+        */
+        void runProfile(AlgorithmProfile& profile, mt19937_64& generator);
+
+        // Return candidate with most samples per cpu second
+        const AlgorithmProfile& getBest();
+
+        // Write table of all candidates to output directory
+        void writeToFile();
+    };
+
+} // TopoOsciSim
+
+#endif // ALGORITHMPROFILER_H
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <cmath>
+#include "autocorrelation.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    AutocorrelationContainer::AutocorrelationContainer() :
+        mean        {0.},
+        variance    {0.},
+        tauInt      {0.5},
+        tauIntError {0.},
+        window      {0},
+        frozen      {false},
+        S           {1.5} {}
+
+    ostream& operator<<(ostream& out, const AutocorrelationContainer& a)
+    {
+        out << a.tauInt << " +- " << a.tauIntError << " (W = " << a.window << ")";
+        if (a.frozen)
+            out << " frozen";
+        return out;
+    }
+
+    // Return autocorrelation function at separation t
+    double AutocorrelationContainer::getGamma(const vector<double>& series, int t)
+    {
+        int n = series.size();
+        double sum = 0.;
+        for (int i=0; i+t<n; i++)
+            sum += (series[i] - mean) * (series[i+t] - mean);
+        return sum / (double)(n - t);
+    }
+
+    // Compute mean, variance and integrated autocorrelation time
+    void AutocorrelationContainer::analyse(const vector<double>& series)
+    {
+        int n = series.size();
+
+        mean = 0.;
+        for (int i=0; i<n; i++)
+            mean += series[i];
+        mean /= n;
+
+        variance = getGamma(series, 0);
+        frozen = (variance <= 1E-14 * (mean * mean + 1E-300));
+        if (frozen)
+        {
+            tauInt = 0.5 * n;
+            tauIntError = tauInt;
+            window = n;
+            return;
+        }
+
+        // sum Gamma(t)/Gamma(0) until the estimated systematic error
+        // exp(-W/tau) gets smaller than the statistical one
+        double tau, g;
+        tauInt = 0.5;
+        for (window=1; window<n/2; window++)
+        {
+            tauInt += getGamma(series, window) / variance;
+
+            if (tauInt <= 0.5)
+                tau = 1E-12;
+            else
+                tau = S / log((2*tauInt + 1) / (2*tauInt - 1));
+
+            g = exp(-window / tau) - tau / sqrt((double)window * n);
+            if (g < 0)
+                break;
+        }
+
+        tauIntError = tauInt * sqrt(2. * (2 * window + 1) / n);
+    }
+
+    double AutocorrelationContainer::getErrorOfMean(int n)
+    {
+        return sqrt(2 * tauInt * variance / n);
+    }
+
+} // TopoOsciSim
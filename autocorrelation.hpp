@@ -0,0 +1,72 @@
+#ifndef AUTOCORRELATION_H
+#define AUTOCORRELATION_H
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Integrated autocorrelation time of a Monte Carlo time series
+       with the automatic windowing procedure of U. Wolff,
+       Comput. Phys. Commun. 156 (2004) 143.
+    */
+    class AutocorrelationContainer
+    {
+
+    public:
+
+        double mean;
+        double variance;
+
+        // Integrated autocorrelation time (0.5 for uncorrelated data)
+        double tauInt;
+        double tauIntError;
+
+        // Summation window
+        int window;
+
+        // true if the series is constant (no information about tauInt)
+        bool frozen;
+
+        // Ratio of exponential and integrated autocorrelation time (S in Wolff's paper)
+        double S;
+
+        AutocorrelationContainer();
+
+        /**
+           Return ostream for AutocorrelationContainer class
+
+           @param out Ostream where output goes
+           @param a   This class
+           @return    Ostream including a
+        */
+        friend ostream& operator<<(ostream& out, const AutocorrelationContainer& a);
+
+        /**
+           Compute mean, variance and integrated autocorrelation time.
+           A frozen series gets tauInt = n/2 (one independent sample).
+
+           @param series Time series
+        */
+        void analyse(const vector<double>& series);
+
+        /**
+           Return autocorrelation function at separation t
+
+           @param series Time series
+           @param t      Separation
+           @return       Gamma(t)
+        */
+        double getGamma(const vector<double>& series, int t);
+
+        // Return error of mean including autocorrelations
+        double getErrorOfMean(int n);
+    };
+
+} // TopoOsciSim
+
+#endif // AUTOCORRELATION_H
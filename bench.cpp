@@ -0,0 +1,300 @@
+/**
+   TopoOsciSim
+   bench.cpp
+   Purpose: Micro-benchmarks of the equilibration engines, lattice kernels and configuration I/O
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "fixedLattice.hpp"
+#include "latticeEquilibrationFactory.hpp"
+#include "fastMath.hpp"
+#include "benchmark.hpp"
+
+using namespace std;
+
+// Repeat f (doing reps repetitions) with doubled reps until it takes minTime, return seconds per repetition
+template<class F>
+double timePerRepetition(F f, double minTime)
+{
+    long reps = 1;
+    double t;
+    while (true)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        f(reps);
+        t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (t >= minTime)
+            return t / reps;
+        reps *= 2;
+    }
+}
+
+TopoOsciSim::ParameterContainer getBenchParameters(int xdim, double Ia, const string& algorithm)
+{
+    TopoOsciSim::ParameterContainer p;
+    p.runName = "bench";
+    p.I = Ia;
+    p.a = 1.;
+    p.xdim = xdim;
+    p.equilibrationAlgorithm = algorithm;
+    p.configDirectory = "output/bench/";
+    p.outputDirectory = "output/bench/";
+    return p;
+}
+
+void benchEngines(TopoOsciSim::BenchmarkSuite& suite, mt19937_64& generator)
+{
+    const int xdims[] = {4, 16, 64, 256};
+    const double Ias[] = {0.5, 2., 8.};
+    const string algorithms[] = {"metropolis", "cluster"};
+
+    for (const string& algorithm : algorithms)
+        for (int xdim : xdims)
+            for (double Ia : Ias)
+            {
+                TopoOsciSim::ParameterContainer p = getBenchParameters(xdim, Ia, algorithm);
+                TopoOsciSim::LatticeContainer lattice(p);
+                lattice.setPeriodicBoundaries();
+                lattice.setRandom(generator);
+                TopoOsciSim::LatticeEquilibration* engine = TopoOsciSim::NewLatticeEquilibrationFor(&lattice, p);
+                engine->run(generator, 1000, 1, NULL);
+
+                double t = timePerRepetition([&](long reps) { engine->run(generator, reps, 1, NULL); }, suite.minTime);
+
+                // sites updated per step: xdim for Metropolis, mean
+                // cluster size for the cluster algorithm
+                double sitesPerStep = xdim;
+                TopoOsciSim::ClusterContainer* cluster = dynamic_cast<TopoOsciSim::ClusterContainer*>(engine);
+                if (cluster)
+                {
+                    const int Nsteps = 1000;
+                    long sites = 0;
+                    for (int k=0; k<Nsteps; k++)
+                    {
+                        engine->doStep(generator);
+                        sites += cluster->size;
+                    }
+                    sitesPerStep = sites / (double)Nsteps;
+                }
+
+                string name = algorithm + "/xdim" + to_string(xdim) + "/Ia" + to_string(Ia).substr(0, 3);
+                suite.add(name + "/site-update", 1E9 * t / sitesPerStep, "ns/site-update", true);
+                suite.add(name + "/configs", 1. / t, "configs/s", false);
+                delete engine;
+            }
+}
+
+void benchKernels(TopoOsciSim::BenchmarkSuite& suite, mt19937_64& generator)
+{
+    const int xdims[] = {8, 64};
+
+    for (int xdim : xdims)
+    {
+        TopoOsciSim::ParameterContainer p = getBenchParameters(xdim, 1., "cluster");
+        TopoOsciSim::LatticeContainer l(p);
+        l.setPeriodicBoundaries();
+        l.setRandom(generator);
+        string name = "kernel/xdim" + to_string(xdim);
+        double sum = 0., t;
+
+        t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) sum += l.getAction(); }, suite.minTime);
+        suite.add(name + "/getAction", 1E9 * t / xdim, "ns/site", true);
+        t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { l.computeQ(); sum += l.q; } }, suite.minTime);
+        suite.add(name + "/computeQ", 1E9 * t / xdim, "ns/site", true);
+        t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { l.computeCorr(); sum += l.corr[1]; } }, suite.minTime);
+        suite.add(name + "/computeCorr", 1E9 * t / xdim, "ns/site", true);
+
+        // specialized kernels (same as generic ones for other sizes)
+        t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) sum += TopoOsciSim::LatticeKernelDispatcher::getAction(l); }, suite.minTime);
+        suite.add(name + "/getAction-dispatch", 1E9 * t / xdim, "ns/site", true);
+        t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { TopoOsciSim::LatticeKernelDispatcher::computeQ(l); sum += l.q; } }, suite.minTime);
+        suite.add(name + "/computeQ-dispatch", 1E9 * t / xdim, "ns/site", true);
+        t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { TopoOsciSim::LatticeKernelDispatcher::computeCorr(l); sum += l.corr[1]; } }, suite.minTime);
+        suite.add(name + "/computeCorr-dispatch", 1E9 * t / xdim, "ns/site", true);
+
+        // keep results alive
+        if (sum == 0.5)
+            cout << sum << endl;
+    }
+}
+
+void benchIO(TopoOsciSim::BenchmarkSuite& suite, mt19937_64& generator)
+{
+    const int xdim = 64;
+    const int Nconfs = 10000;
+    double MB = Nconfs * xdim * sizeof(double) / 1E6;
+
+    TopoOsciSim::ParameterContainer p = getBenchParameters(xdim, 1., "cluster");
+    TopoOsciSim::LatticeContainer l(p);
+    l.setPeriodicBoundaries();
+    l.setRandom(generator);
+
+    double t = timePerRepetition([&](long reps) {
+            for (long k=0; k<reps; k++)
+            {
+                TopoOsciSim::FileConfig Out(p);
+                Out.create();
+                l.dumpHeader(Out);
+                for (int i=0; i<Nconfs; i++)
+                    l.dumpConf(Out);
+            }
+        }, suite.minTime);
+    suite.add("io/dumpConf", MB / t, "MB/s", false);
+
+    t = timePerRepetition([&](long reps) {
+            for (long k=0; k<reps; k++)
+            {
+                TopoOsciSim::FileConfig In(p);
+                In.open();
+                l.readHeader(In);
+                for (int i=0; i<Nconfs; i++)
+                    l.readConf(In);
+            }
+        }, suite.minTime);
+    suite.add("io/readConf", MB / t, "MB/s", false);
+}
+
+// Time fastMath per value for each instruction set, return false if
+// its error against libm is too large
+bool benchFastMath(TopoOsciSim::BenchmarkSuite& suite, mt19937_64& generator)
+{
+    const int n = 4096;
+    const TopoOsciSim::FastMath::Accuracy accuracies[] = {TopoOsciSim::FastMath::full, TopoOsciSim::FastMath::reduced};
+    const string accuracyNames[] = {"double", "float"};
+
+    // cos arguments like angle differences, exp arguments like -deltaS
+    uniform_real_distribution< > distCos(-20., 20.), distExp(-50., 50.);
+    vector<double> xCos(n), xExp(n), y(n);
+    for (int i=0; i<n; i++)
+    {
+        xCos[i] = distCos(generator);
+        xExp[i] = distExp(generator);
+    }
+
+    double sum = 0., t;
+    t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { TopoOsciSim::FastMath::cos(xCos.data(), y.data(), n, TopoOsciSim::FastMath::libm); sum += y[k % n]; } }, suite.minTime);
+    suite.add("fastmath/libm/cos", 1E9 * t / n, "ns/value", true);
+    t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { TopoOsciSim::FastMath::exp(xExp.data(), y.data(), n, TopoOsciSim::FastMath::libm); sum += y[k % n]; } }, suite.minTime);
+    suite.add("fastmath/libm/exp", 1E9 * t / n, "ns/value", true);
+
+    bool accurate = true;
+    vector<string> instructionSets = TopoOsciSim::FastMath::getInstructionSets();
+    for (const string& instructionSet : instructionSets)
+    {
+        TopoOsciSim::FastMath::setInstructionSet(instructionSet);
+        for (int a=0; a<2; a++)
+        {
+            TopoOsciSim::FastMath::Accuracy accuracy = accuracies[a];
+            string name = "fastmath/" + instructionSet + "/" + accuracyNames[a];
+
+            // absolute error of cos and sin, relative error of exp
+            // (make check tests more arguments)
+            double errorCos, errorExp, maxError = TopoOsciSim::FastMath::getMaxError(accuracy);
+            TopoOsciSim::FastMath::getErrors(xCos.data(), xExp.data(), n, accuracy, errorCos, errorExp);
+            if ((errorCos > maxError) || (errorExp > maxError))
+            {
+                cerr << "ERROR: " << name << " differs from libm by " << errorCos << " (cos) and "
+                     << errorExp << " (exp), more than " << maxError << endl;
+                accurate = false;
+            }
+
+            t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { TopoOsciSim::FastMath::cos(xCos.data(), y.data(), n, accuracy); sum += y[k % n]; } }, suite.minTime);
+            suite.add(name + "/cos", 1E9 * t / n, "ns/value", true);
+            t = timePerRepetition([&](long reps) { for (long k=0; k<reps; k++) { TopoOsciSim::FastMath::exp(xExp.data(), y.data(), n, accuracy); sum += y[k % n]; } }, suite.minTime);
+            suite.add(name + "/exp", 1E9 * t / n, "ns/value", true);
+        }
+    }
+    TopoOsciSim::FastMath::setInstructionSet(instructionSets[0]);
+
+    // engines with vectorized cos and exp
+    const string algorithms[] = {"metropolis", "cluster"};
+    for (const string& algorithm : algorithms)
+        for (int a=0; a<2; a++)
+        {
+            const int xdim = 256;
+            TopoOsciSim::ParameterContainer p = getBenchParameters(xdim, 8., algorithm);
+            p.fastMath = accuracyNames[a];
+            TopoOsciSim::LatticeContainer lattice(p);
+            lattice.setPeriodicBoundaries();
+            lattice.setRandom(generator);
+            TopoOsciSim::LatticeEquilibration* engine = TopoOsciSim::NewLatticeEquilibrationFor(&lattice, p);
+            engine->run(generator, 1000, 1, NULL);
+
+            t = timePerRepetition([&](long reps) { engine->run(generator, reps, 1, NULL); }, suite.minTime);
+            suite.add(algorithm + "-fastmath-" + accuracyNames[a] + "/xdim256/Ia8.0/site-update", 1E9 * t / xdim, "ns/site-update", true);
+            delete engine;
+        }
+
+    // keep results alive
+    if (sum == 0.5)
+        cout << sum << endl;
+
+    return accurate;
+}
+
+int main (int argc, char *argv[])
+{
+    string output = "bench_results.json";
+    string baseline = "";
+    double tolerance = 0.1;
+    double minTime = 0.2;
+
+    for (int i=1; i+1<argc; i+=2)
+    {
+        if (strcmp(argv[i], "--output") == 0)
+            output = argv[i+1];
+        else if (strcmp(argv[i], "--baseline") == 0)
+            baseline = argv[i+1];
+        else if (strcmp(argv[i], "--tolerance") == 0)
+            tolerance = stod(argv[i+1]);
+        else if (strcmp(argv[i], "--minTime") == 0)
+            minTime = stod(argv[i+1]);
+        else
+        {
+            cout << "Usage: " << argv[0] << " [--output <json>] [--baseline <json>] [--tolerance <double>] [--minTime <double>]" << endl;
+            exit(0);
+        }
+    }
+
+    // fixed seed for reproducible benchmarks
+    mt19937_64 generator(42);
+
+    TopoOsciSim::BenchmarkSuite suite(minTime);
+    benchEngines(suite, generator);
+    benchKernels(suite, generator);
+    benchIO(suite, generator);
+    bool accurate = benchFastMath(suite, generator);
+
+    cout << suite;
+    suite.writeJson(output);
+    cout << "Results written to " << output << endl;
+
+    if (!accurate)
+        exit(1);
+
+    // compare mode
+    if (!baseline.empty())
+    {
+        TopoOsciSim::BenchmarkSuite reference(minTime);
+        if (!reference.readJson(baseline))
+        {
+            cerr << "ERROR: Baseline " << baseline << " cannot be read" << endl;
+            exit(1);
+        }
+        int Nregressions = suite.compare(reference, tolerance);
+        cout << Nregressions << " regression(s) compared to " << baseline << endl;
+        if (Nregressions > 0)
+            exit(1);
+    }
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "benchmark.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    BenchmarkResult::BenchmarkResult(const string& nameIn, double valueIn, const string& unitIn, bool lowerIsBetterIn) :
+        name          {nameIn},
+        value         {valueIn},
+        unit          {unitIn},
+        lowerIsBetter {lowerIsBetterIn} {}
+
+
+    BenchmarkSuite::BenchmarkSuite(double minTimeIn) :
+        minTime {minTimeIn} {}
+
+    ostream& operator<<(ostream& out, const BenchmarkSuite& b)
+    {
+        for (unsigned int i=0; i<b.results.size(); i++)
+            out << "\t " << b.results[i].name << " = " << b.results[i].value << " " << b.results[i].unit << endl;
+        return out;
+    }
+
+    void BenchmarkSuite::add(const string& name, double value, const string& unit, bool lowerIsBetter)
+    {
+        results.push_back(BenchmarkResult(name, value, unit, lowerIsBetter));
+    }
+
+    // Write all results as JSON, one result per line
+    void BenchmarkSuite::writeJson(const string& fileName)
+    {
+        ofstream f(fileName);
+        if (!f.is_open())
+        {
+            cerr << "ERROR: File creation of " << fileName << " does not work" << endl;
+            return;
+        }
+
+        f << "{" << endl;
+        f << "  \"benchmarks\": [" << endl;
+        for (unsigned int i=0; i<results.size(); i++)
+        {
+            f << "    {\"name\": \"" << results[i].name << "\", "
+              << "\"value\": " << results[i].value << ", "
+              << "\"unit\": \"" << results[i].unit << "\", "
+              << "\"better\": \"" << (results[i].lowerIsBetter ? "lower" : "higher") << "\"}"
+              << ((i+1 < results.size()) ? "," : "") << endl;
+        }
+        f << "  ]" << endl;
+        f << "}" << endl;
+    }
+
+    // Return string value of key in line of writeJson output
+    static string getJsonString(const string& line, const string& key)
+    {
+        size_t pos = line.find("\"" + key + "\": \"");
+        if (pos == string::npos)
+            return "";
+        pos += key.size() + 5;
+        return line.substr(pos, line.find("\"", pos) - pos);
+    }
+
+    bool BenchmarkSuite::readJson(const string& fileName)
+    {
+        ifstream f(fileName);
+        if (!f.is_open())
+            return false;
+
+        string line;
+        while (getline(f, line))
+        {
+            string name = getJsonString(line, "name");
+            if (name.empty())
+                continue;
+
+            size_t pos = line.find("\"value\": ");
+            double value = stod(line.substr(pos + 9));
+            add(name, value, getJsonString(line, "unit"), getJsonString(line, "better") == "lower");
+        }
+        return true;
+    }
+
+    // Compare with baseline results and print all regressions
+    int BenchmarkSuite::compare(const BenchmarkSuite& baseline, double tolerance)
+    {
+        int Nregressions = 0;
+        double change;
+        for (unsigned int i=0; i<results.size(); i++)
+            for (unsigned int j=0; j<baseline.results.size(); j++)
+            {
+                if (results[i].name != baseline.results[j].name)
+                    continue;
+
+                // relative change, positive if worse
+                change = results[i].value / baseline.results[j].value - 1.;
+                if (!results[i].lowerIsBetter)
+                    change = baseline.results[j].value / results[i].value - 1.;
+
+                if (change > tolerance)
+                {
+                    Nregressions++;
+                    cout << "REGRESSION " << results[i].name << ": " << baseline.results[j].value
+                         << " -> " << results[i].value << " " << results[i].unit
+                         << " (" << (int)(100 * change) << "% worse)" << endl;
+                }
+                else if (change < -tolerance)
+                    cout << "improved   " << results[i].name << ": " << baseline.results[j].value
+                         << " -> " << results[i].value << " " << results[i].unit << endl;
+            }
+        return Nregressions;
+    }
+
+} // TopoOsciSim
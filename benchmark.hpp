@@ -0,0 +1,77 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    class BenchmarkResult
+    {
+    public:
+
+        string name;
+        double value;
+        string unit;
+
+        // true if smaller values are better (times), false for rates
+        bool lowerIsBetter;
+
+        BenchmarkResult(const string& nameIn, double valueIn, const string& unitIn, bool lowerIsBetterIn);
+    };
+
+
+    class BenchmarkSuite
+    {
+    public:
+
+        vector<BenchmarkResult> results;
+
+        // Minimal time in seconds of each timed benchmark
+        double minTime;
+
+        BenchmarkSuite(double minTimeIn);
+
+        /**
+           Return ostream for BenchmarkSuite class
+
+           @param out Ostream where output goes
+           @param b   This class
+           @return    Ostream including b
+        */
+        friend ostream& operator<<(ostream& out, const BenchmarkSuite& b);
+
+        void add(const string& name, double value, const string& unit, bool lowerIsBetter);
+
+        /**
+           Write all results as JSON
+
+           @param fileName Name of output file
+        */
+        void writeJson(const string& fileName);
+
+        /**
+           Read results written by writeJson
+
+           @param fileName Name of input file
+           @return         false if the file cannot be read
+        */
+        bool readJson(const string& fileName);
+
+        /**
+           Compare with baseline results and print all regressions
+
+           @param baseline  Baseline results
+           @param tolerance Relative change that counts as regression
+           @return          Number of regressions
+        */
+        int compare(const BenchmarkSuite& baseline, double tolerance);
+    };
+
+} // TopoOsciSim
+
+#endif // BENCHMARK_H
@@ -0,0 +1,66 @@
+/**
+   TopoOsciSim
+   budgetConfigs.cpp
+   Purpose: Distribute a cpu budget over the chains of several parameter
+            points for the extrapolation a -> 0
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <random>
+#include <chrono>
+#include "parameters.hpp"
+#include "budgetScheduler.hpp"
+#include "profiler.hpp"
+
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // initialize random generator
+    random_device rd;
+    mt19937_64 generator(rd());
+
+    // define and initialize parameters (defaults of all points)
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+
+    if (parameters.sweepFile.empty())
+    {
+        cerr << "ERROR: No sweepFile given" << endl;
+        exit(0);
+    }
+    if (parameters.budget <= 0.)
+    {
+        cerr << "ERROR: No budget given" << endl;
+        exit(0);
+    }
+
+    TopoOsciSim::BudgetScheduler scheduler(parameters);
+    scheduler.readSweepFile(parameters.sweepFile);
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION       " << endl;
+        cout << endl;
+        cout << "     Budget Configurations  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+        cout << scheduler.points.size() << " points on " << scheduler.Nthreads << " threads" << endl;
+    }
+
+    chrono::steady_clock::time_point wallStart = chrono::steady_clock::now();
+
+    scheduler.run(generator);
+
+    PROFILE_WRITE("BudgetConfigs", parameters);
+
+    if (parameters.verbosity > 2)
+        cout << "wall time = " << chrono::duration<double>(chrono::steady_clock::now() - wallStart).count() << " s" << endl;
+}
@@ -0,0 +1,484 @@
+#include <iostream>
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+#include <thread>
+#include "budgetScheduler.hpp"
+#include "sweepScheduler.hpp"
+#include "autocorrelation.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "fixedLattice.hpp"
+#include "observableTracker.hpp"
+#include "measurementSink.hpp"
+#include "checkpoint.hpp"
+#include "catalog.hpp"
+#include "profiler.hpp"
+#include "latticeEquilibrationFactory.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // cpu seconds of calling thread (chains run in parallel)
+    static double getThreadCpuTime()
+    {
+        timespec t;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+        return t.tv_sec + 1E-9 * t.tv_nsec;
+    }
+
+    BudgetPoint::BudgetPoint(const ParameterContainer& p, unsigned long s) :
+        parameters      {p},
+        seed            {s},
+        NstepsDone      {0},
+        NstepsAdd       {0},
+        cpuTime         {0.},
+        costPerStep     {0.},
+        mean            {0.},
+        error           {0.},
+        tauInt          {0.5},
+        variancePerStep {0.},
+        frozen          {false} {}
+
+    double BudgetPoint::getError(double N) const
+    {
+        return sqrt(variancePerStep / N);
+    }
+
+
+    BudgetScheduler::BudgetScheduler(const ParameterContainer& p) :
+        base               {p},
+        budget             {p.budget},
+        targetError        {p.targetError},
+        observable         {p.budgetObservable},
+        pilotSteps         {p.pilotSteps},
+        extrapolationPower {p.extrapolationPower},
+        Nthreads           {p.Nthreads},
+        spent              {0.},
+        nextJob            {0}
+    {
+        if (Nthreads <= 0)
+            Nthreads = thread::hardware_concurrency();
+        if (Nthreads <= 0)
+            Nthreads = 1;
+    }
+
+    // Points and grids of sweep file
+    void BudgetScheduler::readSweepFile(const string& fileName)
+    {
+        SweepScheduler sweep(base);
+        sweep.readSweepFile(fileName);
+        for (unsigned int i=0; i<sweep.points.size(); i++)
+            points.push_back(BudgetPoint(sweep.points[i], 0));
+    }
+
+    // Pilot, allocation and production
+    void BudgetScheduler::run(mt19937_64& seed)
+    {
+        for (unsigned int i=0; i<points.size(); i++)
+        {
+            points[i].seed = seed();
+            points[i].NstepsAdd = pilotSteps;
+        }
+        runStage();
+        if (base.verbosity > 2)
+            cout << "pilot chains (" << spent << " s of " << budget << " s)" << endl << *this;
+
+        allocate();
+        if (base.verbosity > 2)
+        {
+            cout << "allocation" << endl;
+            for (unsigned int i=0; i<points.size(); i++)
+                if (!points[i].frozen && (points[i].costPerStep > 0.))
+                    cout << "\t a = " << points[i].parameters.a << ": " << points[i].NstepsAdd << " steps ("
+                         << points[i].NstepsAdd * points[i].costPerStep << " s), predicted error "
+                         << points[i].getError(points[i].NstepsDone + points[i].NstepsAdd) << endl;
+        }
+
+        // re-estimate and re-allocate after each round
+        const int Nrounds = 3;
+        for (int r=0; r<Nrounds; r++)
+        {
+            if (r > 0)
+                allocate();
+            for (unsigned int i=0; i<points.size(); i++)
+                points[i].NstepsAdd /= (Nrounds - r);
+            runStage();
+        }
+
+        double value, error;
+        extrapolate(value, error);
+        cout << "production chains (" << spent << " s of " << budget << " s)" << endl << *this;
+        cout << "extrapolation a -> 0: <" << observable << "> = " << value << " +- " << error << endl;
+        writeToFile();
+    }
+
+    // Chains of the stage on the threads, longest first
+    void BudgetScheduler::runStage()
+    {
+        order.clear();
+        vector<double> costs(points.size());
+        for (unsigned int i=0; i<points.size(); i++)
+        {
+            if (points[i].NstepsAdd <= 0)
+                continue;
+            order.push_back(i);
+            if (points[i].costPerStep > 0.)
+                costs[i] = points[i].costPerStep * points[i].NstepsAdd;
+            else
+                costs[i] = (double)points[i].parameters.xdim * ((double)points[i].parameters.Nthermal + points[i].NstepsAdd);
+        }
+        stable_sort(order.begin(), order.end(), [&costs](int i, int j) { return costs[i] > costs[j]; });
+
+        nextJob.store(0);
+        vector<thread> threads;
+        for (int t=0; t<Nthreads; t++)
+            threads.push_back(thread(&BudgetScheduler::runWorker, this));
+        for (unsigned int t=0; t<threads.size(); t++)
+            threads[t].join();
+
+        spent = 0.;
+        for (unsigned int i=0; i<points.size(); i++)
+            spent += points[i].cpuTime;
+    }
+
+    void BudgetScheduler::runWorker()
+    {
+        while (true)
+        {
+            unsigned int job = nextJob.fetch_add(1);
+            if (job >= order.size())
+                return;
+            BudgetPoint& point = points[order[job]];
+            runChain(point);
+
+            // reading the new configurations is part of the cost per step
+            long Nnew = point.NstepsDone - point.series.size();
+            double start = getThreadCpuTime();
+            analyse(point);
+            double analysisTime = getThreadCpuTime() - start;
+            point.cpuTime += analysisTime;
+            point.costPerStep += analysisTime / Nnew;
+
+            if (base.verbosity > 2)
+            {
+                lock_guard<mutex> lock(outputMutex);
+                cout << "a = " << point.parameters.a << ": " << point.NstepsDone << " steps finished" << endl;
+            }
+        }
+    }
+
+    // Like createConfigs with checkpoint and resume
+    void BudgetScheduler::runChain(BudgetPoint& point)
+    {
+        double cpuStart = getThreadCpuTime();
+        ParameterContainer& p = point.parameters;
+
+        // one id for all files of the chain (kept for the next stage)
+        RunCatalog catalog(p.configDirectory);
+        if (p.fileId == -1)
+        {
+            string key = "Conf" + FileExtension("Conf", p).fullExtension;
+            p.fileId = catalog.allocateId(key, p.configDirectory + key);
+        }
+
+        mt19937_64 generator(point.seed);
+        LatticeContainer lattice(p);
+        lattice.setBoundaries(p);
+        LatticeEquilibration* latticeEquilibration = NewLatticeEquilibrationFor(&lattice, p);
+        if (latticeEquilibration == NULL)
+        {
+            cerr << "ERROR: Unknown equilibrationAlgorithm " << p.equilibrationAlgorithm << endl;
+            exit(0);
+        }
+
+        FileConfig Conf(p);
+        CheckpointContainer checkpoint(p, Conf.name.index);
+        bool resumed = checkpoint.exist();
+        if (resumed)
+        {
+            checkpoint.read(generator, lattice, *latticeEquilibration);
+            checkpoint.truncateFiles();
+            Conf.append();
+        }
+        else
+        {
+            lattice.setRandom(generator);
+            Conf.create();
+            lattice.dumpHeader(Conf);
+        }
+
+        while (checkpoint.NthermalDone < p.Nthermal)
+        {
+            int n = checkpoint.getNextChunk(p.Nthermal - checkpoint.NthermalDone);
+            {
+                PROFILE_SCOPE(thermalization);
+                latticeEquilibration->run(generator, n, 1, NULL);
+            }
+            checkpoint.NthermalDone += n;
+            if (p.checkpointInterval > 0)
+                checkpoint.dump(generator, lattice, *latticeEquilibration, NULL, &Conf, NULL);
+        }
+
+        lattice.mod2Pi();
+        ObservableTracker tracker(&lattice, p);
+        if (checkpoint.hasTracker)
+            checkpoint.restoreTracker(tracker);
+        latticeEquilibration->setTracker(&tracker);
+
+        // configurations are always written, they are analysed
+        FileSink sink(&lattice, &Conf, p, checkpoint.NstepsDone > 0);
+        p.Nsteps = checkpoint.NstepsDone + point.NstepsAdd;
+        double productionStart = getThreadCpuTime();
+        while (checkpoint.NstepsDone < p.Nsteps)
+        {
+            int n = checkpoint.getNextChunk(p.Nsteps - checkpoint.NstepsDone);
+            {
+                PROFILE_SCOPE(production);
+                latticeEquilibration->run(generator, n, 1, &sink);
+            }
+            checkpoint.NstepsDone += n;
+            if (p.checkpointInterval > 0)
+                checkpoint.dump(generator, lattice, *latticeEquilibration, &tracker, &Conf, &sink);
+        }
+        point.costPerStep = (getThreadCpuTime() - productionStart) / point.NstepsAdd;
+
+        // next stage or run continues here
+        checkpoint.dump(generator, lattice, *latticeEquilibration, &tracker, &Conf, &sink);
+        latticeEquilibration->setTracker(NULL);
+
+        vector<string> obsFiles;
+        for (unsigned int i=0; i<sink.files.size(); i++)
+            obsFiles.push_back(sink.files[i]->name.fullName);
+        catalog.recordRun(p, Conf.name.fullName, obsFiles, p.Nsteps, resumed ? "" : to_string(point.seed));
+
+        delete latticeEquilibration;
+        point.NstepsDone = p.Nsteps;
+        point.NstepsAdd = 0;
+        point.cpuTime += getThreadCpuTime() - cpuStart;
+    }
+
+    // Observable of new configurations of the chain, statistics of all
+    void BudgetScheduler::analyse(BudgetPoint& point)
+    {
+        FileConfig fConf(point.parameters);
+        fConf.open();
+        LatticeContainer lattice(point.parameters);
+        lattice.readHeader(fConf);
+
+        // skip configurations of series
+        long known = point.series.size();
+        streamoff confBytes = lattice.xdim * (lattice.floatConfigs ? sizeof(float) : sizeof(double))
+            + (lattice.biasConfigs ? sizeof(double) : 0);
+        fConf.f.seekg(known * confBytes, ios::cur);
+
+        point.series.resize(point.NstepsDone);
+        for (long i=known; i<point.NstepsDone; i++)
+        {
+            if (!lattice.readConf(fConf))
+            {
+                cerr << "ERROR: " << fConf << " has less than " << point.NstepsDone << " configurations" << endl;
+                exit(0);
+            }
+            if (observable == "Q2")
+            {
+                LatticeKernelDispatcher::computeQ(lattice);
+                point.series[i] = lattice.q * lattice.q;
+            }
+            else
+                point.series[i] = LatticeKernelDispatcher::getAction(lattice);
+        }
+        const vector<double>& series = point.series;
+
+        // tauInt from at most 10^4 bins (cost of the windowing)
+        long binSize = max(1L, point.NstepsDone / 10000);
+        long Nbins = point.NstepsDone / binSize;
+        vector<double> bins(Nbins, 0.);
+        for (long b=0; b<Nbins; b++)
+        {
+            for (long i=b*binSize; i<(b+1)*binSize; i++)
+                bins[b] += series[i];
+            bins[b] /= binSize;
+        }
+        AutocorrelationContainer autocorrelation;
+        autocorrelation.analyse(bins);
+
+        point.mean = autocorrelation.mean;
+        point.frozen = autocorrelation.frozen;
+        point.error = point.frozen ? 0. : autocorrelation.getErrorOfMean(Nbins);
+        point.variancePerStep = point.error * point.error * Nbins * binSize;
+
+        // same error of the mean from bins and steps
+        double variance = 0.;
+        for (long i=0; i<Nbins*binSize; i++)
+            variance += (series[i] - point.mean) * (series[i] - point.mean);
+        variance /= Nbins * binSize;
+        point.tauInt = (point.frozen || (variance <= 0.)) ? 0.5 : point.variancePerStep / (2. * variance);
+    }
+
+    // Targets first, then portions of the rest where c0 gains most
+    void BudgetScheduler::allocate()
+    {
+        int Npoints = points.size();
+        vector<double> N(Npoints);
+        vector<bool> active(Npoints);
+        for (int i=0; i<Npoints; i++)
+        {
+            N[i] = points[i].NstepsDone;
+            active[i] = (!points[i].frozen && (points[i].costPerStep > 0.));
+            if (points[i].frozen)
+                cerr << "WARNING: " << observable << " is frozen at a = " << points[i].parameters.a
+                     << ", no steps are added (other algorithm?)" << endl;
+        }
+
+        double remaining = budget - spent;
+        if (remaining > 0.)
+        {
+            vector<double> need(Npoints, 0.);
+            double needCost = 0.;
+            if (targetError > 0.)
+                for (int i=0; i<Npoints; i++)
+                    if (active[i])
+                    {
+                        need[i] = max(0., points[i].variancePerStep / (targetError * targetError) - N[i]);
+                        needCost += points[i].costPerStep * need[i];
+                    }
+
+            // equal fraction of the missing steps of each point
+            double fraction = 1.;
+            if (needCost > remaining)
+            {
+                fraction = remaining / needCost;
+                cerr << "WARNING: Budget is " << needCost - remaining << " s too small for targetError" << endl;
+            }
+            for (int i=0; i<Npoints; i++)
+                N[i] += fraction * need[i];
+            remaining -= fraction * needCost;
+
+            const int Nportions = 200;
+            double portion = remaining / Nportions;
+            for (int k=0; (k<Nportions) && (portion > 0.); k++)
+            {
+                double variance = getExtrapolationVariance(N);
+                int best = -1;
+                double bestGain = 0.;
+                for (int i=0; i<Npoints; i++)
+                {
+                    if (!active[i])
+                        continue;
+                    double dN = portion / points[i].costPerStep;
+                    N[i] += dN;
+                    double gain = variance - getExtrapolationVariance(N);
+                    N[i] -= dN;
+                    if (gain > bestGain)
+                    {
+                        best = i;
+                        bestGain = gain;
+                    }
+                }
+                if (best < 0)
+                    break;
+                N[best] += portion / points[best].costPerStep;
+            }
+        }
+
+        for (int i=0; i<Npoints; i++)
+            points[i].NstepsAdd = max(0L, (long)N[i] - points[i].NstepsDone);
+    }
+
+    // Weighted least squares with weights N / variancePerStep
+    double BudgetScheduler::getExtrapolationVariance(const vector<double>& N)
+    {
+        double S0 = 0., S1 = 0., S2 = 0.;
+        vector<double> xs;
+        for (unsigned int i=0; i<points.size(); i++)
+        {
+            if (points[i].frozen || (points[i].variancePerStep <= 0.))
+                continue;
+            double x = pow(points[i].parameters.a, extrapolationPower);
+            double w = N[i] / points[i].variancePerStep;
+            S0 += w;
+            S1 += w * x;
+            S2 += w * x * x;
+            if (find(xs.begin(), xs.end(), x) == xs.end())
+                xs.push_back(x);
+        }
+        if (S0 <= 0.)
+            return 0.;
+        if (xs.size() < 2)
+            return 1. / S0;
+        return S2 / (S0 * S2 - S1 * S1);
+    }
+
+    // Weighted least squares with measured means and errors
+    void BudgetScheduler::extrapolate(double& value, double& error)
+    {
+        double S0 = 0., S1 = 0., S2 = 0., Sy = 0., Sxy = 0.;
+        vector<double> xs;
+        for (unsigned int i=0; i<points.size(); i++)
+        {
+            if (points[i].frozen || (points[i].error <= 0.))
+                continue;
+            double x = pow(points[i].parameters.a, extrapolationPower);
+            double w = 1. / (points[i].error * points[i].error);
+            S0 += w;
+            S1 += w * x;
+            S2 += w * x * x;
+            Sy += w * points[i].mean;
+            Sxy += w * x * points[i].mean;
+            if (find(xs.begin(), xs.end(), x) == xs.end())
+                xs.push_back(x);
+        }
+
+        value = 0.;
+        error = 0.;
+        if (S0 <= 0.)
+            return;
+        if (xs.size() < 2)
+        {
+            value = Sy / S0;
+            error = sqrt(1. / S0);
+            return;
+        }
+        double D = S0 * S2 - S1 * S1;
+        value = (S2 * Sy - S1 * Sxy) / D;
+        error = sqrt(S2 / D);
+    }
+
+    ostream& operator<<(ostream& out, const BudgetScheduler& b)
+    {
+        for (unsigned int i=0; i<b.points.size(); i++)
+        {
+            const BudgetPoint& point = b.points[i];
+            out << "\t a = " << point.parameters.a << ", " << point.parameters.equilibrationAlgorithm << ": "
+                << point.NstepsDone << " steps, " << point.costPerStep << " s per step, tau = " << point.tauInt
+                << ", <" << b.observable << "> = " << point.mean << " +- " << point.error;
+            if (point.frozen)
+                out << " frozen";
+            out << endl;
+        }
+        return out;
+    }
+
+    void BudgetScheduler::writeToFile()
+    {
+        FileObs fBudget("Budget", base);
+        fBudget.create();
+
+        fBudget.f << "# I\ta\txdim\talgorithm\tNsteps\tcostPerStep\ttau\tmean\terror" << endl;
+        for (unsigned int i=0; i<points.size(); i++)
+        {
+            const BudgetPoint& point = points[i];
+            fBudget.f << point.parameters.I << "\t" << point.parameters.a << "\t" << point.parameters.xdim << "\t"
+                      << point.parameters.equilibrationAlgorithm << "\t" << point.NstepsDone << "\t"
+                      << point.costPerStep << "\t" << point.tauInt << "\t" << point.mean << "\t" << point.error << endl;
+        }
+
+        double value, error;
+        extrapolate(value, error);
+        fBudget.f << "# extrapolation a -> 0 (power " << extrapolationPower << ")\t" << value << "\t" << error << endl;
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,168 @@
+#ifndef BUDGETSCHEDULER_H
+#define BUDGETSCHEDULER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include "parameters.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Chain of one parameter point of BudgetScheduler
+    class BudgetPoint
+    {
+    public:
+
+        ParameterContainer parameters;
+        unsigned long seed;
+
+        // Production steps of the chain (all runs) and steps to add
+        long NstepsDone;
+        long NstepsAdd;
+
+        // cpu seconds of this run and per production step
+        double cpuTime;
+        double costPerStep;
+
+        // Observable: mean, error of mean, integrated autocorrelation
+        // time in steps and variance of the mean times steps
+        double mean;
+        double error;
+        double tauInt;
+        double variancePerStep;
+
+        // true if the observable did not change (error unknown)
+        bool frozen;
+
+        // Observable of each configuration read so far
+        vector<double> series;
+
+        BudgetPoint(const ParameterContainer& p, unsigned long s);
+
+        // Error of mean after N steps
+        double getError(double N) const;
+    };
+
+
+    /**
+       Distribute a cpu budget over the chains of several parameter
+       points (usually several a) for the extrapolation a -> 0 of an
+       observable. Each point is a createConfigs run with checkpoint,
+       which is continued, never restarted (also by a later run with
+       the same fileId). After pilotSteps steps per point the cost per
+       step, the autocorrelation time and the variance of the
+       observable give its error for any number of steps. Steps are
+       added so that each point reaches targetError, the rest of the
+       budget goes in small portions to the point that reduces most
+       the error of c0 in the weighted fit c0 + c1 a^extrapolationPower.
+       The steps are run in three rounds, after each one the points are
+       analysed again and the rest of the budget is allocated anew. The
+       chains run on Nthreads threads, longest first.
+    */
+    class BudgetScheduler
+    {
+
+    public:
+
+        // Parameters every point starts from
+        ParameterContainer base;
+
+        vector<BudgetPoint> points;
+
+        double budget;
+        double targetError;
+        string observable;
+        long pilotSteps;
+        double extrapolationPower;
+        int Nthreads;
+
+        // cpu seconds of all chains of this run
+        double spent;
+
+        // Chains of a stage, longest first, next one to run
+        vector<int> order;
+        atomic<int> nextJob;
+
+        // Serializes progress output
+        mutex outputMutex;
+
+        BudgetScheduler(const ParameterContainer& p);
+
+        /**
+           Read parameter points like SweepScheduler
+
+           @param fileName Name of sweep file
+        */
+        void readSweepFile(const string& fileName);
+
+        /**
+           Pilot chains, allocation, production and extrapolation
+
+           @param seed Random generator to seed new chains
+        */
+        void run(mt19937_64& seed);
+
+        // Run NstepsAdd steps of each point on Nthreads threads
+        void runStage();
+
+        // Worker loop over the chains of a stage
+        void runWorker();
+
+        /**
+           Continue chain from its checkpoint (or start it) for NstepsAdd
+           production steps and write a new checkpoint
+
+           @param point Parameter point
+        */
+        void runChain(BudgetPoint& point);
+
+        /**
+           Compute mean, error and autocorrelation of the observable from
+           all configurations of the chain
+
+           @param point Parameter point
+        */
+        void analyse(BudgetPoint& point);
+
+        // Set NstepsAdd of all points from remaining budget
+        void allocate();
+
+        /**
+           Return variance of c0 of the weighted fit (of the weighted
+           mean if there are less than two values of a)
+
+           @param N Steps of each point
+           @return  Variance of extrapolated value
+        */
+        double getExtrapolationVariance(const vector<double>& N);
+
+        /**
+           Fit c0 + c1 a^extrapolationPower to the means
+
+           @param value Extrapolated value
+           @param error Its error
+        */
+        void extrapolate(double& value, double& error);
+
+        /**
+           Return ostream for BudgetScheduler class
+
+           @param out Ostream where output goes
+           @param b   This class
+           @return    Ostream including table of points
+        */
+        friend ostream& operator<<(ostream& out, const BudgetScheduler& b);
+
+        // Write table of points and extrapolation to output directory
+        void writeToFile();
+    };
+
+} // TopoOsciSim
+
+#endif // BUDGETSCHEDULER_H
@@ -0,0 +1,323 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include "catalog.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Exclusive lock of catalog until end of scope
+    class CatalogLock
+    {
+    public:
+        int fd;
+
+        CatalogLock(const string& lockName)
+        {
+            fd = ::open(lockName.c_str(), O_RDWR | O_CREAT, 0666);
+            if ((fd < 0) || (flock(fd, LOCK_EX) != 0))
+            {
+                cerr << "ERROR: Catalog lock " << lockName << " cannot be acquired" << endl;
+                exit(0);
+            }
+        }
+
+        ~CatalogLock()
+        {
+            flock(fd, LOCK_UN);
+            close(fd);
+        }
+    };
+
+    
+    bool CatalogRecord::matches(const vector<pair<string, string> >& constraints) const
+    {
+        for (unsigned int i=0; i<constraints.size(); i++)
+        {
+            map<string, string>::const_iterator it = fields.find(constraints[i].first);
+            if (it == fields.end())
+                return false;
+
+            // compare as numbers if both are numbers
+            char *endValue, *endConstraint;
+            double value = strtod(it->second.c_str(), &endValue);
+            double constraint = strtod(constraints[i].second.c_str(), &endConstraint);
+            if ((*endValue == '\0') && (*endConstraint == '\0') && !it->second.empty() && !constraints[i].second.empty())
+            {
+                if (value != constraint)
+                    return false;
+            }
+            else if (it->second != constraints[i].second)
+                return false;
+        }
+        return true;
+    }
+
+    ostream& operator<<(ostream& out, const CatalogRecord& r)
+    {
+        out << r.key << "_id" << r.id;
+        for (map<string, string>::const_iterator it = r.fields.begin(); it != r.fields.end(); ++it)
+            out << " " << it->first << "=" << it->second;
+        return out;
+    }
+
+
+    RunCatalog::RunCatalog(const string& directoryIn) :
+        directory {directoryIn},
+        fileName  {directoryIn + "Catalog"},
+        lockName  {directoryIn + "Catalog.lock"},
+        nextDirectory {directoryIn + "Catalog.next/"}
+    {
+        struct stat st = {0};
+        if (stat(directory.c_str(), &st) == -1)
+            mkdir(directory.c_str(), 0777);
+    }
+
+    vector<string> RunCatalog::readLines()
+    {
+        vector<string> lines;
+        ifstream f(fileName);
+        string line;
+        while (getline(f, line))
+            lines.push_back(line);
+        return lines;
+    }
+
+    void RunCatalog::appendLine(const string& line)
+    {
+        ofstream f(fileName, ios::out | ios::app);
+        f << line << endl;
+        if (!f.good())
+        {
+            cerr << "ERROR: Catalog " << fileName << " cannot be written" << endl;
+            exit(0);
+        }
+    }
+
+    int RunCatalog::readNextId(const string& key)
+    {
+        ifstream f(nextDirectory + key);
+        int next;
+        if (!(f >> next))
+            return -1;
+        return next;
+    }
+
+    void RunCatalog::writeNextId(const string& key, int id)
+    {
+        string name = nextDirectory + key;
+        string tmpName = name + ".tmp";
+        {
+            ofstream f(tmpName);
+            f << id << endl;
+            if (!f.good())
+            {
+                cerr << "ERROR: Catalog index " << name << " cannot be written" << endl;
+                exit(0);
+            }
+        }
+        if (rename(tmpName.c_str(), name.c_str()) != 0)
+        {
+            cerr << "ERROR: Catalog index " << name << " cannot be written" << endl;
+            exit(0);
+        }
+    }
+
+    // Remove directory with files only (left by an interrupted index)
+    static void removeFlatDirectory(const string& name)
+    {
+        DIR* dir = opendir(name.c_str());
+        if (dir == NULL)
+            return;
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            string file = entry->d_name;
+            if ((file != ".") && (file != ".."))
+                unlink((name + file).c_str());
+        }
+        closedir(dir);
+        rmdir(name.c_str());
+    }
+
+    // Next id of every key from the alloc lines (once per directory)
+    void RunCatalog::indexNextIds()
+    {
+        map<string, int> next;
+        vector<string> lines = readLines();
+        string kind, lineKey;
+        int id;
+        for (unsigned int i=0; i<lines.size(); i++)
+        {
+            stringstream words(lines[i]);
+            if ((words >> kind >> lineKey >> id) && ((next.find(lineKey) == next.end()) || (id >= next[lineKey])))
+                next[lineKey] = id + 1;
+        }
+
+        // ids are written before the directory appears, an interrupted
+        // index is repeated
+        string tmpDirectory = directory + "Catalog.next.tmp/";
+        removeFlatDirectory(tmpDirectory);
+        if (mkdir(tmpDirectory.c_str(), 0777) != 0)
+        {
+            cerr << "ERROR: Catalog index " << tmpDirectory << " cannot be created" << endl;
+            exit(0);
+        }
+        string finalDirectory = nextDirectory;
+        nextDirectory = tmpDirectory;
+        for (map<string, int>::iterator it = next.begin(); it != next.end(); ++it)
+            writeNextId(it->first, it->second);
+        nextDirectory = finalDirectory;
+        string finalName = nextDirectory.substr(0, nextDirectory.size() - 1);
+        string tmpName = tmpDirectory.substr(0, tmpDirectory.size() - 1);
+        if (rename(tmpName.c_str(), finalName.c_str()) != 0)
+        {
+            cerr << "ERROR: Catalog index " << nextDirectory << " cannot be created" << endl;
+            exit(0);
+        }
+    }
+
+    // Allocate next free id of key, O(1) with the index of next ids
+    int RunCatalog::allocateId(const string& key, const string& probeBase)
+    {
+        CatalogLock lock(lockName);
+
+        struct stat st = {0};
+        if (stat(nextDirectory.c_str(), &st) == -1)
+            indexNextIds();
+
+        int next = readNextId(key);
+
+        // first id of key: skip files written before the catalog existed
+        if (next < 0)
+        {
+            next = 0;
+            while (ifstream(probeBase + "_id" + to_string(next)).good())
+                next++;
+        }
+
+        writeNextId(key, next + 1);
+        appendLine("alloc " + key + " " + to_string(next));
+        return next;
+    }
+
+    // Append record of finished run
+    void RunCatalog::record(const string& key, int id, const vector<pair<string, string> >& fields)
+    {
+        stringstream line;
+        line << "run " << key << " " << id;
+        for (unsigned int i=0; i<fields.size(); i++)
+            line << " " << fields[i].first << "=" << fields[i].second;
+
+        CatalogLock lock(lockName);
+        appendLine(line.str());
+    }
+
+    // Return record of each run that matches all constraints
+    vector<CatalogRecord> RunCatalog::find(const vector<pair<string, string> >& constraints)
+    {
+        vector<string> lines;
+        {
+            CatalogLock lock(lockName);
+            lines = readLines();
+        }
+
+        // later records of a run update earlier ones (resumed runs)
+        map<string, CatalogRecord> runs;
+        vector<string> order;
+        for (unsigned int i=0; i<lines.size(); i++)
+        {
+            stringstream words(lines[i]);
+            string kind, field;
+            CatalogRecord r;
+            if (!(words >> kind >> r.key >> r.id) || (kind != "run"))
+                continue;
+            while (words >> field)
+            {
+                size_t pos = field.find('=');
+                if (pos != string::npos)
+                    r.fields[field.substr(0, pos)] = field.substr(pos + 1);
+            }
+
+            string run = r.key + "_id" + to_string(r.id);
+            if (runs.find(run) == runs.end())
+            {
+                order.push_back(run);
+                runs[run] = r;
+            }
+            else
+                for (map<string, string>::iterator it = r.fields.begin(); it != r.fields.end(); ++it)
+                    runs[run].fields[it->first] = it->second;
+        }
+
+        vector<CatalogRecord> result;
+        for (unsigned int i=0; i<order.size(); i++)
+            if (runs[order[i]].matches(constraints))
+                result.push_back(runs[order[i]]);
+        return result;
+    }
+
+    // Fields of all physical and run parameters
+    vector<pair<string, string> > RunCatalog::getParameterFields(const ParameterContainer& p)
+    {
+        vector<pair<string, string> > fields;
+        stringstream value;
+        value.precision(17);
+
+#define CATALOG_FIELD(name) value.str(""); value << p.name; fields.push_back(make_pair(string(#name), value.str()))
+        CATALOG_FIELD(runName);
+        CATALOG_FIELD(I);
+        CATALOG_FIELD(theta);
+        CATALOG_FIELD(a);
+        CATALOG_FIELD(xdim);
+        CATALOG_FIELD(dim);
+        CATALOG_FIELD(Nsteps);
+        CATALOG_FIELD(Nthermal);
+        CATALOG_FIELD(equilibrationAlgorithm);
+        CATALOG_FIELD(deltaMetro);
+        CATALOG_FIELD(fileId);
+#undef CATALOG_FIELD
+
+        return fields;
+    }
+
+    // Size of file in bytes (0 if it does not exist)
+    static long getFileSize(const string& name)
+    {
+        struct stat st;
+        if (stat(name.c_str(), &st) != 0)
+            return 0;
+        return st.st_size;
+    }
+
+    // Record run of createConfigs
+    void RunCatalog::recordRun(const ParameterContainer& p, const string& confFile, const vector<string>& obsFiles,
+                               long Nconfigs, const string& seed)
+    {
+        vector<pair<string, string> > fields = getParameterFields(p);
+        if (!seed.empty())
+            fields.push_back(make_pair(string("seed"), seed));
+        fields.push_back(make_pair(string("Nconfigs"), to_string(Nconfigs)));
+        fields.push_back(make_pair(string("confFile"), confFile));
+        fields.push_back(make_pair(string("confBytes"), to_string(getFileSize(confFile))));
+
+        long obsBytes = 0;
+        for (unsigned int i=0; i<obsFiles.size(); i++)
+            obsBytes += getFileSize(obsFiles[i]);
+        fields.push_back(make_pair(string("obsBytes"), to_string(obsBytes)));
+
+        // key of configuration file without directory and id
+        string key = confFile.substr(directory.size());
+        key = key.substr(0, key.rfind("_id"));
+        record(key, p.fileId, fields);
+    }
+
+} // TopoOsciSim
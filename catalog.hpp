@@ -0,0 +1,133 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include "parameters.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // One run of the catalog
+    class CatalogRecord
+    {
+    public:
+
+        // File type and extension without id (e.g. Conf_I10.000000_...)
+        string key;
+        int id;
+
+        // Parameters, seed, number of configurations, file sizes ...
+        map<string, string> fields;
+
+        /**
+           true if all constraints hold (numbers are compared as numbers)
+
+           @param constraints Name and value of fields
+        */
+        bool matches(const vector<pair<string, string> >& constraints) const;
+
+        friend ostream& operator<<(ostream& out, const CatalogRecord& r);
+    };
+
+
+    /**
+       Manifest "Catalog" of a directory. It is an append-only text
+       file, every change is done under an exclusive lock (flock on
+       Catalog.lock), so parallel jobs get different ids. Lines are
+       "alloc <key> <id>" for allocated ids and
+       "run <key> <id> <name>=<value> ..." for finished runs. The next
+       id of each key is kept in its own small file in Catalog.next/,
+       replaced by rename, so an allocation reads one number and does
+       not scan the manifest. Catalogs without Catalog.next/ are
+       indexed once.
+    */
+    class RunCatalog
+    {
+
+    public:
+
+        string directory;
+        string fileName;
+        string lockName;
+        string nextDirectory;
+
+        RunCatalog(const string& directoryIn);
+
+        /**
+           Allocate next free id of key. Directories without catalog
+           entries for key are probed once for existing files.
+
+           @param key       File type and extension without id
+           @param probeBase Full file name without id (for probing)
+           @return          Free id
+        */
+        int allocateId(const string& key, const string& probeBase);
+
+        /**
+           Append record of finished run
+
+           @param key    File type and extension without id
+           @param id     Id of run
+           @param fields Name and value of everything to record
+        */
+        void record(const string& key, int id, const vector<pair<string, string> >& fields);
+
+        /**
+           Return record of each run that matches all constraints
+           (fields of later records of a run replace earlier ones)
+
+           @param constraints Name and value of fields
+           @return            Matching records
+        */
+        vector<CatalogRecord> find(const vector<pair<string, string> >& constraints);
+
+        // Fields of all physical and run parameters
+        static vector<pair<string, string> > getParameterFields(const ParameterContainer& p);
+
+        /**
+           Record run of createConfigs with its parameters, seed,
+           number of configurations and file sizes
+
+           @param p        Parameters (fileId is the id of the run)
+           @param confFile Name of configuration file
+           @param obsFiles Names of observable files
+           @param Nconfigs Number of configurations in confFile
+           @param seed     Seed of random generator (empty: not recorded)
+        */
+        void recordRun(const ParameterContainer& p, const string& confFile, const vector<string>& obsFiles,
+                       long Nconfigs, const string& seed);
+
+        // Read all lines of catalog (caller holds lock)
+        vector<string> readLines();
+        void appendLine(const string& line);
+
+        /**
+           Return next id of key (caller holds lock)
+
+           @param key File type and extension without id
+           @return    Next id, -1 if key has no id yet
+        */
+        int readNextId(const string& key);
+
+        /**
+           Set next id of key with temporary file and rename (caller
+           holds lock)
+
+           @param key File type and extension without id
+           @param id  Next id
+        */
+        void writeNextId(const string& key, int id);
+
+        // Create Catalog.next/ from the alloc lines of the manifest
+        // (caller holds lock)
+        void indexNextIds();
+    };
+
+} // TopoOsciSim
+
+#endif // CATALOG_H
@@ -0,0 +1,187 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "checkpoint.hpp"
+#include "pipeline.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Parameters with fixed file id (no search for free index)
+    static ParameterContainer getParametersWithId(const ParameterContainer& p, int fileIndex)
+    {
+        ParameterContainer pId = p;
+        pId.fileId = fileIndex;
+        return pId;
+    }
+
+    CheckpointContainer::CheckpointContainer(const ParameterContainer& p, int fileIndex) :
+        name               ("Checkpoint", p.configDirectory, getParametersWithId(p, fileIndex)),
+        checkpointInterval {p.checkpointInterval},
+        NthermalDone       {0},
+        NstepsDone         {0},
+        hasTracker         {false},
+        trackerAction      {0.},
+        trackerQ           {0.},
+        trackerSumPhi      {0.},
+        trackerSumPhiSq    {0.},
+        trackerStepsSinceRecompute {0} {}
+
+    bool CheckpointContainer::exist()
+    {
+        return name.exist(name.fullName);
+    }
+
+    // Return number of steps until next checkpoint
+    int CheckpointContainer::getNextChunk(long remaining)
+    {
+        if ((checkpointInterval > 0) && (remaining > checkpointInterval))
+            return checkpointInterval;
+        return remaining;
+    }
+
+    // Write checkpoint to temporary file and rename it
+    void CheckpointContainer::dump(mt19937_64& generator, LatticeContainer& lattice, LatticeEquilibration& engine,
+                                   ObservableTracker* tracker, FileConfig* conf, FileSink* sink, PipelineSink* pipeline)
+    {
+        // output files must be complete up to the checkpoint
+        files.clear();
+        offsets.clear();
+        if (conf)
+        {
+            conf->f.flush();
+            files.push_back(conf->name.fullName);
+            offsets.push_back(conf->f.tellp());
+        }
+        if (sink)
+            for (unsigned int i=0; i<sink->files.size(); i++)
+            {
+                sink->files[i]->f.flush();
+                files.push_back(sink->files[i]->name.fullName);
+                offsets.push_back(sink->files[i]->f.tellp());
+            }
+        if (pipeline)
+        {
+            pipeline->drain();
+            for (unsigned int i=0; i<pipeline->files.size(); i++)
+            {
+                files.push_back(pipeline->files[i]->name.fullName);
+                offsets.push_back(pipeline->files[i]->f.tellp());
+            }
+        }
+
+        string tmpName = name.fullName + ".tmp";
+        ofstream f(tmpName);
+        if (!f.is_open())
+        {
+            cerr << "ERROR: Checkpoint " << tmpName << " cannot be created" << endl;
+            exit(0);
+        }
+
+        // 17 digits: doubles are read back bit-exactly
+        f.precision(17);
+        f << lattice.I << " " << lattice.a << " " << lattice.xdim << endl;
+        f << NthermalDone << " " << NstepsDone << endl;
+        f << generator << endl;
+        for (int i=0; i<lattice.xdim; i++)
+            f << lattice.tslice[i].phi << "\n";
+
+        hasTracker = (tracker != NULL);
+        f << hasTracker;
+        if (hasTracker)
+            f << " " << tracker->action << " " << tracker->q << " " << tracker->sumPhi << " "
+              << tracker->sumPhiSq << " " << tracker->stepsSinceRecompute;
+        f << endl;
+
+        engine.dumpState(f);
+        f << endl;
+
+        f << files.size() << endl;
+        for (unsigned int i=0; i<files.size(); i++)
+            f << offsets[i] << " " << files[i] << endl;
+
+        f.close();
+        if (!f.good() || (rename(tmpName.c_str(), name.fullName.c_str()) != 0))
+        {
+            cerr << "ERROR: Checkpoint " << name.fullName << " cannot be written" << endl;
+            exit(0);
+        }
+    }
+
+    void CheckpointContainer::read(mt19937_64& generator, LatticeContainer& lattice, LatticeEquilibration& engine)
+    {
+        ifstream f(name.fullName);
+        if (!f.is_open())
+        {
+            cerr << "ERROR: Checkpoint " << name.fullName << " cannot be opened" << endl;
+            exit(0);
+        }
+
+        double I, a;
+        int xdim;
+        f >> I >> a >> xdim;
+        if ((I != lattice.I) || (a != lattice.a) || (xdim != lattice.xdim))
+        {
+            cerr << "ERROR: Checkpoint " << name.fullName << " belongs to other lattice parameters" << endl;
+            exit(0);
+        }
+
+        f >> NthermalDone >> NstepsDone;
+        f >> generator;
+        for (int i=0; i<lattice.xdim; i++)
+            f >> lattice.tslice[i].phi;
+
+        f >> hasTracker;
+        if (hasTracker)
+            f >> trackerAction >> trackerQ >> trackerSumPhi >> trackerSumPhiSq >> trackerStepsSinceRecompute;
+
+        engine.readState(f);
+
+        int Nfiles;
+        long offset;
+        string file;
+        f >> Nfiles;
+        files.clear();
+        offsets.clear();
+        for (int i=0; i<Nfiles; i++)
+        {
+            f >> offset;
+            f.ignore(1);
+            getline(f, file);
+            offsets.push_back(offset);
+            files.push_back(file);
+        }
+
+        if (f.fail())
+        {
+            cerr << "ERROR: Checkpoint " << name.fullName << " is corrupt" << endl;
+            exit(0);
+        }
+    }
+
+    // Set tracked observables to their values at the checkpoint
+    void CheckpointContainer::restoreTracker(ObservableTracker& tracker)
+    {
+        tracker.action = trackerAction;
+        tracker.q = trackerQ;
+        tracker.sumPhi = trackerSumPhi;
+        tracker.sumPhiSq = trackerSumPhiSq;
+        tracker.stepsSinceRecompute = trackerStepsSinceRecompute;
+    }
+
+    // Cut output files back to their lengths at the checkpoint
+    void CheckpointContainer::truncateFiles()
+    {
+        for (unsigned int i=0; i<files.size(); i++)
+            if (truncate(files[i].c_str(), offsets[i]) != 0)
+            {
+                cerr << "ERROR: File " << files[i] << " cannot be truncated" << endl;
+                exit(0);
+            }
+    }
+
+} // TopoOsciSim
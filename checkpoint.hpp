@@ -0,0 +1,105 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "observableTracker.hpp"
+#include "measurementSink.hpp"
+#include "latticeEquilibration.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    class PipelineSink;
+
+    /**
+       State of a Markov chain run: random generator, lattice, step
+       counters, tracked observables, engine state and the lengths of
+       all output files. A resumed run continues bit-exactly.
+    */
+    class CheckpointContainer
+    {
+
+    public:
+
+        // Checkpoint file (in configuration directory, id of config file)
+        FileName name;
+
+        // Number of steps between checkpoints (0: no checkpoints)
+        int checkpointInterval;
+
+        // Finished thermalization and production steps
+        long NthermalDone;
+        long NstepsDone;
+
+        // Tracked observables (only after thermalization)
+        bool hasTracker;
+        double trackerAction;
+        double trackerQ;
+        double trackerSumPhi;
+        double trackerSumPhiSq;
+        int trackerStepsSinceRecompute;
+
+        // Output files and their lengths at the checkpoint
+        vector<string> files;
+        vector<long> offsets;
+
+        /**
+           Create checkpoint for run
+
+           @param p         Parameters
+           @param fileIndex Id of configuration file of run
+        */
+        CheckpointContainer(const ParameterContainer& p, int fileIndex);
+
+        // true if checkpoint file exists
+        bool exist();
+
+        /**
+           Return number of steps until next checkpoint
+
+           @param remaining Number of remaining steps of phase
+           @return          Number of steps to do
+        */
+        int getNextChunk(long remaining);
+
+        /**
+           Write checkpoint atomically (temporary file and rename)
+
+           @param generator Random generator
+           @param lattice   Lattice
+           @param engine    Equilibration algorithm
+           @param tracker   Tracked observables (NULL during thermalization)
+           @param conf      Configuration file (can be NULL)
+           @param sink      Sink with observable files (can be NULL)
+           @param pipeline  Analysis threads, drained first (can be NULL)
+        */
+        void dump(mt19937_64& generator, LatticeContainer& lattice, LatticeEquilibration& engine,
+                  ObservableTracker* tracker, FileConfig* conf, FileSink* sink, PipelineSink* pipeline = NULL);
+
+        /**
+           Read checkpoint into generator, lattice and engine
+
+           @param generator Random generator
+           @param lattice   Lattice (same I, a and xdim as checkpoint)
+           @param engine    Equilibration algorithm
+        */
+        void read(mt19937_64& generator, LatticeContainer& lattice, LatticeEquilibration& engine);
+
+        // Set tracked observables to their values at the checkpoint
+        void restoreTracker(ObservableTracker& tracker);
+
+        // Cut output files back to their lengths at the checkpoint
+        void truncateFiles();
+    };
+
+} // TopoOsciSim
+
+#endif // CHECKPOINT_H
@@ -1,5 +1,6 @@
 #include <iostream>
 #include "cluster.hpp"
+#include "profiler.hpp"
 
 using namespace std;
 
@@ -9,19 +10,30 @@ namespace TopoOsciSim
     // Create ClusterContainer on lattice
     ClusterContainer::ClusterContainer(LatticeContainer* l, const ParameterContainer& p) : 
         lattice     {l},
+        tracker     {NULL},
         start       {0},
         angle       {0},
         leftBorder  {0},
         rightBorder {0},
         size        {0},
         bondProb    {0.},
+        improvedEstimators {p.improvedEstimators},
+        improvedSusceptibility {0.},
+        improvedMeanSpinSq {0.},
+        improvedCorr (l->xdim, 0.),
+        fastMath    {FastMath::getAccuracy(p.fastMath)},
+        stepNumber  {0},
+        blockSize   {clusterBondBlock},
+        bondStep    (l->xdim, -1),
+        bondCache   (l->xdim, 0.),
+        floatSweeps {p.precision == "float"},
+        instanton   (l, p),
         fSize ("ClusterSize", p),
         fProb ("ClusterProb", p),
         fMeanPhiSq ("MeanPhiSq", p)
     {
-        fSize.create();
-        fProb.create();
-        fMeanPhiSq.create();
+        if (floatSweeps)
+            lattice->getAngles(phiFloat);
     }
 
     // Return ostream for ClusterContainer class
@@ -58,6 +70,58 @@ namespace TopoOsciSim
                         * cos( angle - lattice->tslice[lattice->tslice[index].idAfter].phi ) );   
     }
 
+    // Return bond probability from the float angles
+    double ClusterContainer::getBondProbabilityFloat(int index)
+    {
+        float angleFloat = angle;
+        float Ia = lattice->I / lattice->a;
+        return 1 - exp( -2 * Ia
+                        * cos( angleFloat - phiFloat[index] )
+                        * cos( angleFloat - phiFloat[lattice->tslice[index].idAfter] ) );
+    }
+
+    // Return bond probability from cache, fill block of bonds if missing
+    double ClusterContainer::getCachedBondProbability(int index, int direction)
+    {
+        if (bondStep[index] == stepNumber)
+            return bondCache[index];
+
+        // bonds of block in direction of growth, larger blocks for
+        // large clusters
+        int NbondsMax = min(blockSize, lattice->xdim);
+        blockSize = min(2*blockSize, clusterBondBlockMax);
+        blockBonds.resize(NbondsMax);
+        blockCos.resize(2*NbondsMax);
+        blockExp.resize(NbondsMax);
+        int Nbonds = 0;
+        int bond = index;
+        while (Nbonds < NbondsMax)
+        {
+            blockBonds[Nbonds] = bond;
+            blockCos[2*Nbonds]   = angle - lattice->tslice[bond].phi;
+            blockCos[2*Nbonds+1] = angle - lattice->tslice[lattice->tslice[bond].idAfter].phi;
+            Nbonds++;
+
+            // block ends at open end of lattice
+            bond = (direction > 0) ? lattice->tslice[bond].idAfter : lattice->tslice[bond].idBefore;
+            if ((bond < 0) || (lattice->tslice[bond].idAfter < 0))
+                break;
+        }
+        FastMath::cos(blockCos.data(), blockCos.data(), 2*Nbonds, fastMath);
+
+        double Ia = lattice->I / lattice->a;
+        for (int k=0; k<Nbonds; k++)
+            blockExp[k] = -2 * Ia * blockCos[2*k] * blockCos[2*k+1];
+        FastMath::exp(blockExp.data(), blockExp.data(), Nbonds, fastMath);
+
+        for (int k=0; k<Nbonds; k++)
+        {
+            bondCache[blockBonds[k]] = 1 - blockExp[k];
+            bondStep[blockBonds[k]] = stepNumber;
+        }
+        return bondCache[index];
+    }
+
     // Create cluster on lattice (find leftBorder and rightBorder)
     void ClusterContainer::createCluster(mt19937_64& seed)
     {
@@ -71,11 +135,20 @@ namespace TopoOsciSim
         // var to check overflow of cluster
         int overflow = 0;
 
+        // cluster reaches open end of lattice
+        bool openEnd = false;
+
         // go right
         do 
         {
             // add up bond probabilities of bonds inside cluster
             probAdd += prob;
+
+            if (lattice->tslice[i].idAfter < 0)
+            {
+                openEnd = true;
+                break;
+            }
             
             // go one step right
             i = lattice->tslice[i].idAfter;
@@ -87,7 +160,12 @@ namespace TopoOsciSim
             r = dist(seed);
             
             // probability for i-1 to i beeing a bond
-            prob = getBondProbability(lattice->tslice[i].idBefore);
+            if (floatSweeps)
+                prob = getBondProbabilityFloat(lattice->tslice[i].idBefore);
+            else if (fastMath == FastMath::libm)
+                prob = getBondProbability(lattice->tslice[i].idBefore);
+            else
+                prob = getCachedBondProbability(lattice->tslice[i].idBefore, 1);
         }
         while ((r <= prob) && (i != start ));
 
@@ -95,11 +173,15 @@ namespace TopoOsciSim
         if (i == 0) overflow = 0;
 
         // last accepted tslice id is right border of cluster        
-        rightBorder = lattice->tslice[i].idBefore + overflow * lattice->xdim;
+        if (openEnd)
+            rightBorder = i;
+        else
+            rightBorder = lattice->tslice[i].idBefore + overflow * lattice->xdim;
 
         // go back to start
         i = lattice->tslice[start].id;
         overflow = 0;
+        openEnd = false;
 
         prob=0.;
         // go left
@@ -108,6 +190,12 @@ namespace TopoOsciSim
             // add up bond probabilities of bonds inside cluster
             probAdd += prob;
 
+            if (lattice->tslice[i].idBefore < 0)
+            {
+                openEnd = true;
+                break;
+            }
+
             // go one step left
             i = lattice->tslice[i].idBefore;            
 
@@ -118,7 +206,12 @@ namespace TopoOsciSim
             r = dist(seed);
             
             // probability for i to i+1 beeing a bond
-            prob = getBondProbability(lattice->tslice[i].id);
+            if (floatSweeps)
+                prob = getBondProbabilityFloat(lattice->tslice[i].id);
+            else if (fastMath == FastMath::libm)
+                prob = getBondProbability(lattice->tslice[i].id);
+            else
+                prob = getCachedBondProbability(lattice->tslice[i].id, -1);
         }
         while ((r <= prob) && (i != rightBorder % lattice->xdim ));
         
@@ -126,7 +219,10 @@ namespace TopoOsciSim
         if (i == lattice->xdim - 1) overflow = 0;
 
         // last accepted tslice id is left border of cluster        
-        leftBorder = lattice->tslice[i].idAfter - overflow * lattice->xdim;
+        if (openEnd)
+            leftBorder = i;
+        else
+            leftBorder = lattice->tslice[i].idAfter - overflow * lattice->xdim;
         // cout << "left = " << leftBorder << endl;
 
         // set cluster variables
@@ -140,6 +236,10 @@ namespace TopoOsciSim
     // Perform one cluster step (create cluster and flip in cluster)
     void ClusterContainer::doStep(mt19937_64& seed)
     {
+        // winding insertion before the cluster, so the improved
+        // estimators see the lattice of the last cluster
+        instanton.doStep(seed);
+
         // choose random reflection vector (in our case just an angle)
         uniform_real_distribution< > dist_angle( 0 , 2*M_PI );
         angle = dist_angle(seed);
@@ -148,18 +248,45 @@ namespace TopoOsciSim
         uniform_int_distribution< > dist_latticePoint( 0 , lattice->xdim-1 );
         start = dist_latticePoint(seed);
 
-        // create cluster
+        // create cluster (bond probabilities of last step are invalid)
+        stepNumber++;
+        blockSize = clusterBondBlock;
         createCluster(seed);
 
-        // project all points inside cluster
-        int index;
-        for (int i=leftBorder; i<=rightBorder; i++)
+        // project all points inside cluster (float angles stay in
+        // [-pi, pi]: reflection pi + 2 angle mod 2pi minus phi is in
+        // [-2pi, 2pi])
+        if (floatSweeps)
         {
-            index = (i+lattice->xdim) % lattice->xdim;
-            lattice->tslice[index].phi = lattice->tslice[index].getProjectedAngle(angle);
+            float reflection = LatticeContainer::getAngleMod2Pi(M_PI + 2*angle);
+            for (int i=leftBorder; i<=rightBorder; i++)
+            {
+                int index = (i+lattice->xdim) % lattice->xdim;
+                float phiNew = reflection - phiFloat[index];
+                if (phiNew > float(M_PI))
+                    phiNew -= float(2*M_PI);
+                else if (phiNew < -float(M_PI))
+                    phiNew += float(2*M_PI);
+                phiFloat[index] = phiNew;
+            }
+        }
+        else if (tracker)
+            tracker->reflectSegment(leftBorder, rightBorder, angle);
+        else
+        {
+            int index;
+            for (int i=leftBorder; i<=rightBorder; i++)
+            {
+                index = (i+lattice->xdim) % lattice->xdim;
+                lattice->tslice[index].phi = lattice->tslice[index].getProjectedAngle(angle);
+            }
         }
 
         lattice->algorithm = 'c';
+
+        PROFILE_COUNT(siteUpdates, size);
+        PROFILE_COUNT(clusters, 1);
+        PROFILE_COUNT(clusterSites, size);
     }
 
     void ClusterContainer::doStep(mt19937_64& seed, double deltaIn)
@@ -169,9 +296,162 @@ namespace TopoOsciSim
 
     void ClusterContainer::writeInfosToFile()
     {
+        // create files with first output
+        if (!fSize.f.is_open())
+        {
+            fSize.create();
+            fProb.create();
+            fMeanPhiSq.create();
+        }
+
         fSize.printValueToFile(size);
         fProb.printValueToFile(bondProb);
         fMeanPhiSq.printValueToFile(lattice->meanPhiSq);
     }
 
+    void ClusterContainer::setTracker(ObservableTracker* t)
+    {
+        tracker = t;
+        instanton.setTracker(t);
+    }
+
+    // Take parameters of next point (diagnostic files get new names)
+    void ClusterContainer::setParameters(const ParameterContainer& p)
+    {
+        fastMath = FastMath::getAccuracy(p.fastMath);
+        floatSweeps = (p.precision == "float");
+        instanton.setParameters(p);
+        if (fSize.f.is_open())
+            fSize.f.close();
+        fSize.name = FileName("ClusterSize", p.outputDirectory, p);
+        if (fProb.f.is_open())
+            fProb.f.close();
+        fProb.name = FileName("ClusterProb", p.outputDirectory, p);
+        if (fMeanPhiSq.f.is_open())
+            fMeanPhiSq.f.close();
+        fMeanPhiSq.name = FileName("MeanPhiSq", p.outputDirectory, p);
+    }
+
+    void ClusterContainer::dumpState(ostream& out)
+    {
+        instanton.dumpState(out);
+    }
+
+    void ClusterContainer::readState(istream& in)
+    {
+        instanton.readState(in);
+    }
+
+    void ClusterContainer::run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink)
+    {
+        if (floatSweeps)
+            lattice->getAngles(phiFloat);
+        runEquilibration(*this, seed, nSteps, measureEvery, sink);
+        if (floatSweeps)
+            lattice->setAngles(phiFloat);
+    }
+
+    void ClusterContainer::finishStep()
+    {
+        if (tracker && !floatSweeps)
+            tracker->finishStep();
+    }
+
+    void ClusterContainer::prepareMeasurement()
+    {
+        // float sweeps: observables summed in double from the float angles
+        if (floatSweeps)
+        {
+            lattice->setAngles(phiFloat);
+            if (tracker)
+            {
+                tracker->recompute();
+                tracker->finishStep();
+                return;
+            }
+        }
+        if (tracker)
+            return;
+        lattice->mod2Pi();
+        lattice->computeMeanPhiSq();
+    }
+
+    // Improved estimators of the last cluster (flip invariant)
+    void ClusterContainer::computeImprovedEstimators()
+    {
+        int xdim = lattice->xdim;
+        vector<double> sigma(size);
+        double sum = 0.;
+        for (int i=0; i<size; i++)
+        {
+            sigma[i] = cos(lattice->tslice[(leftBorder + i + xdim) % xdim].phi - angle);
+            sum += sigma[i];
+        }
+
+        // factor 2: number of spin components
+        improvedSusceptibility = 2. / size * sum * sum;
+        improvedMeanSpinSq = improvedSusceptibility / xdim;
+        if (improvedEstimators < 2)
+            return;
+
+        // pairs at separation d inside the cluster
+        vector<double> pairSum(size, 0.);
+        for (int d=0; d<size; d++)
+            for (int i=0; i+d<size; i++)
+                pairSum[d] += sigma[i] * sigma[i+d];
+
+        // separation j forward or xdim-j backward (around the ring,
+        // not with open boundaries)
+        bool periodic = (lattice->boundary == 'p');
+        for (int j=0; j<xdim; j++)
+        {
+            improvedCorr[j] = ((j < size) ? pairSum[j] : 0.)
+                + ((periodic && (j > 0) && (xdim-j < size)) ? pairSum[xdim-j] : 0.);
+            improvedCorr[j] *= 2. / size;
+        }
+    }
+
+    vector<string> ClusterContainer::getInfoNames()
+    {
+        vector<string> names = {"ClusterSize", "ClusterProb", "MeanPhiSq"};
+        if (improvedEstimators)
+            names.insert(names.end(), {"ImprovedSusceptibility", "ImprovedMeanSpinSq"});
+        if (improvedEstimators > 1)
+            names.push_back("ImprovedCorr");
+        if (instanton.enabled())
+            names.push_back("InstantonAcc");
+        return names;
+    }
+
+    vector<int> ClusterContainer::getInfoWidths()
+    {
+        if (!improvedEstimators)
+            return vector<int>();
+        vector<int> widths = {1, 1, 1, 1, 1};
+        if (improvedEstimators > 1)
+            widths.push_back(lattice->xdim);
+        if (instanton.enabled())
+            widths.push_back(1);
+        return widths;
+    }
+
+    void ClusterContainer::appendInfos(vector<double>& values)
+    {
+        values.push_back(size);
+        values.push_back(bondProb);
+        values.push_back(lattice->meanPhiSq);
+
+        if (improvedEstimators)
+        {
+            computeImprovedEstimators();
+            values.push_back(improvedSusceptibility);
+            values.push_back(improvedMeanSpinSq);
+            if (improvedEstimators > 1)
+                values.insert(values.end(), improvedCorr.begin(), improvedCorr.end());
+        }
+
+        if (instanton.enabled())
+            values.push_back(instanton.getAcceptance());
+    }
+
 } // TopoOsciSim
@@ -4,13 +4,21 @@
 #include <iostream>
 #include <random>
 #include "lattice.hpp"
+#include "observableTracker.hpp"
 #include "latticeEquilibration.hpp"
+#include "fastMath.hpp"
+#include "instanton.hpp"
 
 using namespace std;
 
 namespace TopoOsciSim
 {
 
+    // Number of bond probabilities computed at once with fastMath, the
+    // block doubles with each block of a step up to clusterBondBlockMax
+    const int clusterBondBlock = 4;
+    const int clusterBondBlockMax = 64;
+
     class ClusterContainer : public LatticeEquilibration
     {
         
@@ -18,6 +26,9 @@ namespace TopoOsciSim
         
         // Pointer to LatticeContainer
         LatticeContainer* lattice;
+
+        // Pointer to ObservableTracker (NULL if observables are not tracked)
+        ObservableTracker* tracker;
         
         // Starting position of cluster algorithm on the lattice
         int start;
@@ -37,6 +48,34 @@ namespace TopoOsciSim
         // mean cluster bond probability
         double bondProb;
 
+        // Cluster-improved estimators of the last step (1: without, 2:
+        // with correlator)
+        int improvedEstimators;
+        double improvedSusceptibility;
+        double improvedMeanSpinSq;
+        vector<double> improvedCorr;
+
+        // Accuracy of cos and exp (libm: bond probabilities one by one)
+        FastMath::Accuracy fastMath;
+
+        // Bond probabilities of the running step, computed in blocks
+        // in the direction of growth
+        long stepNumber;
+        int blockSize;
+        vector<long> bondStep;
+        vector<double> bondCache;
+        vector<int> blockBonds;
+        vector<double> blockCos;
+        vector<double> blockExp;
+
+        // Angles of the float sweeps (precision float), the lattice is
+        // only set from them for measurements and at the end of run
+        bool floatSweeps;
+        vector<float> phiFloat;
+
+        // Winding insertion proposed after every instantonEvery-th step
+        InstantonContainer instanton;
+
         FileObs fSize;
         FileObs fProb;
         FileObs fMeanPhiSq;
@@ -65,6 +104,27 @@ namespace TopoOsciSim
         */
         double getBondProbability(int id);
 
+        /**
+           Return probability for bond between index and next
+           timestep from the cache of the step, compute the next
+           blockSize bonds in direction with vectorized cos and exp if
+           it is not there
+
+           @param id        Lattice index
+           @param direction 1 (growing right) or -1 (growing left)
+           @return          Probability
+        */
+        double getCachedBondProbability(int id, int direction);
+
+        /**
+           Return probability for bond between index and next timestep
+           from the float angles, computed in float
+
+           @param id  Lattice index
+           @return Probability
+        */
+        double getBondProbabilityFloat(int id);
+
         /**
            Create cluster on lattice (find leftBorder and
            rightBorder)
@@ -84,6 +144,56 @@ namespace TopoOsciSim
         void doStep(mt19937_64& seed, double deltaIn);
 
         void writeInfosToFile();
+
+        /**
+           Update lattice through tracker to keep observables up to date
+
+           @param t pointer to ObservableTracker
+        */
+        void setTracker(ObservableTracker* t);
+
+        /**
+           Take parameters of next point on same lattice
+
+           @param p Parameters
+        */
+        void setParameters(const ParameterContainer& p);
+
+        // Write and read instanton state (for checkpoints)
+        void dumpState(ostream& out);
+        void readState(istream& in);
+
+        /**
+           Do nSteps steps and measure after every measureEvery-th step
+
+           @param seed         Seed number
+           @param nSteps       Number of steps
+           @param measureEvery Number of steps between measurements
+           @param sink         Gets measurements and diagnostics (NULL: no measurements)
+        */
+        void run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink);
+
+        // Update tracked observables after each step of run
+        void finishStep();
+
+        // Set lattice mod 2pi and meanPhiSq if observables are not tracked
+        // (float sweeps: lattice and tracked observables from phiFloat)
+        void prepareMeasurement();
+
+        /**
+           Improved estimators of the last cluster from the spin
+           projections sigma = cos(phi - angle) inside it:
+           susceptibility 2/size (sum sigma)^2 and its mean spin
+           square (divided by xdim) in O(size), with improvedEstimators
+           2 also the correlator <cos(phi_x - phi_x+j)> = 2/size sum
+           sigma_x sigma_x+j over pairs inside the cluster in O(size^2).
+        */
+        void computeImprovedEstimators();
+
+        // Names, number of values and values of the diagnostics of one step
+        vector<string> getInfoNames();
+        vector<int> getInfoWidths();
+        void appendInfos(vector<double>& values);
     };    
 
 
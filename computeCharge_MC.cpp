@@ -14,6 +14,8 @@
 #include "timestep.hpp"
 #include "lattice.hpp"
 #include "cluster.hpp"
+#include "fixedLattice.hpp"
+#include "profiler.hpp"
 
 using namespace std;
 
@@ -60,9 +62,20 @@ int main (int argc, char *argv[])
     TopoOsciSim::FileObs fS("S", parameters);
     fS.create();
 
+    // bias of metadynamics configurations (for reweighting)
+    TopoOsciSim::FileObs* fV = NULL;
+    if (lattice.biasConfigs)
+    {
+        fV = new TopoOsciSim::FileObs("V", parameters);
+        fV->create();
+    }
+
     // complex<double> plaqComplex;
     double plaq;
     double link=0., link2=0.;
+    double qSq=0., qSq2=0.;
+    // metadynamics configurations are reweighted with exp(V)
+    double weight=1., weightSum=0., weightSqSum=0., weightShift=0.;
     // read configuration
     if (parameters.verbosity > 5) cout << "Read Configuration and Compute Q ..." << endl;
     for (int i=0; i<parameters.Nsteps; i++)
@@ -74,21 +87,59 @@ int main (int argc, char *argv[])
             break;
 
         
-        // compute topological charge
-        lattice.computeQ();
-        fCharge.f << lattice.q << endl;
-        fS.f << lattice.getAction() << endl;
-
-        // compute link
-        lattice.mod2Pi();
-        plaq = lattice.computePlaquette();
-        fPlaquette.f << plaq << endl;
-        link += plaq;
-        link2 += plaq*plaq;
+        // compute topological charge, action and link
+        double S;
+        {
+            PROFILE_SCOPE(observables);
+            if (lattice.biasConfigs)
+            {
+                if (i == 0)
+                    weightShift = lattice.biasWeight;
+                weight = exp(lattice.biasWeight - weightShift);
+            }
+            weightSum += weight;
+            weightSqSum += weight * weight;
+
+            TopoOsciSim::LatticeKernelDispatcher::computeQ(lattice);
+            qSq += weight * lattice.q * lattice.q;
+            qSq2 += weight * lattice.q * lattice.q * lattice.q * lattice.q;
+            S = TopoOsciSim::LatticeKernelDispatcher::getAction(lattice);
+
+            lattice.mod2Pi();
+            plaq = lattice.computePlaquette();
+            link += weight * plaq;
+            link2 += weight * plaq*plaq;
+        }
+
+        {
+            PROFILE_SCOPE(observableIO);
+            fCharge.f << lattice.q << endl;
+            fS.f << S << endl;
+            fPlaquette.f << plaq << endl;
+            if (fV)
+                fV->f << lattice.biasWeight << endl;
+        }
 
     }
     if (parameters.verbosity > 5) cout << endl << "\t\t\t\t ... finished" << endl;
-    link /= (double)parameters.Nsteps;
-    link2 /= (double)parameters.Nsteps;
-    cout << "link = " << link << " +- " << sqrt((link2 - link*link)/(double)(parameters.Nsteps)) << endl;
+
+    // weighted means with effective number of configurations
+    double norm = parameters.Nsteps;
+    double Neff = parameters.Nsteps;
+    if (lattice.biasConfigs)
+    {
+        norm = weightSum;
+        Neff = weightSum * weightSum / weightSqSum;
+        cout << "reweighted, effective number of configurations = " << Neff << endl;
+    }
+    link /= norm;
+    link2 /= norm;
+    cout << "link = " << link << " +- " << sqrt((link2 - link*link)/Neff) << endl;
+    qSq /= norm;
+    qSq2 /= norm;
+    cout << "<Q^2> = " << qSq << " +- " << sqrt((qSq2 - qSq*qSq)/Neff) << endl;
+
+    delete fV;
+
+    PROFILE_WRITE("ComputeCharge", parameters);
 }
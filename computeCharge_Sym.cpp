@@ -0,0 +1,69 @@
+/**
+   TopoOsciSim
+   computeCharge_Sym.cpp
+   Purpose: Compute Topological Charge with the symmetrized integration method
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <random>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "symmetrization.hpp"
+
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // initialize random generator
+    random_device rd;
+    mt19937_64 generator(rd());
+
+    // define and initialize parameters
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+    parameters.equilibrationAlgorithm = "symmetrization";
+
+    // sampling points are not drawn with a bias
+    if (parameters.metaHeight > 0.)
+    {
+        cerr << "ERROR: Symmetrized integration does not support metadynamics" << endl;
+        exit(0);
+    }
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION            " << endl;
+        cout << endl;
+        cout << "     Symmetrization  --  Compute Topological Charge  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    TopoOsciSim::SymmetrizationIntegrator integrator(parameters);
+
+    if (parameters.verbosity > 5) cout << "Evaluate symmetrized sampling points on " << integrator.Nthreads << " threads ..." << endl;
+    integrator.run(generator);
+    if (parameters.verbosity > 5) cout << "\t\t\t\t ... finished" << endl;
+
+    integrator.writeToFiles();
+
+    // expectation values
+    double errQ, errQSq;
+    complex<double> Q   = integrator.getExpectationValue(integrator.sumQ, errQ);
+    complex<double> QSq = integrator.getExpectationValue(integrator.sumQSq, errQSq);
+
+    // error^2 * cpu time is independent of Nsteps and can be compared to the MC path
+    cout << "pruned   = " << integrator.Npruned << " / " << parameters.Nsteps << endl;
+    cout << "<Q>      = " << Q   << " +- " << errQ   << endl;
+    cout << "<Q^2>    = " << QSq << " +- " << errQSq << endl;
+    cout << "cpu time = " << integrator.cpuTime << " s" << endl;
+    cout << "err(Q^2)^2 * cpu time = " << errQSq * errQSq * integrator.cpuTime << " s" << endl;
+}
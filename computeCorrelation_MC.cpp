@@ -9,11 +9,15 @@
 
 #include <iostream>
 #include <random>
+#include <vector>
+#include <cmath>
 #include "parameters.hpp"
 #include "file.hpp"
 #include "timestep.hpp"
 #include "lattice.hpp"
 #include "cluster.hpp"
+#include "fixedLattice.hpp"
+#include "profiler.hpp"
 
 using namespace std;
 
@@ -41,6 +45,17 @@ int main (int argc, char *argv[])
     TopoOsciSim::LatticeContainer lattice(parameters);
     // read configuration constants to lattice
     lattice.readHeader(fConf);
+
+    // metadynamics configurations: bias for reweighting and correlator
+    // reweighted with exp(V)
+    TopoOsciSim::FileObs* fV = NULL;
+    if (lattice.biasConfigs)
+    {
+        fV = new TopoOsciSim::FileObs("V", parameters);
+        fV->create();
+    }
+    vector<double> corrWeighted(lattice.xdim, 0.);
+    double weightSum=0., weightSqSum=0., weightShift=0.;
     
     // read configuration
     for (int i=0; i<parameters.Nsteps; i++)
@@ -50,12 +65,34 @@ int main (int argc, char *argv[])
             break;
         
         // compute correlation of lattice variable
-        lattice.computeCorr();
+        {
+            PROFILE_SCOPE(observables);
+            TopoOsciSim::LatticeKernelDispatcher::computeCorr(lattice);
+        }
+
+        if (fV)
+        {
+            if (i == 0)
+                weightShift = lattice.biasWeight;
+            double weight = exp(lattice.biasWeight - weightShift);
+            weightSum += weight;
+            weightSqSum += weight * weight;
+            for (int j=0; j<lattice.xdim; j++)
+                corrWeighted[j] += weight * lattice.corr[j];
+            fV->f << lattice.biasWeight << endl;
+        }
 
         // save correlation in file
         lattice.dumpCorr(fCorr, i);
     }
-    
 
+    if (fV)
+    {
+        cout << "reweighted, effective number of configurations = " << weightSum * weightSum / weightSqSum << endl;
+        for (int j=0; j<lattice.xdim; j++)
+            cout << "corr[" << j << "] = " << corrWeighted[j] / weightSum << endl;
+        delete fV;
+    }
 
+    PROFILE_WRITE("ComputeCorrelation", parameters);
 }
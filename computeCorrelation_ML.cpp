@@ -0,0 +1,99 @@
+/**
+   TopoOsciSim
+   computeCorrelation_ML.cpp
+   Purpose: Compute Correlation of lattice variables with multilevel sampling
+
+   @author Julia Volmer
+   @version 1.0 
+*/
+
+#include <iostream>
+#include <random>
+#include <ctime>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "multilevel.hpp"
+#include "profiler.hpp"
+#include "latticeEquilibrationFactory.hpp"
+
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // initialize random generator
+    random_device rd;
+    mt19937_64 generator(rd());
+
+    // define and initialize parameters
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+
+    // resampled segments stay in the chain, which has no weights
+    if (parameters.metaHeight > 0.)
+    {
+        cerr << "ERROR: Multilevel correlator does not support metadynamics" << endl;
+        exit(0);
+    }
+
+    // the outer steps are taken one by one on the double lattice
+    if (parameters.precision != "double")
+    {
+        cerr << "ERROR: Multilevel correlator needs precision double" << endl;
+        exit(0);
+    }
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION       " << endl;
+        cout << endl;
+        cout << "     Multilevel Correlation  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    // open file to save correlations in
+    TopoOsciSim::FileObs fCorr("CorrML", parameters);
+    fCorr.create();
+
+    // set lattice
+    TopoOsciSim::LatticeContainer lattice(parameters);
+    lattice.setPeriodicBoundaries();
+    lattice.setRandom(generator);
+
+    // outer updates move the frozen sites
+    TopoOsciSim::LatticeEquilibration *latticeEquilibration = TopoOsciSim::NewLatticeEquilibrationFor(&lattice, parameters);
+    TopoOsciSim::MultilevelContainer multilevel(&lattice, parameters);
+
+    clock_t cpuStart = clock();
+    {
+        PROFILE_SCOPE(thermalization);
+        latticeEquilibration->run(generator, parameters.Nthermal, 1, NULL);
+    }
+
+    for (int i=0; i<parameters.Nsteps; i++)
+    {
+        {
+            PROFILE_SCOPE(production);
+            latticeEquilibration->doStep(generator);
+        }
+        {
+            PROFILE_SCOPE(observables);
+            multilevel.computeCorr(generator);
+        }
+
+        // save correlation in file
+        lattice.dumpCorr(fCorr, i);
+    }
+
+    if (parameters.verbosity > 2)
+        cout << "cpu time = " << (clock() - cpuStart) / (double)CLOCKS_PER_SEC << " s" << endl;
+
+    delete latticeEquilibration;
+
+    PROFILE_WRITE("ComputeCorrelationML", parameters);
+}
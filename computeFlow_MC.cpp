@@ -0,0 +1,142 @@
+/**
+   TopoOsciSim
+   computeFlow_MC.cpp
+   Purpose: Compute topological charge, action and correlation of MC
+            configurations after gradient flow or cooling
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "smoothing.hpp"
+
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // define and initialize parameters
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+    parameters.Nthermal = -1;
+    parameters.Nsym = -1;
+
+    int Nthreads = parameters.Nthreads;
+    if (Nthreads <= 0)
+        Nthreads = thread::hardware_concurrency();
+    if (Nthreads <= 0)
+        Nthreads = 1;
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION            " << endl;
+        cout << endl;
+        cout << "     Smoothing  --  Flowed Observables        " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    // open config file
+    TopoOsciSim::FileConfig fConf(parameters);
+    fConf.open();
+
+    // set lattice
+    TopoOsciSim::LatticeContainer lattice(parameters);
+
+    // read configuration constants
+    lattice.readHeader(fConf);
+
+    // one batch per thread
+    vector<TopoOsciSim::SmoothingContainer*> batches;
+    for (int w=0; w<Nthreads; w++)
+        batches.push_back(new TopoOsciSim::SmoothingContainer(parameters, lattice));
+    const vector<double>& times = batches[0]->times;
+    int Ntimes = times.size();
+    int batchSize = parameters.smoothingBatch;
+
+    // one line per configuration, one column per time (FlowCorr: xdim
+    // columns per time)
+    TopoOsciSim::FileObs fCharge("FlowQ", parameters);
+    fCharge.create();
+
+    TopoOsciSim::FileObs fS("FlowS", parameters);
+    fS.create();
+
+    TopoOsciSim::FileObs fCorrelation("FlowCorr", parameters);
+    fCorrelation.create();
+
+    vector<double> qSq(Ntimes, 0.), qSq2(Ntimes, 0.), action(Ntimes, 0.);
+    long Nconfigs = 0;
+    bool done = false;
+    while (!done)
+    {
+        // read batches, stop at Nsteps or end of file
+        for (int w=0; w<Nthreads; w++)
+        {
+            batches[w]->clear();
+            while (!done && (batches[w]->Nconfigs < batchSize))
+            {
+                if ((Nconfigs >= parameters.Nsteps) || !lattice.readConf(fConf))
+                    done = true;
+                else
+                {
+                    batches[w]->push(lattice);
+                    Nconfigs++;
+                }
+            }
+        }
+
+        vector<thread> workers;
+        for (int w=0; w<Nthreads; w++)
+            workers.push_back(thread(&TopoOsciSim::SmoothingContainer::run, batches[w]));
+        for (int w=0; w<Nthreads; w++)
+            workers[w].join();
+
+        // write in order of the chain
+        for (int w=0; w<Nthreads; w++)
+        {
+            TopoOsciSim::SmoothingContainer& batch = *batches[w];
+            for (int b=0; b<batch.Nconfigs; b++)
+            {
+                for (int k=0; k<Ntimes; k++)
+                {
+                    double q = batch.charges[k*batchSize + b];
+                    double S = batch.actions[k*batchSize + b];
+                    qSq[k] += q * q;
+                    qSq2[k] += q * q * q * q;
+                    action[k] += S;
+
+                    fCharge.f << q << ((k+1 < Ntimes) ? '\t' : '\n');
+                    fS.f << S << ((k+1 < Ntimes) ? '\t' : '\n');
+                    for (int j=0; j<lattice.xdim; j++)
+                        fCorrelation.f << batch.correlations[(k*lattice.xdim + j)*batchSize + b]
+                                       << (((k+1 < Ntimes) || (j+1 < lattice.xdim)) ? '\t' : '\n');
+                }
+            }
+        }
+    }
+    // end of file is expected
+    fConf.f.clear();
+
+    for (int k=0; k<Ntimes; k++)
+    {
+        qSq[k] /= Nconfigs;
+        qSq2[k] /= Nconfigs;
+        action[k] /= Nconfigs;
+        cout << parameters.smoothing << " time " << times[k] << ": <Q^2> = " << qSq[k] << " +- "
+             << sqrt((qSq2[k] - qSq[k]*qSq[k])/Nconfigs) << ", <S> = " << action[k] << endl;
+    }
+
+    for (int w=0; w<Nthreads; w++)
+        delete batches[w];
+}
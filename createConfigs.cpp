@@ -9,10 +9,18 @@
 
 #include <iostream>
 #include <random>
+#include <ctime>
 #include "parameters.hpp"
 #include "file.hpp"
 #include "timestep.hpp"
 #include "lattice.hpp"
+#include "observableTracker.hpp"
+#include "measurementSink.hpp"
+#include "profiler.hpp"
+#include "checkpoint.hpp"
+#include "thermalCache.hpp"
+#include "catalog.hpp"
+#include "pipeline.hpp"
 #include "latticeEquilibrationFactory.hpp"
  
 using namespace std;
@@ -21,7 +29,8 @@ int main (int argc, char *argv[])
 {
     // initialize random generator
     random_device rd;
-    mt19937_64 generator(rd());
+    unsigned long seed = rd();
+    mt19937_64 generator(seed);
 
     // define and initialize parameters
     TopoOsciSim::ParameterContainer parameters;
@@ -40,50 +49,142 @@ int main (int argc, char *argv[])
         cout << parameters << endl;
     }
 
+    // a resumed run is found by its id, a new id has no checkpoint
+    if (parameters.resume && (parameters.fileId == -1))
+    {
+        cerr << "ERROR: --resume needs the fileId of the run" << endl;
+        exit(0);
+    }
+
+    // one id for all files of a new run
+    TopoOsciSim::RunCatalog catalog(parameters.configDirectory);
+    if (parameters.fileId == -1)
+    {
+        string key = "Conf" + TopoOsciSim::FileExtension("Conf", parameters).fullExtension;
+        parameters.fileId = catalog.allocateId(key, parameters.configDirectory + key);
+    }
+
     // set lattice
     TopoOsciSim::LatticeContainer lattice(parameters);
-    lattice.setPeriodicBoundaries();
+    lattice.setBoundaries(parameters);
     lattice.setRandom(generator);
     
     TopoOsciSim::LatticeEquilibration *latticeEquilibration = TopoOsciSim::NewLatticeEquilibrationFor(&lattice, parameters);
     
     
-    // do MC thermalization
-    if (parameters.verbosity > 5) cout << "Thermalization ... " << endl;
+    TopoOsciSim::FileConfig Conf(parameters);
+    TopoOsciSim::CheckpointContainer checkpoint(parameters, Conf.name.index);
+    TopoOsciSim::ThermalCacheContainer cache(parameters);
 
-    for (int k = 0; k<parameters.Nthermal; k++)
+    // continue from checkpoint: output files are cut back to the checkpoint
+    if (parameters.resume)
     {
-        if (parameters.verbosity > 5) cout << "\r\t\t\t" << k + 1;
-
-        latticeEquilibration->doStep(generator, 0.5);
+        if (!checkpoint.exist())
+        {
+            cerr << "ERROR: No checkpoint " << checkpoint.name.fullName << " to resume from" << endl;
+            exit(0);
+        }
+        checkpoint.read(generator, lattice, *latticeEquilibration);
+        checkpoint.truncateFiles();
+        Conf.append();
+        if (parameters.verbosity > 5)
+            cout << "Resume after " << checkpoint.NthermalDone << " thermalization and "
+                 << checkpoint.NstepsDone << " steps" << endl;
+    }
+    else
+    {
+        // warm start: only re-equilibrate nearest cached lattice
+        if (cache.enabled() && cache.load(lattice))
+        {
+            // the bias starts from zero and is built during thermalization
+            int Nrethermal = (parameters.metaHeight > 0.) ? max(parameters.Nrethermal, parameters.metaBuildup) : parameters.Nrethermal;
+            checkpoint.NthermalDone = max(0L, (long)(parameters.Nthermal - Nrethermal));
+            if (parameters.verbosity > 5)
+                cout << "Start from cached lattice with I = " << cache.I << ", a = " << cache.a
+                     << ", theta = " << cache.theta << endl;
+        }
+
+        Conf.create();
+
+        // write header to file
+        lattice.dumpHeader(Conf);
     }
-    if (parameters.verbosity > 5) cout << endl << "\t\t\t\t ... finished" << endl << endl;
+    
+    clock_t cpuStart = clock();
 
-    TopoOsciSim::FileConfig Conf(parameters);
-    Conf.create();
+    // do MC thermalization
+    if (parameters.verbosity > 5) cout << "Thermalization ... " << endl;
+    {
+        PROFILE_SCOPE(thermalization);
+        while (checkpoint.NthermalDone < parameters.Nthermal)
+        {
+            int n = checkpoint.getNextChunk(parameters.Nthermal - checkpoint.NthermalDone);
+            latticeEquilibration->run(generator, n, 1, NULL);
+            checkpoint.NthermalDone += n;
+            if (parameters.checkpointInterval > 0)
+                checkpoint.dump(generator, lattice, *latticeEquilibration, NULL, &Conf, NULL);
+        }
+    }
+    if (parameters.verbosity > 5) cout << "\t\t\t\t ... finished" << endl << endl;
 
-    // write header to file
-    lattice.dumpHeader(Conf);
+    // keep lattice mod 2pi and observables up to date during updates
+    lattice.mod2Pi();
+    TopoOsciSim::ObservableTracker tracker(&lattice, parameters);
+    if (checkpoint.hasTracker)
+        checkpoint.restoreTracker(tracker);
+    latticeEquilibration->setTracker(&tracker);
 
     // do MC
     if (parameters.verbosity > 5) cout << "Create Configurations ... " << endl;
 
-    for (int k = 0; k<parameters.Nsteps; k++)
+    // write configurations and diagnostics after every step
+    TopoOsciSim::FileSink sink(&lattice, (parameters.Nthermal > 0) ? &Conf : NULL, parameters, checkpoint.NstepsDone > 0);
+
+    // analysis of the configurations on other threads
+    TopoOsciSim::PipelineSink* pipeline = NULL;
+    TopoOsciSim::MeasurementSink* measurementSink = &sink;
+    if (parameters.analysisThreads > 0)
     {
-        if (parameters.verbosity > 5) cout << "\r\t\t\t" << k + 1;
-
-        // for (int j=0; j<10;j++)
-        latticeEquilibration->doStep(generator);
-        
-        // write configuration to file
-        lattice.mod2Pi();
-        lattice.computeMeanPhiSq();
-        
-        latticeEquilibration->writeInfosToFile();
-
-        if (parameters.Nthermal > 0)
-            lattice.dumpConf(Conf);
+        pipeline = new TopoOsciSim::PipelineSink(&sink, &lattice, parameters, checkpoint.NstepsDone, checkpoint.NstepsDone > 0);
+        measurementSink = pipeline;
     }
-    if (parameters.verbosity > 5) cout << endl << "\t\t\t\t ... finished" << endl;
+    {
+        PROFILE_SCOPE(production);
+        while (checkpoint.NstepsDone < parameters.Nsteps)
+        {
+            int n = checkpoint.getNextChunk(parameters.Nsteps - checkpoint.NstepsDone);
+            latticeEquilibration->run(generator, n, 1, measurementSink);
+            checkpoint.NstepsDone += n;
+            if (parameters.checkpointInterval > 0)
+                checkpoint.dump(generator, lattice, *latticeEquilibration, &tracker, &Conf, &sink, pipeline);
+        }
+    }
+
+    if (parameters.verbosity > 5) cout << "\t\t\t\t ... finished" << endl;
+
+    if (cache.enabled())
+        cache.store(lattice);
+
+    Conf.f.flush();
+    vector<string> obsFiles;
+    for (unsigned int i=0; i<sink.files.size(); i++)
+    {
+        sink.files[i]->f.flush();
+        obsFiles.push_back(sink.files[i]->name.fullName);
+    }
+    if (pipeline)
+    {
+        pipeline->finish();
+        for (unsigned int i=0; i<pipeline->files.size(); i++)
+            obsFiles.push_back(pipeline->files[i]->name.fullName);
+    }
+    catalog.recordRun(parameters, Conf.name.fullName, obsFiles, (parameters.Nthermal > 0) ? parameters.Nsteps : 0,
+                      parameters.resume ? "" : to_string(seed));
+    delete pipeline;
+
+    // cpu time to compare with other integration methods
+    if (parameters.verbosity > 2)
+        cout << "cpu time = " << (clock() - cpuStart) / (double)CLOCKS_PER_SEC << " s" << endl;
 
+    PROFILE_WRITE("CreateConfigs", parameters);
 }
@@ -0,0 +1,116 @@
+/**
+   TopoOsciSim
+   createConfigsXY.cpp
+   Purpose: Simulate the D-dimensional XY model to create configurations.
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <random>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "xyLattice.hpp"
+#include "latticeEquilibrationFactory.hpp"
+
+using namespace std;
+
+template<int D, int B>
+void createConfigs(TopoOsciSim::ParameterContainer& parameters, mt19937_64& generator)
+{
+    // set lattice
+    TopoOsciSim::XYLatticeContainer<D, B> lattice(parameters);
+    lattice.setPeriodicBoundaries();
+    lattice.setRandom(generator);
+
+    TopoOsciSim::LatticeEquilibration *latticeEquilibration = TopoOsciSim::NewLatticeEquilibrationFor(&lattice, parameters);
+    if (latticeEquilibration == NULL)
+    {
+        cerr << "ERROR: Unknown equilibrationAlgorithm " << parameters.equilibrationAlgorithm << endl;
+        exit(0);
+    }
+
+    // do MC thermalization
+    if (parameters.verbosity > 5) cout << "Thermalization ... " << endl;
+    latticeEquilibration->run(generator, parameters.Nthermal, 1, NULL);
+    if (parameters.verbosity > 5) cout << "\t\t\t\t ... finished" << endl << endl;
+
+    TopoOsciSim::FileConfig Conf(parameters);
+    Conf.create();
+    lattice.dumpHeader(Conf);
+
+    TopoOsciSim::FileObs fCharge("Q", parameters);
+    fCharge.create();
+    TopoOsciSim::FileObs fS("S", parameters);
+    fS.create();
+
+    // do MC
+    if (parameters.verbosity > 5) cout << "Create Configurations ... " << endl;
+    for (int k = 0; k<parameters.Nsteps; k++)
+    {
+        latticeEquilibration->doStep(generator);
+
+        lattice.mod2Pi();
+        lattice.computeMeanPhiSq();
+        lattice.computeQ();
+        fCharge.printValueToFile(lattice.q);
+        fS.printValueToFile(lattice.getAction());
+
+        latticeEquilibration->writeInfosToFile();
+
+        lattice.dumpConf(Conf);
+    }
+    if (parameters.verbosity > 5) cout << "\t\t\t\t ... finished" << endl;
+
+    delete latticeEquilibration;
+}
+
+int main (int argc, char *argv[])
+{
+    // initialize random generator
+    random_device rd;
+    mt19937_64 generator(rd());
+
+    // define and initialize parameters
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "XY MODEL SILMULATION                          " << endl;
+        cout << endl;
+        cout << "     Create Configurations  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    // the XY engines only do the plain updates
+    if ((parameters.fastMath != "off") || (parameters.instantonEvery > 0) || (parameters.metaHeight > 0.)
+        || (parameters.boundary != "periodic") || (parameters.improvedEstimators != 0)
+        || (parameters.checkpointInterval > 0) || (parameters.resume != 0) || (parameters.precision != "double")
+        || (parameters.analysisThreads > 0) || !parameters.cacheDirectory.empty())
+    {
+        cerr << "ERROR: createConfigsXY does not support fastMath, instantonEvery, metaHeight, open boundaries, "
+             << "improvedEstimators, checkpoints, precision, analysisThreads or cacheDirectory" << endl;
+        exit(0);
+    }
+
+    // tiles of 4^D sites if they fit, otherwise row-major order
+    bool tiled = (parameters.xdim % 4 == 0);
+    if (parameters.dim == 1)
+        tiled ? createConfigs<1, 4>(parameters, generator) : createConfigs<1, 1>(parameters, generator);
+    else if (parameters.dim == 2)
+        tiled ? createConfigs<2, 4>(parameters, generator) : createConfigs<2, 1>(parameters, generator);
+    else if (parameters.dim == 3)
+        tiled ? createConfigs<3, 4>(parameters, generator) : createConfigs<3, 1>(parameters, generator);
+    else
+    {
+        cerr << "ERROR: dim " << parameters.dim << " is not supported" << endl;
+        exit(0);
+    }
+}
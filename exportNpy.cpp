@@ -0,0 +1,170 @@
+/**
+   TopoOsciSim
+   exportNpy.cpp
+   Purpose: Export configurations and observables of a run as NumPy files
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "fixedLattice.hpp"
+
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // define and initialize parameters
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+    parameters.Nthermal = -1;
+    parameters.Nsym = -1;
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION            " << endl;
+        cout << endl;
+        cout << "     Export  --  NumPy Files                  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    // open config file
+    TopoOsciSim::FileConfig fConf(parameters);
+    fConf.open();
+
+    // set lattice
+    TopoOsciSim::LatticeContainer lattice(parameters);
+
+    // read configuration constants
+    lattice.readHeader(fConf);
+    int xdim = lattice.xdim;
+
+    // configurations [Nconf, xdim] in precision of the run
+    TopoOsciSim::FileNpy fConfNpy("Conf", parameters.configDirectory, parameters);
+    fConfNpy.create(lattice.floatConfigs ? "'<f4'" : "'<f8'", {xdim});
+
+    // observables of each configuration (and bias for reweighting)
+    string descr = "[" + TopoOsciSim::FileNpy::getField("Q", "<f8", 1)
+        + ", " + TopoOsciSim::FileNpy::getField("S", "<f8", 1)
+        + ", " + TopoOsciSim::FileNpy::getField("Plaq", "<f8", 1)
+        + ", " + TopoOsciSim::FileNpy::getField("Corr", "<f8", xdim);
+    if (lattice.biasConfigs)
+        descr += ", " + TopoOsciSim::FileNpy::getField("V", "<f8", 1);
+    descr += "]";
+    TopoOsciSim::FileNpy fObs("Obs", parameters.outputDirectory, parameters);
+    fObs.create(descr, {});
+
+    vector<float> phiFloat(xdim);
+    vector<double> record(3 + xdim + (lattice.biasConfigs ? 1 : 0));
+    long Nconf = 0;
+    for (int i=0; i<parameters.Nsteps; i++)
+    {
+        // read conf and check for error (e.g. eof)
+        if (!lattice.readConf(fConf))
+            break;
+
+        // angles as stored (float configurations are exact)
+        if (lattice.floatConfigs)
+        {
+            for (int j=0; j<xdim; j++)
+                phiFloat[j] = lattice.tslice[j].phi;
+            fConfNpy.f.write(reinterpret_cast<char*>(phiFloat.data()), xdim * sizeof(float));
+        }
+        else
+            for (int j=0; j<xdim; j++)
+                fConfNpy.f.write(reinterpret_cast<char*>(&(lattice.tslice[j].phi)), sizeof(double));
+
+        // like computeCharge_MC and computeCorrelation_MC
+        TopoOsciSim::LatticeKernelDispatcher::computeQ(lattice);
+        record[0] = lattice.q;
+        record[1] = TopoOsciSim::LatticeKernelDispatcher::getAction(lattice);
+        TopoOsciSim::LatticeKernelDispatcher::computeCorr(lattice);
+        for (int j=0; j<xdim; j++)
+            record[3+j] = lattice.corr[j];
+        lattice.mod2Pi();
+        record[2] = lattice.computePlaquette();
+        if (lattice.biasConfigs)
+            record[3+xdim] = lattice.biasWeight;
+        fObs.f.write(reinterpret_cast<char*>(record.data()), record.size() * sizeof(double));
+
+        Nconf++;
+    }
+    fConfNpy.finish(Nconf);
+    fObs.finish(Nconf);
+    cout << Nconf << " configurations exported to " << fConfNpy << " and " << fObs << endl;
+
+    // diagnostics of the steps (one text file each) as one structured array
+    if (parameters.exportInfos.empty())
+        return 0;
+
+    vector<TopoOsciSim::FileObs*> infos;
+    vector<int> widths;
+    stringstream names(parameters.exportInfos);
+    string infoName;
+    descr = "[";
+    while (getline(names, infoName, ','))
+    {
+        infos.push_back(new TopoOsciSim::FileObs(infoName, parameters));
+        infos.back()->open();
+
+        // width from first line
+        string line;
+        streampos start = infos.back()->f.tellg();
+        getline(infos.back()->f, line);
+        infos.back()->f.seekg(start);
+        stringstream lineStream(line);
+        int width = 0;
+        double value;
+        while (lineStream >> value)
+            width++;
+        if (width == 0)
+        {
+            cerr << "ERROR: File " << infos.back()->name.fullName << " has no values" << endl;
+            exit(0);
+        }
+        widths.push_back(width);
+        descr += ((infos.size() > 1) ? ", " : "") + TopoOsciSim::FileNpy::getField(infoName, "<f8", width);
+    }
+    descr += "]";
+
+    TopoOsciSim::FileNpy fInfos("Infos", parameters.outputDirectory, parameters);
+    fInfos.create(descr, {});
+
+    // rows up to the end of the shortest file
+    int rowWidth = 0;
+    for (unsigned int c=0; c<widths.size(); c++)
+        rowWidth += widths[c];
+    vector<double> row(rowWidth);
+    long Nrows = 0;
+    while (true)
+    {
+        int k = 0;
+        for (unsigned int c=0; c<infos.size(); c++)
+            for (int w=0; w<widths[c]; w++)
+                if (infos[c]->f >> row[k])
+                    k++;
+        if (k < rowWidth)
+            break;
+        fInfos.f.write(reinterpret_cast<char*>(row.data()), rowWidth * sizeof(double));
+        Nrows++;
+    }
+    fInfos.finish(Nrows);
+    cout << Nrows << " steps of " << parameters.exportInfos << " exported to " << fInfos << endl;
+
+    // end of file is expected
+    for (unsigned int c=0; c<infos.size(); c++)
+    {
+        infos[c]->f.clear();
+        delete infos[c];
+    }
+}
@@ -0,0 +1,354 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include "expression.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Values on the stack of evaluate
+    static const int maxDepth = 64;
+
+    // Parse name=expression (spaces are ignored)
+    Expression::Expression(const string& def, const ParameterContainer& p) :
+        definition {def},
+        root       {-1},
+        position   {0},
+        insideMean {false},
+        xdim       {(double)p.xdim},
+        a          {p.a},
+        I          {p.I}
+    {
+        size_t equal = definition.find('=');
+        if ((equal == string::npos) || (equal == 0))
+            fail("missing name=");
+        name = definition.substr(0, equal);
+
+        for (unsigned int k=equal+1; k<definition.size(); k++)
+            if (!isspace(definition[k]))
+                text.push_back(definition[k]);
+
+        root = parseSum();
+        if (position < text.size())
+            fail(string("unexpected ") + text[position]);
+    }
+
+    bool Expression::dependsOnT() const
+    {
+        return dependsOnT(root);
+    }
+
+    // Number of values on the stack of program
+    static int getDepth(const vector<Instruction>& program)
+    {
+        int depth = 0, maximum = 0;
+        for (unsigned int k=0; k<program.size(); k++)
+        {
+            Instruction::Op op = program[k].op;
+            if ((op == Instruction::constant) || (op == Instruction::load))
+                depth++;
+            else if ((op >= Instruction::plus) && (op <= Instruction::power))
+                depth--;
+            maximum = max(maximum, depth);
+        }
+        return maximum;
+    }
+
+    // Program of means, means and streams are shared between quantities
+    vector<Instruction> Expression::compile(int t, vector<vector<Instruction> >& means, vector<StreamReference>& streams) const
+    {
+        vector<Instruction> program;
+        compileNode(root, t, program, means, streams);
+        if (getDepth(program) > maxDepth)
+            fail("too deeply nested");
+        return program;
+    }
+
+    // Run postfix program
+    double Expression::evaluate(const vector<Instruction>& program, const double* inputs)
+    {
+        double stack[maxDepth];
+        int top = -1;
+        for (unsigned int k=0; k<program.size(); k++)
+        {
+            const Instruction& in = program[k];
+            switch (in.op)
+            {
+            case Instruction::constant:    stack[++top] = in.value; break;
+            case Instruction::load:        stack[++top] = inputs[in.input]; break;
+            case Instruction::negate:      stack[top] = -stack[top]; break;
+            case Instruction::plus:        top--; stack[top] += stack[top+1]; break;
+            case Instruction::minus:       top--; stack[top] -= stack[top+1]; break;
+            case Instruction::times:       top--; stack[top] *= stack[top+1]; break;
+            case Instruction::divide:      top--; stack[top] /= stack[top+1]; break;
+            case Instruction::power:       top--; stack[top] = pow(stack[top], stack[top+1]); break;
+            case Instruction::sine:        stack[top] = sin(stack[top]); break;
+            case Instruction::cosine:      stack[top] = cos(stack[top]); break;
+            case Instruction::exponential: stack[top] = exp(stack[top]); break;
+            case Instruction::logarithm:   stack[top] = log(stack[top]); break;
+            case Instruction::squareRoot:  stack[top] = sqrt(stack[top]); break;
+            case Instruction::absolute:    stack[top] = fabs(stack[top]); break;
+            }
+        }
+        return stack[0];
+    }
+
+    // sum := product (('+' | '-') product)*
+    int Expression::parseSum()
+    {
+        int node = parseProduct();
+        while (true)
+        {
+            if (accept('+'))
+                node = addNode(Node::binary, 0., "", Instruction::plus, node, parseProduct());
+            else if (accept('-'))
+                node = addNode(Node::binary, 0., "", Instruction::minus, node, parseProduct());
+            else
+                return node;
+        }
+    }
+
+    // product := unary (('*' | '/') unary)*
+    int Expression::parseProduct()
+    {
+        int node = parseUnary();
+        while (true)
+        {
+            if (accept('*'))
+                node = addNode(Node::binary, 0., "", Instruction::times, node, parseUnary());
+            else if (accept('/'))
+                node = addNode(Node::binary, 0., "", Instruction::divide, node, parseUnary());
+            else
+                return node;
+        }
+    }
+
+    // unary := ('-' | '+') unary | power
+    int Expression::parseUnary()
+    {
+        if (accept('-'))
+            return addNode(Node::unary, 0., "", Instruction::negate, parseUnary(), -1);
+        if (accept('+'))
+            return parseUnary();
+        return parsePower();
+    }
+
+    // power := primary ('^' unary)?, -Q^2 is -(Q^2)
+    int Expression::parsePower()
+    {
+        int node = parsePrimary();
+        if (accept('^'))
+            node = addNode(Node::binary, 0., "", Instruction::power, node, parseUnary());
+        return node;
+    }
+
+    // primary := number | (sum) | <sum> | function(sum) | constant | t | stream([sum])?
+    int Expression::parsePrimary()
+    {
+        if (accept('('))
+        {
+            int node = parseSum();
+            expect(')');
+            return node;
+        }
+
+        if (accept('<'))
+        {
+            if (insideMean)
+                fail("nested means");
+            insideMean = true;
+            int node = parseSum();
+            expect('>');
+            insideMean = false;
+            return addNode(Node::mean, 0., "", Instruction::constant, node, -1);
+        }
+
+        if (position >= text.size())
+            fail("unexpected end");
+
+        if (isdigit(text[position]) || (text[position] == '.'))
+        {
+            const char* start = text.c_str() + position;
+            char* end;
+            double value = strtod(start, &end);
+            position += end - start;
+            return addNode(Node::number, value, "", Instruction::constant, -1, -1);
+        }
+
+        if (!isalpha(text[position]) && (text[position] != '_'))
+            fail(string("unexpected ") + text[position]);
+
+        string identifier;
+        while ((position < text.size()) && (isalnum(text[position]) || (text[position] == '_')))
+            identifier.push_back(text[position++]);
+
+        // functions
+        const char* functions[] = {"sin", "cos", "exp", "log", "sqrt", "abs"};
+        const Instruction::Op ops[] = {Instruction::sine, Instruction::cosine, Instruction::exponential,
+                                       Instruction::logarithm, Instruction::squareRoot, Instruction::absolute};
+        for (int f=0; f<6; f++)
+            if (identifier == functions[f])
+            {
+                expect('(');
+                int node = parseSum();
+                expect(')');
+                return addNode(Node::function, 0., identifier, ops[f], node, -1);
+            }
+
+        // constants of the run
+        if (identifier == "xdim")
+            return addNode(Node::number, xdim, "", Instruction::constant, -1, -1);
+        if (identifier == "a")
+            return addNode(Node::number, a, "", Instruction::constant, -1, -1);
+        if (identifier == "I")
+            return addNode(Node::number, I, "", Instruction::constant, -1, -1);
+        if (identifier == "pi")
+            return addNode(Node::number, M_PI, "", Instruction::constant, -1, -1);
+        if (identifier == "t")
+            return addNode(Node::variable, 0., identifier, Instruction::constant, -1, -1);
+
+        // observable of each configuration with optional column
+        if (!insideMean)
+            fail("observable " + identifier + " outside of <...>");
+        int index = -1;
+        if (accept('['))
+        {
+            insideMean = false;
+            index = parseSum();
+            insideMean = true;
+            expect(']');
+        }
+        return addNode(Node::stream, 0., identifier, Instruction::load, index, -1);
+    }
+
+    int Expression::addNode(Node::Type type, double value, const string& nodeName, Instruction::Op op, int left, int right)
+    {
+        nodes.push_back(Node(type, value, nodeName, op, left, right));
+        return nodes.size() - 1;
+    }
+
+    bool Expression::accept(char c)
+    {
+        if ((position < text.size()) && (text[position] == c))
+        {
+            position++;
+            return true;
+        }
+        return false;
+    }
+
+    void Expression::expect(char c)
+    {
+        if (!accept(c))
+            fail(string("missing ") + c);
+    }
+
+    void Expression::fail(const string& message) const
+    {
+        cerr << "ERROR: " << message << " in derived quantity " << definition << endl;
+        exit(0);
+    }
+
+    bool Expression::dependsOnT(int node) const
+    {
+        if (node < 0)
+            return false;
+        if (nodes[node].type == Node::variable)
+            return true;
+        return (dependsOnT(nodes[node].left) || dependsOnT(nodes[node].right));
+    }
+
+    // Value of index of a stream (numbers and t only)
+    double Expression::evaluateIndex(int node, int t) const
+    {
+        const Node& n = nodes[node];
+        switch (n.type)
+        {
+        case Node::number:
+            return n.value;
+        case Node::variable:
+            return t;
+        case Node::unary:
+            return -evaluateIndex(n.left, t);
+        case Node::binary:
+        {
+            vector<Instruction> program = {Instruction(Instruction::constant, evaluateIndex(n.left, t), 0),
+                                           Instruction(Instruction::constant, evaluateIndex(n.right, t), 0),
+                                           Instruction(n.op, 0., 0)};
+            return evaluate(program, NULL);
+        }
+        case Node::function:
+        {
+            vector<Instruction> program = {Instruction(Instruction::constant, evaluateIndex(n.left, t), 0),
+                                           Instruction(n.op, 0., 0)};
+            return evaluate(program, NULL);
+        }
+        default:
+            fail("observable in index");
+        }
+        return 0.;
+    }
+
+    void Expression::compileNode(int node, int t, vector<Instruction>& program, vector<vector<Instruction> >& means, vector<StreamReference>& streams) const
+    {
+        const Node& n = nodes[node];
+        switch (n.type)
+        {
+        case Node::number:
+            program.push_back(Instruction(Instruction::constant, n.value, 0));
+            break;
+
+        case Node::variable:
+            program.push_back(Instruction(Instruction::constant, t, 0));
+            break;
+
+        case Node::stream:
+        {
+            StreamReference stream {n.name, 0};
+            if (n.left >= 0)
+                stream.column = lround(evaluateIndex(n.left, t));
+            if (stream.column < 0)
+                fail("negative index of " + n.name);
+
+            unsigned int k = 0;
+            while ((k < streams.size()) && !(streams[k] == stream))
+                k++;
+            if (k == streams.size())
+                streams.push_back(stream);
+            program.push_back(Instruction(Instruction::load, 0., k));
+            break;
+        }
+
+        case Node::mean:
+        {
+            vector<Instruction> inner;
+            compileNode(n.left, t, inner, means, streams);
+            if (getDepth(inner) > maxDepth)
+                fail("too deeply nested");
+
+            unsigned int k = 0;
+            while ((k < means.size()) && !(means[k] == inner))
+                k++;
+            if (k == means.size())
+                means.push_back(inner);
+            program.push_back(Instruction(Instruction::load, 0., k));
+            break;
+        }
+
+        case Node::binary:
+            compileNode(n.left, t, program, means, streams);
+            compileNode(n.right, t, program, means, streams);
+            program.push_back(Instruction(n.op, 0., 0));
+            break;
+
+        default:
+            compileNode(n.left, t, program, means, streams);
+            program.push_back(Instruction(n.op, 0., 0));
+            break;
+        }
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,140 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include "parameters.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Operation of a compiled expression (postfix order)
+    class Instruction
+    {
+    public:
+        enum Op {constant, load, negate, plus, minus, times, divide, power, sine, cosine, exponential, logarithm, squareRoot, absolute};
+
+        Op op;
+
+        // Value of constant, input of load
+        double value;
+        int input;
+
+        Instruction(Op o, double v, int i) : op {o}, value {v}, input {i} {}
+
+        bool operator==(const Instruction& i) const { return (op == i.op) && (value == i.value) && (input == i.input); }
+    };
+
+    // Observable column read by a compiled mean (Name[column])
+    class StreamReference
+    {
+    public:
+        string name;
+        int column;
+
+        bool operator==(const StreamReference& s) const { return (name == s.name) && (column == s.column); }
+    };
+
+
+    /**
+       Derived quantity as arithmetic expression of means over the
+       configurations, e.g. <Q^2>/xdim or log(<Corr[t]>/<Corr[t+1]>).
+       Inside <...> a per-configuration expression of observable
+       streams (Q, S, Plaq, Corr[j], other observable files) is
+       averaged, outside only means, numbers, the constants xdim, a, I
+       and pi and the variable t may appear. Operators + - * / ^, the
+       functions sin, cos, exp, log, sqrt and abs, indices [...] can
+       depend on t. The expression is parsed once and compiled for
+       each t into postfix programs.
+    */
+    class Expression
+    {
+    public:
+
+        // Whole definition and name of quantity (name=expression)
+        string definition;
+        string name;
+
+        /**
+           Parse definition
+
+           @param def Definition name=expression
+           @param p   Parameters (constants)
+        */
+        Expression(const string& def, const ParameterContainer& p);
+
+        // true if the expression depends on t
+        bool dependsOnT() const;
+
+        /**
+           Compile expression of means for t. The per-configuration
+           expression of each mean is appended to means (identical ones
+           are shared), its streams are appended to streams.
+
+           @param t       Value of t
+           @param means   Compiled means (inputs of the program)
+           @param streams Streams (inputs of the means)
+           @return        Program evaluated on the means
+        */
+        vector<Instruction> compile(int t, vector<vector<Instruction> >& means, vector<StreamReference>& streams) const;
+
+        /**
+           Evaluate compiled program
+
+           @param program Program
+           @param inputs  Values of loads
+           @return        Value
+        */
+        static double evaluate(const vector<Instruction>& program, const double* inputs);
+
+    private:
+
+        // Node of syntax tree
+        class Node
+        {
+        public:
+            enum Type {number, variable, stream, mean, unary, binary, function};
+
+            Type type;
+            double value;
+            string name;
+            Instruction::Op op;
+
+            // Children (index node of a stream), -1: none
+            int left;
+            int right;
+
+            Node(Type ty, double v, const string& n, Instruction::Op o, int l, int r) :
+                type {ty}, value {v}, name {n}, op {o}, left {l}, right {r} {}
+        };
+
+        vector<Node> nodes;
+        int root;
+
+        // Parser state
+        string text;
+        unsigned int position;
+        bool insideMean;
+        double xdim, a, I;
+
+        int parseSum();
+        int parseProduct();
+        int parsePower();
+        int parseUnary();
+        int parsePrimary();
+        int addNode(Node::Type type, double value, const string& name, Instruction::Op op, int left, int right);
+        bool accept(char c);
+        void expect(char c);
+        void fail(const string& message) const;
+
+        bool dependsOnT(int node) const;
+        double evaluateIndex(int node, int t) const;
+        void compileNode(int node, int t, vector<Instruction>& program, vector<vector<Instruction> >& means, vector<StreamReference>& streams) const;
+    };
+
+} // TopoOsciSim
+
+#endif // EXPRESSION_H
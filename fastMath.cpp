@@ -0,0 +1,394 @@
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cfloat>
+#include <algorithm>
+#include "fastMath.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Vectors of 2, 4 and 8 doubles and their bit patterns
+    typedef double             D2 __attribute__((vector_size(16)));
+    typedef unsigned long long U2 __attribute__((vector_size(16)));
+    typedef double             D4 __attribute__((vector_size(32)));
+    typedef unsigned long long U4 __attribute__((vector_size(32)));
+    typedef double             D8 __attribute__((vector_size(64)));
+    typedef unsigned long long U8 __attribute__((vector_size(64)));
+
+    // Kernels are inlined into the functions of each instruction set,
+    // so the calling convention of wide vectors does not matter
+    #define FASTMATH_INLINE static inline __attribute__((always_inline))
+    #pragma GCC diagnostic ignored "-Wpsabi"
+
+    // 1.5 * 2^52: x + magic rounds x to an integer, which is in the
+    // low bits of the result
+    const double magic = 6755399441055744.;
+    const unsigned long long magicBits = 0x4338000000000000ULL;
+    const unsigned long long signBit   = 0x8000000000000000ULL;
+
+    // pi/2 in three parts (k * part is exact for |k| < 2^29)
+    const double piHalf1 = 1.57079625129699707031E0;
+    const double piHalf2 = 7.54978941586159635336E-8;
+    const double piHalf3 = 5.39030285815811905290E-15;
+
+    // ln 2 in two parts
+    const double ln2Hi = 6.93145751953125E-1;
+    const double ln2Lo = 1.42860682030941723212E-6;
+
+    // Largest arguments of the vector kernels
+    const double cosMaxArg = 1E8;
+    const double expMinArg = -708.;
+    const double expMaxArg = 709.;
+
+    template<class D, class U>
+    FASTMATH_INLINE D select(const U& mask, const D& a, const D& b)
+    {
+        return (D)(((U)a & mask) | ((U)b & ~mask));
+    }
+
+    // true if any lane of mask is set
+    template<class U>
+    FASTMATH_INLINE bool anyLane(const U& mask)
+    {
+        U zero = mask ^ mask;
+        return memcmp(&mask, &zero, sizeof(U)) != 0;
+    }
+
+    // Load m <= W values, pad with zeros
+    template<int W, class D>
+    FASTMATH_INLINE D load(const double* x, int m)
+    {
+        D v;
+        if (m == W)
+            memcpy(&v, x, sizeof(D));
+        else
+        {
+            memset(&v, 0, sizeof(D));
+            memcpy(&v, x, m * sizeof(double));
+        }
+        return v;
+    }
+
+    // Store first m <= W values
+    template<int W, class D>
+    FASTMATH_INLINE void store(const D& v, double* x, int m)
+    {
+        if (m == W)
+            memcpy(x, &v, sizeof(D));
+        else
+            memcpy(x, &v, m * sizeof(double));
+    }
+
+    // sin and cos of x, outside marks lanes for libm
+    template<class D, class U, bool Full>
+    FASTMATH_INLINE void sincosKernel(const D& xIn, D& s, D& c, U& outside)
+    {
+        D absX = (D)((U)xIn & ~signBit);
+        outside = ~(U)(absX <= cosMaxArg);
+        D x = (D)((U)xIn & ~outside);
+
+        // x = k pi/2 + r with |r| <= pi/4
+        D t = x * M_2_PI + magic;
+        D k = t - magic;
+        U quadrant = (U)t - magicBits;
+        D r = ((x - k * piHalf1) - k * piHalf2) - k * piHalf3;
+        D z = r * r;
+
+        D ps, pc;
+        if (Full)
+        {
+            // minimax polynomials of Cephes
+            ps = ((((( 1.58962301576546568060E-10 * z
+                      - 2.50507477628578072866E-8) * z
+                      + 2.75573136213857245213E-6) * z
+                      - 1.98412698295895385996E-4) * z
+                      + 8.33333333332211858878E-3) * z
+                      - 1.66666666666666307295E-1);
+            pc = (((((-1.13585365213876817300E-11 * z
+                      + 2.08757008419747316778E-9) * z
+                      - 2.75573141792967388112E-7) * z
+                      + 2.48015872888517045348E-5) * z
+                      - 1.38888888888730564116E-3) * z
+                      + 4.16666666666665929218E-2);
+        }
+        else
+        {
+            // Taylor polynomials, error below 3E-8
+            ps = ((  2.75573192239858906526E-6 * z
+                   - 1.98412698412698412698E-4) * z
+                   + 8.33333333333333333333E-3) * z
+                   - 1.66666666666666666667E-1;
+            pc = ((  2.48015873015873015873E-5 * z
+                   - 1.38888888888888888889E-3) * z
+                   + 4.16666666666666666667E-2);
+        }
+        D sinR = r + r * z * ps;
+        D cosR = 1. - 0.5 * z + z * z * pc;
+
+        // quadrant 1 and 3 swap sin and cos, signs follow the quadrant
+        U swap = -(quadrant & 1);
+        s = (D)((U)select(swap, cosR, sinR) ^ ((quadrant & 2) << 62));
+        c = (D)((U)select(swap, sinR, cosR) ^ (((quadrant + 1) & 2) << 62));
+    }
+
+    // exp of x, outside marks lanes for libm
+    template<class D, class U, bool Full>
+    FASTMATH_INLINE D expKernel(const D& xIn, U& outside)
+    {
+        // one comparison: |x - mid| <= halfwidth of [expMinArg, expMaxArg]
+        D distance = (D)((U)(xIn - 0.5 * (expMinArg + expMaxArg)) & ~signBit);
+        outside = ~(U)(distance <= 0.5 * (expMaxArg - expMinArg));
+        D x = (D)((U)xIn & ~outside);
+
+        // x = k ln2 + r with |r| <= ln2/2
+        D t = x * M_LOG2E + magic;
+        D k = t - magic;
+        U kBits = (U)t - magicBits;
+        D r = (x - k * ln2Hi) - k * ln2Lo;
+
+        D p;
+        if (Full)
+        {
+            // Taylor polynomial up to r^13
+            p = ((((((((((((  1.60590438368216145994E-10 * r
+                            + 2.08767569878680989792E-9) * r
+                            + 2.50521083854417187751E-8) * r
+                            + 2.75573192239858906526E-7) * r
+                            + 2.75573192239858906526E-6) * r
+                            + 2.48015873015873015873E-5) * r
+                            + 1.98412698412698412698E-4) * r
+                            + 1.38888888888888888889E-3) * r
+                            + 8.33333333333333333333E-3) * r
+                            + 4.16666666666666666667E-2) * r
+                            + 1.66666666666666666667E-1) * r
+                            + 0.5) * r
+                            + 1.) * r
+                            + 1.;
+        }
+        else
+        {
+            // Taylor polynomial up to r^7, error below 6E-9
+            p = ((((((  1.98412698412698412698E-4 * r
+                      + 1.38888888888888888889E-3) * r
+                      + 8.33333333333333333333E-3) * r
+                      + 4.16666666666666666667E-2) * r
+                      + 1.66666666666666666667E-1) * r
+                      + 0.5) * r
+                      + 1.) * r
+                      + 1.;
+        }
+
+        // multiply with 2^k
+        return p * (D)((kBits + 1023) << 52);
+    }
+
+    // Apply kernels to blocks of W values, the last block is padded
+    template<int W, class D, class U, bool Full>
+    FASTMATH_INLINE void sincosLoop(const double* x, double* s, double* c, int n)
+    {
+        D v, sinV, cosV;
+        U outside;
+        for (int i=0; i<n; i+=W)
+        {
+            int m = (n - i < W) ? n - i : W;
+            v = load<W, D>(x + i, m);
+            sincosKernel<D, U, Full>(v, sinV, cosV, outside);
+            if (anyLane(outside))
+                for (int l=0; l<m; l++)
+                    if (outside[l])
+                    {
+                        sinV[l] = std::sin(v[l]);
+                        cosV[l] = std::cos(v[l]);
+                    }
+            if (s)
+                store<W, D>(sinV, s + i, m);
+            if (c)
+                store<W, D>(cosV, c + i, m);
+        }
+    }
+
+    template<int W, class D, class U, bool Full>
+    FASTMATH_INLINE void expLoop(const double* x, double* y, int n)
+    {
+        D v, expV;
+        U outside;
+        for (int i=0; i<n; i+=W)
+        {
+            int m = (n - i < W) ? n - i : W;
+            v = load<W, D>(x + i, m);
+            expV = expKernel<D, U, Full>(v, outside);
+            if (anyLane(outside))
+                for (int l=0; l<m; l++)
+                    if (outside[l])
+                        expV[l] = std::exp(v[l]);
+            store<W, D>(expV, y + i, m);
+        }
+    }
+
+    // cos, sincos and exp compiled for one instruction set
+    #define FASTMATH_KERNELS(NAME, TARGET, W, D, U)                       \
+        TARGET static void cos##NAME(const double* x, double* y, int n, bool full) \
+        {                                                                   \
+            if (full)                                                       \
+                sincosLoop<W, D, U, true>(x, NULL, y, n);                   \
+            else                                                            \
+                sincosLoop<W, D, U, false>(x, NULL, y, n);                  \
+        }                                                                   \
+        TARGET static void sincos##NAME(const double* x, double* s, double* c, int n, bool full) \
+        {                                                                   \
+            if (full)                                                       \
+                sincosLoop<W, D, U, true>(x, s, c, n);                      \
+            else                                                            \
+                sincosLoop<W, D, U, false>(x, s, c, n);                     \
+        }                                                                   \
+        TARGET static void exp##NAME(const double* x, double* y, int n, bool full) \
+        {                                                                   \
+            if (full)                                                       \
+                expLoop<W, D, U, true>(x, y, n);                            \
+            else                                                            \
+                expLoop<W, D, U, false>(x, y, n);                           \
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+    FASTMATH_KERNELS(Avx512, __attribute__((target("avx512f,avx512dq"))), 8, D8, U8)
+    FASTMATH_KERNELS(Avx2, __attribute__((target("avx2,fma"))), 4, D4, U4)
+    FASTMATH_KERNELS(Sse2, __attribute__((target("sse2"))), 2, D2, U2)
+#else
+    FASTMATH_KERNELS(Generic, , 2, D2, U2)
+#endif
+
+    // Functions of one instruction set
+    struct FastMathKernels
+    {
+        const char* name;
+        void (*cos)(const double*, double*, int, bool);
+        void (*sincos)(const double*, double*, double*, int, bool);
+        void (*exp)(const double*, double*, int, bool);
+    };
+
+    // Supported instruction sets, best first
+    static vector<const FastMathKernels*> getSupportedKernels()
+    {
+        vector<const FastMathKernels*> supported;
+#if defined(__x86_64__) || defined(__i386__)
+        static const FastMathKernels avx512 = {"avx512", cosAvx512, sincosAvx512, expAvx512};
+        static const FastMathKernels avx2   = {"avx2",   cosAvx2,   sincosAvx2,   expAvx2};
+        static const FastMathKernels sse2   = {"sse2",   cosSse2,   sincosSse2,   expSse2};
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+            supported.push_back(&avx512);
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            supported.push_back(&avx2);
+        supported.push_back(&sse2);
+#else
+        static const FastMathKernels generic = {"generic", cosGeneric, sincosGeneric, expGeneric};
+        supported.push_back(&generic);
+#endif
+        return supported;
+    }
+
+    // Instruction set chosen by setInstructionSet (NULL: best)
+    static const FastMathKernels* selectedKernels = NULL;
+
+    static const FastMathKernels* getKernels()
+    {
+        static const FastMathKernels* best = getSupportedKernels()[0];
+        return selectedKernels ? selectedKernels : best;
+    }
+
+    FastMath::Accuracy FastMath::getAccuracy(const string& name)
+    {
+        if (name == "off")
+            return libm;
+        if (name == "double")
+            return full;
+        if (name == "float")
+            return reduced;
+        cerr << "ERROR: Unknown fastMath " << name << endl;
+        exit(0);
+    }
+
+    vector<string> FastMath::getInstructionSets()
+    {
+        vector<const FastMathKernels*> supported = getSupportedKernels();
+        vector<string> names;
+        for (unsigned int i=0; i<supported.size(); i++)
+            names.push_back(supported[i]->name);
+        return names;
+    }
+
+    string FastMath::getInstructionSet()
+    {
+        return getKernels()->name;
+    }
+
+    void FastMath::setInstructionSet(const string& name)
+    {
+        vector<const FastMathKernels*> supported = getSupportedKernels();
+        for (unsigned int i=0; i<supported.size(); i++)
+            if (name == supported[i]->name)
+            {
+                selectedKernels = supported[i];
+                return;
+            }
+        cerr << "ERROR: Instruction set " << name << " is not supported" << endl;
+        exit(0);
+    }
+
+    void FastMath::cos(const double* x, double* y, int n, Accuracy accuracy)
+    {
+        if (accuracy == libm)
+            for (int i=0; i<n; i++)
+                y[i] = std::cos(x[i]);
+        else
+            getKernels()->cos(x, y, n, accuracy == full);
+    }
+
+    void FastMath::sincos(const double* x, double* s, double* c, int n, Accuracy accuracy)
+    {
+        if (accuracy == libm)
+            for (int i=0; i<n; i++)
+            {
+                s[i] = std::sin(x[i]);
+                c[i] = std::cos(x[i]);
+            }
+        else
+            getKernels()->sincos(x, s, c, n, accuracy == full);
+    }
+
+    void FastMath::exp(const double* x, double* y, int n, Accuracy accuracy)
+    {
+        if (accuracy == libm)
+            for (int i=0; i<n; i++)
+                y[i] = std::exp(x[i]);
+        else
+            getKernels()->exp(x, y, n, accuracy == full);
+    }
+
+    double FastMath::getMaxError(Accuracy accuracy)
+    {
+        return (accuracy == reduced) ? 1E-7 : 4 * DBL_EPSILON;
+    }
+
+    // Largest errors against libm
+    void FastMath::getErrors(const double* xCos, const double* xExp, int n, Accuracy accuracy,
+                             double& errorCos, double& errorExp)
+    {
+        vector<double> s(n), c(n), y(n);
+        sincos(xCos, s.data(), c.data(), n, accuracy);
+        exp(xExp, y.data(), n, accuracy);
+
+        errorCos = 0.;
+        errorExp = 0.;
+        for (int i=0; i<n; i++)
+        {
+            errorCos = max(errorCos, max(fabs(s[i] - std::sin(xCos[i])), fabs(c[i] - std::cos(xCos[i]))));
+            errorExp = max(errorExp, fabs(y[i] / std::exp(xExp[i]) - 1.));
+        }
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,107 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Vectorized cos, sincos and exp on arrays of doubles. The
+       instruction set (AVX-512, AVX2 or SSE2) is chosen at runtime
+       from the cpu, all of them give the same results up to rounding.
+       Arguments outside the reduced range (|x| > 1E8 for cos and
+       sincos, x outside [-708, 709] for exp, nan and inf) are passed
+       to libm.
+    */
+    class FastMath
+    {
+
+    public:
+
+        // libm: scalar libm calls, full: error of a few ulp,
+        // reduced: relative error below 1E-7 (shorter polynomials)
+        enum Accuracy { libm, full, reduced };
+
+        /**
+           Return accuracy of parameter fastMath
+
+           @param name off, double or float
+           @return     Accuracy
+        */
+        static Accuracy getAccuracy(const string& name);
+
+        // Instruction sets supported by cpu and build, best first
+        static vector<string> getInstructionSets();
+
+        // Instruction set used by cos, sincos and exp
+        static string getInstructionSet();
+
+        /**
+           Use other instruction set (for benchmarks, not thread-safe)
+
+           @param name Name of getInstructionSets
+        */
+        static void setInstructionSet(const string& name);
+
+        /**
+           y[i] = cos(x[i]) for i < n
+
+           @param x        Arguments
+           @param y        Results (can be x)
+           @param n        Number of values
+           @param accuracy Accuracy of results
+        */
+        static void cos(const double* x, double* y, int n, Accuracy accuracy);
+
+        /**
+           s[i] = sin(x[i]), c[i] = cos(x[i]) for i < n
+
+           @param x        Arguments
+           @param s        Sines
+           @param c        Cosines
+           @param n        Number of values
+           @param accuracy Accuracy of results
+        */
+        static void sincos(const double* x, double* s, double* c, int n, Accuracy accuracy);
+
+        /**
+           y[i] = exp(x[i]) for i < n
+
+           @param x        Arguments
+           @param y        Results (can be x)
+           @param n        Number of values
+           @param accuracy Accuracy of results
+        */
+        static void exp(const double* x, double* y, int n, Accuracy accuracy);
+
+        /**
+           Return bound of the error against libm (absolute for cos and
+           sin, relative for exp)
+
+           @param accuracy full or reduced
+           @return         4 DBL_EPSILON (full) or 1E-7 (reduced)
+        */
+        static double getMaxError(Accuracy accuracy);
+
+        /**
+           Compute largest errors of the active instruction set against
+           libm (absolute for sin and cos, relative for exp)
+
+           @param xCos     Arguments of sincos
+           @param xExp     Arguments of exp
+           @param n        Number of values of each
+           @param accuracy Accuracy of results
+           @param errorCos Error of sincos
+           @param errorExp Error of exp
+        */
+        static void getErrors(const double* xCos, const double* xExp, int n, Accuracy accuracy,
+                              double& errorCos, double& errorExp);
+    };
+
+} // TopoOsciSim
+
+#endif // FASTMATH_H
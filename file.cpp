@@ -4,7 +4,10 @@
 #include <fstream>
 #include <sys/stat.h>
 #include <cmath>
+#include <cstdint>
+#include <iomanip>
 #include "file.hpp"
+#include "catalog.hpp"
 
 using namespace std;
 
@@ -36,6 +39,8 @@ namespace TopoOsciSim
         
         addToExtension("a", p.a);
         addToExtension("xdim", p.xdim);
+        if (p.dim > 1)
+            addToExtension("dim", p.dim);
         
         if (p.equilibrationAlgorithm == "metropolis")
         {
@@ -46,6 +51,22 @@ namespace TopoOsciSim
         {
             addToExtension("Cluster");
         }
+        else if (p.equilibrationAlgorithm == "symmetrization")
+        {
+            addToExtension("Sym");
+            addToExtension("NPermSets", p.NPermutationSets);
+        }
+
+        // float configurations are separate runs
+        if (p.precision != "double")
+            addToExtension(p.precision);
+
+        if (p.boundary == "open")
+            addToExtension("open");
+
+        // biased configurations carry their bias
+        if (p.metaHeight > 0.)
+            addToExtension("metaH", p.metaHeight);
 
         if (filetype != "Conf")
             if (p.Nsym >= 0)
@@ -105,18 +126,11 @@ namespace TopoOsciSim
         extension.addToExtension("id", index);        
     }
 
+    // Allocate id in catalog of directory (no probing of all ids)
     void FileName::getNextFreeIndex ()
     {
-        string dummyName;
-        int i = 0;
-        
-        dummyName = fullName + "_id" + to_string(i);
-        while (exist(dummyName))
-        {
-            i++;
-            dummyName = fullName + "_id" + to_string(i);
-        }
-        index = i;
+        RunCatalog catalog(directory);
+        index = catalog.allocateId(type + extension.fullExtension, directory + type + extension.fullExtension);
     }
 
     bool FileName::exist(string filenameTest)
@@ -202,6 +216,17 @@ namespace TopoOsciSim
         }
     }
     
+    // Open existing file for writing at its end
+    void FileObs::append	()
+    {
+        f.open(name.fullName, ios::out | ios::app);
+        if(!f.is_open())
+        {
+            cerr << "ERROR: File " << name.fullName << " cannot be opened for appending" << endl;
+            exit(0);
+        }
+    }
+    
     void FileObs::printValueToFile(double value)
     {
         f << value << endl;
@@ -212,6 +237,11 @@ namespace TopoOsciSim
         f << value << endl;
     }
 
+    void FileObs::printValueToFile(complex<double> value)
+    {
+        f << real(value) << "\t" << imag(value) << endl;
+    }
+
     void FileObs::printIndexAndValueToFile(int index, double value)
     {
         f << index << "\t" << value << endl;
@@ -256,5 +286,84 @@ namespace TopoOsciSim
             exit(0);
         }
     }
+
+    // Open existing file for writing at its end
+    void FileConfig::append	()
+    {
+        f.open(name.fullName, ios::out | ios::app | ios::binary);
+        if(!f.is_open())
+        {
+            cerr << "ERROR: File " << name.fullName << " cannot be opened for appending" << endl;
+            exit(0);
+        }
+    }
+
+
+    //----- FileNpy ----------
+    FileNpy::FileNpy(const string filetype, const string directory, const ParameterContainer& p) :
+        File(filetype, directory, p)
+    {
+        name.fullName += ".npy";
+    }
+
+    // Create file
+    void FileNpy::create (const string& descrIn, const vector<int>& rowShapeIn)
+    {
+        // descriptors are little endian, raw rows are written
+        uint16_t one = 1;
+        if (*reinterpret_cast<char*>(&one) != 1)
+        {
+            cerr << "ERROR: NumPy export needs a little endian machine" << endl;
+            exit(0);
+        }
+
+        descr = descrIn;
+        rowShape = rowShapeIn;
+        f.open(name.fullName, ios::out | ios::binary);
+        if(!f.is_open())
+        {
+            cerr << "ERROR: File creation of " << name.fullName << " does not work" << endl;
+            exit(0);
+        }
+        writeHeader(0);
+    }
+
+    // Overwrite header with number of rows
+    void FileNpy::finish (long Nrows)
+    {
+        f.seekp(0);
+        writeHeader(Nrows);
+        f.close();
+    }
+
+    // Magic string, version 1.0, length and dictionary padded to 64 bytes
+    void FileNpy::writeHeader(long Nrows)
+    {
+        // fixed width of row number, the header keeps its length
+        stringstream dict;
+        dict << "{'descr': " << descr << ", 'fortran_order': False, 'shape': (" << setw(20) << Nrows << ",";
+        for (unsigned int k=0; k<rowShape.size(); k++)
+            dict << (k ? ", " : " ") << rowShape[k];
+        dict << "), }";
+
+        string header = dict.str();
+        int length = 10 + header.size() + 1;
+        header.append((64 - length % 64) % 64, ' ');
+        header.push_back('\n');
+
+        uint16_t headerLength = header.size();
+        f.write("\x93NUMPY\x01\x00", 8);
+        f.write(reinterpret_cast<char*>(&headerLength), sizeof(headerLength));
+        f.write(header.data(), header.size());
+        checkStream();
+    }
+
+    string FileNpy::getField(const string& fieldName, const string& type, int width)
+    {
+        string field = "('" + fieldName + "', '" + type + "'";
+        if (width > 1)
+            field += ", (" + to_string(width) + ",)";
+        return field + ")";
+    }
     
 } // namespace
@@ -4,6 +4,8 @@
 #include <iostream>
 #include <cstdio>
 #include <fstream>
+#include <complex>
+#include <vector>
 #include "parameters.hpp"
 
 using namespace std;
@@ -66,8 +68,10 @@ namespace TopoOsciSim
         FileObs(const string filetype, const ParameterContainer& p);
         void create ();
         void open ();
+        void append ();
         void printValueToFile(double value);
         void printValueToFile(int value);
+        void printValueToFile(complex<double> value);
         void printIndexAndValueToFile(int index, double value);
         void printIndexAndStringToFile(int index, string value);
         void includeSeperationBetweenMeasurements();
@@ -80,6 +84,59 @@ namespace TopoOsciSim
         FileConfig(const ParameterContainer& p);
         void create ();
         void open ();
+        void append ();
+    };
+
+    /**
+       NumPy file (.npy version 1.0, little endian, C order) that can
+       be memory-mapped with numpy.load(name, mmap_mode='r'). Rows are
+       written to f after the header, their number is unknown before
+       and is written into the fixed-width shape field of the header
+       by finish. The header is padded to 64 bytes, so the data are
+       aligned.
+    */
+    class FileNpy : public File
+    {
+    public:
+        /**
+           Name of file type and id of run with extension .npy
+
+           @param filetype  Type of file
+           @param directory Directory of file
+           @param p         Parameters
+        */
+        FileNpy(const string filetype, const string directory, const ParameterContainer& p);
+
+        /**
+           Create file and write header with zero rows
+
+           @param descr    Type of a row, e.g. '<f8' or list of fields
+           @param rowShape Shape of a row (empty: scalar or structure)
+        */
+        void create (const string& descr, const vector<int>& rowShape);
+
+        /**
+           Write number of rows into header and close file
+
+           @param Nrows Number of rows written
+        */
+        void finish (long Nrows);
+
+        /**
+           Return field of structured type
+
+           @param fieldName Name of field
+           @param type      Type of field, e.g. <f8
+           @param width     Number of values (1: scalar)
+           @return          Field as in numpy dtype descr
+        */
+        static string getField(const string& fieldName, const string& type, int width);
+
+    private:
+        string descr;
+        vector<int> rowShape;
+
+        void writeHeader(long Nrows);
     };
 
 } // namespace
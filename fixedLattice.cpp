@@ -0,0 +1,82 @@
+#include <iostream>
+#include "fixedLattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Go through all specialized sizes until N == xdim
+    template<int N>
+    struct FixedDispatch
+    {
+        static double getAction(LatticeContainer& l)
+        {
+            if (l.xdim != N)
+                return FixedDispatch<N+1>::getAction(l);
+
+            typename FixedLatticeKernels<N>::State phi;
+            FixedLatticeKernels<N>::load(l, phi);
+            return FixedLatticeKernels<N>::getAction(phi, l.I/l.a);
+        }
+
+        static void computeQ(LatticeContainer& l)
+        {
+            if (l.xdim != N)
+                return FixedDispatch<N+1>::computeQ(l);
+
+            typename FixedLatticeKernels<N>::State phi;
+            FixedLatticeKernels<N>::load(l, phi);
+            l.q = FixedLatticeKernels<N>::computeQ(phi);
+        }
+
+        static void computeCorr(LatticeContainer& l)
+        {
+            if (l.xdim != N)
+                return FixedDispatch<N+1>::computeCorr(l);
+
+            typename FixedLatticeKernels<N>::State phi, corr;
+            FixedLatticeKernels<N>::load(l, phi);
+            FixedLatticeKernels<N>::computeCorr(phi, corr);
+            for (int i=0; i<N; i++)
+                l.corr[i] = corr[i];
+        }
+    };
+
+    // no specialization found: generic path
+    template<>
+    struct FixedDispatch<fixedXdimMax+1>
+    {
+        static double getAction(LatticeContainer& l) { return l.getAction(); }
+        static void computeQ(LatticeContainer& l) { l.computeQ(); }
+        static void computeCorr(LatticeContainer& l) { l.computeCorr(); }
+    };
+
+
+    bool LatticeKernelDispatcher::isSpecialized(int xdim)
+    {
+        return ((xdim >= fixedXdimMin) && (xdim <= fixedXdimMax));
+    }
+
+    double LatticeKernelDispatcher::getAction(LatticeContainer& l)
+    {
+        if ((l.boundary != 'p') || !isSpecialized(l.xdim))
+            return l.getAction();
+        return FixedDispatch<fixedXdimMin>::getAction(l);
+    }
+
+    void LatticeKernelDispatcher::computeQ(LatticeContainer& l)
+    {
+        if ((l.boundary != 'p') || !isSpecialized(l.xdim))
+            return l.computeQ();
+        FixedDispatch<fixedXdimMin>::computeQ(l);
+    }
+
+    void LatticeKernelDispatcher::computeCorr(LatticeContainer& l)
+    {
+        if ((l.boundary != 'p') || !isSpecialized(l.xdim))
+            return l.computeCorr();
+        FixedDispatch<fixedXdimMin>::computeCorr(l);
+    }
+
+} // TopoOsciSim
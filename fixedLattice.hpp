@@ -0,0 +1,209 @@
+#ifndef FIXEDLATTICE_H
+#define FIXEDLATTICE_H
+
+#include <random>
+#include <cmath>
+#include <array>
+#include "lattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Smallest and largest xdim with specialized kernels
+    const int fixedXdimMin = 4;
+    const int fixedXdimMax = 16;
+
+    // Unrolled loops over site I of a ring with N sites, all neighbour
+    // indices are known at compile time
+    template<int N, int I>
+    struct FixedActionSum
+    {
+        static double sum(const array<double, N>& phi)
+        {
+            return (1. - cos(phi[(I+1) % N] - phi[I])) + FixedActionSum<N, I+1>::sum(phi);
+        }
+    };
+
+    template<int N>
+    struct FixedActionSum<N, N>
+    {
+        static double sum(const array<double, N>& phi) { return 0.; }
+    };
+
+    template<int N, int I>
+    struct FixedChargeSum
+    {
+        static double sum(const array<double, N>& phi)
+        {
+            return LatticeContainer::getWrappedDifference(phi[(I+1) % N] - phi[I]) + FixedChargeSum<N, I+1>::sum(phi);
+        }
+    };
+
+    template<int N>
+    struct FixedChargeSum<N, N>
+    {
+        static double sum(const array<double, N>& phi) { return 0.; }
+    };
+
+    // Sum over I of phi[I] * phi[I+J]
+    template<int N, int J, int I>
+    struct FixedCorrSum
+    {
+        static double sum(const array<double, N>& phi)
+        {
+            return phi[I] * phi[(I+J) % N] + FixedCorrSum<N, J, I+1>::sum(phi);
+        }
+    };
+
+    template<int N, int J>
+    struct FixedCorrSum<N, J, N>
+    {
+        static double sum(const array<double, N>& phi) { return 0.; }
+    };
+
+    template<int N, int J>
+    struct FixedCorr
+    {
+        static void fill(const array<double, N>& phi, array<double, N>& corr)
+        {
+            corr[J] = FixedCorrSum<N, J, 0>::sum(phi) / N;
+            FixedCorr<N, J+1>::fill(phi, corr);
+        }
+    };
+
+    template<int N>
+    struct FixedCorr<N, N>
+    {
+        static void fill(const array<double, N>& phi, array<double, N>& corr) {}
+    };
+
+    // Hook of FixedMetropolisSweep that ignores accepted sites
+    struct FixedNoSiteHook
+    {
+        void accept(int i, double& phi) {}
+    };
+
+    // Metropolis update of site I and all following sites, same order
+    // of random numbers and same arithmetic as MetropolisContainer.
+    // Every accepted site is passed to hook.accept(I, phi[I]).
+    template<int N, int I>
+    struct FixedMetropolisSweep
+    {
+        template<class Hook>
+        static int sweep(array<double, N>& phi, double Ia, double delta,
+                         uniform_real_distribution< >& dist, mt19937_64& seed, Hook& hook)
+        {
+            const int before = (I + N - 1) % N;
+            const int after  = (I + 1) % N;
+
+            double r = 2*dist(seed) - 1;
+            double phiOld = phi[I];
+            double phiNew = phi[I] + delta * r;
+
+            double deltaS = Ia * (1. - cos(phi[after] - phiNew) + 1. - cos(phiNew - phi[before]))
+                          - Ia * (1. - cos(phi[after] - phiOld) + 1. - cos(phiOld - phi[before]));
+
+            int accept = 0;
+            if (dist(seed) <= exp(-deltaS))
+            {
+                phi[I] = phiNew;
+                hook.accept(I, phi[I]);
+                accept = 1;
+            }
+            return accept + FixedMetropolisSweep<N, I+1>::sweep(phi, Ia, delta, dist, seed, hook);
+        }
+    };
+
+    template<int N>
+    struct FixedMetropolisSweep<N, N>
+    {
+        template<class Hook>
+        static int sweep(array<double, N>& phi, double Ia, double delta,
+                         uniform_real_distribution< >& dist, mt19937_64& seed, Hook& hook) { return 0; }
+    };
+
+
+    /**
+       Lattice kernels for a ring with a compile-time number of sites N.
+       The state is kept in a std::array and all loops are unrolled.
+    */
+    template<int N>
+    class FixedLatticeKernels
+    {
+
+    public:
+
+        typedef array<double, N> State;
+
+        static void load(const LatticeContainer& l, State& phi)
+        {
+            for (int i=0; i<N; i++)
+                phi[i] = l.tslice[i].phi;
+        }
+
+        static void store(const State& phi, LatticeContainer& l)
+        {
+            for (int i=0; i<N; i++)
+                l.tslice[i].phi = phi[i];
+        }
+
+        static double getAction(const State& phi, double Ia)
+        {
+            return Ia * FixedActionSum<N, 0>::sum(phi);
+        }
+
+        static double computeQ(const State& phi)
+        {
+            return 1./(2*M_PI) * FixedChargeSum<N, 0>::sum(phi);
+        }
+
+        static void computeCorr(const State& phi, State& corr)
+        {
+            FixedCorr<N, 0>::fill(phi, corr);
+        }
+
+        /**
+           Do one Metropolis sweep
+
+           @param phi   State of lattice
+           @param Ia    I/a
+           @param delta Vicinity of old angle to look for new one
+           @param seed  Seed number
+           @param hook  Called with index and angle of every accepted site
+           @return      Number of accepted changes
+        */
+        template<class Hook>
+        static int doMetropolisSweep(State& phi, double Ia, double delta, mt19937_64& seed, Hook& hook)
+        {
+            uniform_real_distribution< > dist(0 , 1);
+            return FixedMetropolisSweep<N, 0>::sweep(phi, Ia, delta, dist, seed, hook);
+        }
+
+        static int doMetropolisSweep(State& phi, double Ia, double delta, mt19937_64& seed)
+        {
+            FixedNoSiteHook hook;
+            return doMetropolisSweep(phi, Ia, delta, seed, hook);
+        }
+    };
+
+
+    /**
+       Choose kernels of FixedLatticeKernels from xdim at runtime, use
+       the generic LatticeContainer methods for all other sizes
+    */
+    class LatticeKernelDispatcher
+    {
+
+    public:
+
+        static bool isSpecialized(int xdim);
+        static double getAction(LatticeContainer& l);
+        static void computeQ(LatticeContainer& l);
+        static void computeCorr(LatticeContainer& l);
+    };
+
+} // TopoOsciSim
+
+#endif // FIXEDLATTICE_H
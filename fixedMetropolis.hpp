@@ -0,0 +1,104 @@
+#ifndef FIXEDMETROPOLIS_H
+#define FIXEDMETROPOLIS_H
+
+#include <iostream>
+#include <random>
+#include "metropolis.hpp"
+#include "fixedLattice.hpp"
+#include "profiler.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Pass accepted sites of the unrolled sweep to the tracker (O(1)
+    // per site like MetropolisContainer), the angle comes back mapped
+    // to [-pi, pi]
+    struct FixedTrackerHook
+    {
+        ObservableTracker* tracker;
+
+        void accept(int i, double& phi)
+        {
+            tracker->setPhi(i, phi);
+            phi = tracker->lattice->tslice[i].phi;
+        }
+    };
+
+
+    /**
+       MetropolisContainer with an unrolled sweep for lattices with
+       N sites. Produces the same chain as MetropolisContainer, with
+       and without tracker.
+    */
+    template<int N>
+    class FixedMetropolisContainer : public MetropolisContainer
+    {
+
+    public:
+
+        typedef FixedLatticeKernels<N> Kernels;
+
+        typename Kernels::State phi;
+
+        FixedMetropolisContainer(LatticeContainer* l, const ParameterContainer& p) :
+            MetropolisContainer(l, p) {}
+
+        void doStep(mt19937_64& seed, double deltaIn)
+        {
+            Kernels::load(*lattice, phi);
+            int acceptCount;
+            if (tracker)
+            {
+                // the tracker writes the accepted sites to the lattice
+                FixedTrackerHook hook {tracker};
+                acceptCount = Kernels::doMetropolisSweep(phi, lattice->I/lattice->a, deltaIn, seed, hook);
+            }
+            else
+            {
+                acceptCount = Kernels::doMetropolisSweep(phi, lattice->I/lattice->a, deltaIn, seed);
+                Kernels::store(phi, *lattice);
+            }
+
+            lattice->algorithm = 'm';
+            acceptance = acceptCount / (double) N;
+
+            PROFILE_COUNT(siteUpdates, N);
+            PROFILE_COUNT(accepts, acceptCount);
+        }
+
+        void doStep(mt19937_64& seed)
+        {
+            instanton.doStep(seed);
+            FixedMetropolisContainer::doStep(seed, delta);
+        }
+
+        void run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink)
+        {
+            runEquilibration(*this, seed, nSteps, measureEvery, sink);
+        }
+    };
+
+
+    // Create FixedMetropolisContainer for xdim (NULL if not specialized)
+    template<int N>
+    struct FixedMetropolisFactory
+    {
+        static MetropolisContainer* create(LatticeContainer* l, const ParameterContainer& p)
+        {
+            if (l->xdim == N)
+                return new FixedMetropolisContainer<N>(l, p);
+            return FixedMetropolisFactory<N+1>::create(l, p);
+        }
+    };
+
+    template<>
+    struct FixedMetropolisFactory<fixedXdimMax+1>
+    {
+        static MetropolisContainer* create(LatticeContainer* l, const ParameterContainer& p) { return NULL; }
+    };
+
+} // TopoOsciSim
+
+#endif // FIXEDMETROPOLIS_H
@@ -0,0 +1,153 @@
+#include <iostream>
+#include "instanton.hpp"
+#include "metadynamics.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Create InstantonContainer on lattice
+    InstantonContainer::InstantonContainer(LatticeContainer* l, const ParameterContainer& p) :
+        lattice         {l},
+        tracker         {NULL},
+        instantonEvery  {p.instantonEvery},
+        stepsSinceMove  {0},
+        accuracy        {FastMath::getAccuracy(p.fastMath)},
+        Nproposed       {0},
+        Naccepted       {0},
+        differences     (l->xdim, 0.),
+        sines           (l->xdim, 0.),
+        cosines         (l->xdim, 0.)
+    {
+        if (accuracy == FastMath::libm)
+            accuracy = FastMath::full;
+        if (enabled() && (lattice->boundary != 'p'))
+        {
+            cerr << "ERROR: Instanton moves need periodic boundaries" << endl;
+            exit(0);
+        }
+    }
+
+    bool InstantonContainer::enabled() const
+    {
+        return (instantonEvery > 0);
+    }
+
+    void InstantonContainer::setTracker(ObservableTracker* t)
+    {
+        tracker = t;
+    }
+
+    // Take parameters of next point (statistics start again)
+    void InstantonContainer::setParameters(const ParameterContainer& p)
+    {
+        instantonEvery = p.instantonEvery;
+        accuracy = FastMath::getAccuracy(p.fastMath);
+        if (accuracy == FastMath::libm)
+            accuracy = FastMath::full;
+        if (enabled() && (lattice->boundary != 'p'))
+        {
+            cerr << "ERROR: Instanton moves need periodic boundaries" << endl;
+            exit(0);
+        }
+        stepsSinceMove = 0;
+        Nproposed = 0;
+        Naccepted = 0;
+    }
+
+    // Propose move after every instantonEvery-th step
+    void InstantonContainer::doStep(mt19937_64& seed)
+    {
+        if (!enabled())
+            return;
+        if (++stepsSinceMove < instantonEvery)
+            return;
+        stepsSinceMove = 0;
+        propose(seed);
+    }
+
+    // Propose twist and accept it with Metropolis test
+    bool InstantonContainer::propose(mt19937_64& seed)
+    {
+        uniform_real_distribution< > dist(0, 1);
+        uniform_int_distribution< > dist_origin(0, lattice->xdim-1);
+
+        int sign = (dist(seed) < 0.5) ? 1 : -1;
+        int origin = dist_origin(seed);
+
+        double deltaS = getActionDifference(sign);
+
+        Nproposed++;
+        if (dist(seed) > exp(-deltaS))
+            return false;
+        Naccepted++;
+
+        int xdim = lattice->xdim;
+        double twist = sign * 2*M_PI / xdim;
+        for (int i=0; i<xdim; i++)
+            lattice->tslice[i].phi += twist * ((i - origin + xdim) % xdim);
+
+        // all angles changed: tracked observables are recomputed (O(xdim))
+        if (tracker)
+        {
+            lattice->mod2Pi();
+            tracker->recompute();
+        }
+        if (lattice->bias)
+            lattice->bias->computeCharge();
+        return true;
+    }
+
+    // Action change of twist from one batch of sincos
+    double InstantonContainer::getActionDifference(int sign)
+    {
+        int xdim = lattice->xdim;
+        for (int i=0; i<xdim; i++)
+            differences[i] = lattice->tslice[lattice->tslice[i].idAfter].phi - lattice->tslice[i].phi;
+        FastMath::sincos(differences.data(), sines.data(), cosines.data(), xdim, accuracy);
+
+        // cos(d) - cos(d + t) = cos(d) (1 - cos t) + sin(d) sin t
+        double twist = sign * 2*M_PI / xdim;
+        double cosTwist = cos(twist);
+        double sinTwist = sin(twist);
+        double sum = 0.;
+        for (int i=0; i<xdim; i++)
+            sum += cosines[i] * (1. - cosTwist) + sines[i] * sinTwist;
+        double deltaS = lattice->I / lattice->a * sum;
+
+        // bias at smooth charge, sin(d + t) = sin(d) cos t + cos(d) sin t
+        if (lattice->bias)
+        {
+            double sumSin = 0., sumCos = 0.;
+            for (int i=0; i<xdim; i++)
+            {
+                sumSin += sines[i];
+                sumCos += cosines[i];
+            }
+            double charge = sumSin / (2*M_PI);
+            double chargeTwisted = (sumSin * cosTwist + sumCos * sinTwist) / (2*M_PI);
+            deltaS += lattice->bias->getBias(chargeTwisted) - lattice->bias->getBias(charge);
+        }
+
+        return deltaS;
+    }
+
+    double InstantonContainer::getAcceptance() const
+    {
+        if (Nproposed == 0)
+            return 0.;
+        return Naccepted / (double)Nproposed;
+    }
+
+    void InstantonContainer::dumpState(ostream& out)
+    {
+        out << stepsSinceMove << " " << Nproposed << " " << Naccepted;
+    }
+
+    void InstantonContainer::readState(istream& in)
+    {
+        in >> stepsSinceMove >> Nproposed >> Naccepted;
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,115 @@
+#ifndef INSTANTON_H
+#define INSTANTON_H
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include "parameters.hpp"
+#include "lattice.hpp"
+#include "observableTracker.hpp"
+#include "fastMath.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Global update that adds or removes a unit winding: the ring is
+       twisted by sign * 2pi * ((x - origin) mod xdim) / xdim, so every
+       link changes by sign * 2pi/xdim. The move is accepted with a
+       Metropolis test on the action change, which is computed in
+       O(xdim) with one batch of vectorized sincos. Engines propose it
+       after every instantonEvery-th step to change the topological
+       sector where local updates freeze (small a).
+    */
+    class InstantonContainer
+    {
+
+    public:
+
+        // Pointer to LatticeContainer
+        LatticeContainer* lattice;
+
+        // Pointer to ObservableTracker (NULL if observables are not tracked)
+        ObservableTracker* tracker;
+
+        // Steps between proposals (0: no instanton moves)
+        int instantonEvery;
+        int stepsSinceMove;
+
+        // Accuracy of sincos (libm is replaced by full)
+        FastMath::Accuracy accuracy;
+
+        // Proposed and accepted moves of the run
+        long Nproposed;
+        long Naccepted;
+
+        // Link differences and their sin and cos
+        vector<double> differences;
+        vector<double> sines;
+        vector<double> cosines;
+
+        /**
+           Create InstantonContainer on lattice
+
+           @param l Pointer to LatticeContainer
+           @param p Parameters (instantonEvery, fastMath)
+        */
+        InstantonContainer(LatticeContainer* l, const ParameterContainer& p);
+
+        // true if moves are proposed
+        bool enabled() const;
+
+        /**
+           Update lattice through tracker to keep observables up to date
+
+           @param t pointer to ObservableTracker
+        */
+        void setTracker(ObservableTracker* t);
+
+        /**
+           Take parameters of next point on same lattice
+
+           @param p Parameters
+        */
+        void setParameters(const ParameterContainer& p);
+
+        /**
+           Count step of engine and propose a move after every
+           instantonEvery-th step
+
+           @param seed Seed number
+        */
+        void doStep(mt19937_64& seed);
+
+        /**
+           Propose twist with random sign and origin and accept it with
+           probability min(1, exp(-deltaS))
+
+           @param seed Seed number
+           @return     true if accepted
+        */
+        bool propose(mt19937_64& seed);
+
+        /**
+           Return action change of twist (including the metadynamics
+           bias of the lattice), the origin only shifts the lattice
+           globally and does not change it
+
+           @param sign +1 (add winding) or -1 (remove winding)
+           @return     S[twisted] - S
+        */
+        double getActionDifference(int sign);
+
+        // Accepted fraction of proposed moves
+        double getAcceptance() const;
+
+        // Write and read step counter and statistics (for checkpoints)
+        void dumpState(ostream& out);
+        void readState(istream& in);
+    };
+
+} // TopoOsciSim
+
+#endif // INSTANTON_H
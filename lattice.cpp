@@ -1,5 +1,7 @@
 #include <iostream>
 #include "lattice.hpp"
+#include "metadynamics.hpp"
+#include "profiler.hpp"
 
 using namespace std;
 
@@ -13,8 +15,13 @@ namespace TopoOsciSim
         theta      { thetaIn},
         algorithm  { '\0'   },
         boundary   { '\0'   },
+        bulkMargin { 0      },
         q          { 0.     },
-        meanPhiSq  { 0.     }
+        meanPhiSq  { 0.     },
+        floatConfigs { false },
+        bias       { NULL   },
+        biasConfigs { false },
+        biasWeight { 0.     }
     {
         // allocate space
         tslice.reserve(xdim);
@@ -38,7 +45,12 @@ namespace TopoOsciSim
 
     // Constructor using ParameterContainer
     LatticeContainer::LatticeContainer(const ParameterContainer& p) :
-        LatticeContainer(p.I, p.a, p.xdim, p.theta) {}
+        LatticeContainer(p.I, p.a, p.xdim, p.theta)
+    {
+        floatConfigs = (p.precision == "float");
+        biasConfigs = (p.metaHeight > 0.);
+        bulkMargin = (p.bulkMargin < 0) ? xdim/4 : p.bulkMargin;
+    }
 
     // Copy Constructor
     LatticeContainer::LatticeContainer(const LatticeContainer &l) :
@@ -46,12 +58,18 @@ namespace TopoOsciSim
     {
         algorithm = l.algorithm;
         boundary = l.boundary;
+        bulkMargin = l.bulkMargin;
+        floatConfigs = l.floatConfigs;
+        biasConfigs = l.biasConfigs;
+        biasWeight = l.biasWeight;
         q = l.q;
         tslice = l.tslice;
         corr = l.corr;
 
         if (boundary == 'p')
             setPeriodicBoundaries();
+        else if (boundary == 'o')
+            setOpenBoundaries();
 
         for (int i=0; i<xdim; i++)
             tslice[i].phi = l.tslice[i].phi;
@@ -107,6 +125,22 @@ namespace TopoOsciSim
         for (int i=0; i<xdim; i++)
             tslice[i].phi = l.tslice[i].phi;
     }
+
+    // Set I, a and theta of parameters
+    void LatticeContainer::setParameters(const ParameterContainer& p)
+    {
+        if (p.xdim != xdim)
+        {
+            cerr << "ERROR: Lattice with xdim = " << xdim << " cannot be used for xdim = " << p.xdim << endl;
+            exit(0);
+        }
+        I     = p.I;
+        a     = p.a;
+        theta = p.theta;
+        floatConfigs = (p.precision == "float");
+        biasConfigs = (p.metaHeight > 0.);
+        bulkMargin = (p.bulkMargin < 0) ? xdim/4 : p.bulkMargin;
+    }
     
     //Set periodic boundary conditions on the lattice
     void LatticeContainer::setPeriodicBoundaries()
@@ -119,6 +153,39 @@ namespace TopoOsciSim
         // set lattice variable
         boundary = 'p';
     }
+
+    // Set open boundary conditions (no link between last and first timestep)
+    void LatticeContainer::setOpenBoundaries()
+    {
+        if (xdim - 2*bulkMargin < 2)
+        {
+            cerr << "ERROR: Bulk of xdim = " << xdim << " without " << bulkMargin << " sites at each end is too small" << endl;
+            exit(0);
+        }
+
+        tslice[0].idBefore = -1;
+        tslice[xdim-1].idAfter = -1;
+
+        boundary = 'o';
+    }
+
+    void LatticeContainer::setBoundaries(const ParameterContainer& p)
+    {
+        if (p.boundary == "open")
+            setOpenBoundaries();
+        else
+            setPeriodicBoundaries();
+    }
+
+    // Link from xpos to next site exists and is inside the bulk
+    bool LatticeContainer::isBulkLink(int xpos)
+    {
+        if (tslice[xpos].idAfter < 0)
+            return false;
+        if (boundary != 'o')
+            return true;
+        return ((xpos >= bulkMargin) && (xpos + 1 < xdim - bulkMargin));
+    }
     
     // Set all timeslices to random
     void LatticeContainer::setZero()
@@ -136,6 +203,9 @@ namespace TopoOsciSim
     
     double LatticeContainer::getActionSummand(int xpos)
     {
+        // no link after last site of open lattice
+        if (tslice[xpos].idAfter < 0)
+            return 0.;
         return I/a * (1. - cos(tslice[tslice[xpos].idAfter].phi - tslice[xpos].phi));
     }
 
@@ -147,9 +217,18 @@ namespace TopoOsciSim
         
     double LatticeContainer::getLocalAction(int xpos, double phiTest)
     {
-        return I/a * (1. - cos (tslice[tslice[xpos].idAfter].phi - phiTest)
-                    + 1. - cos (phiTest - tslice[tslice[xpos].idBefore].phi)
-            );
+        int after = tslice[xpos].idAfter;
+        int before = tslice[xpos].idBefore;
+        double localAction = 0.;
+        if (after >= 0)
+            localAction += I/a * (1. - cos (tslice[after].phi - phiTest));
+        if (before >= 0)
+            localAction += I/a * (1. - cos (phiTest - tslice[before].phi));
+
+        // global bias, O(1) with tracked smooth charge
+        if (bias)
+            localAction += bias->getLocalBias(xpos, phiTest);
+        return localAction;
     }
 
     // Return total lattice action
@@ -197,21 +276,31 @@ namespace TopoOsciSim
             tslice[i].mod2Pi();
     }
     
-    // Compute and set topological charge q
+    // Return angle difference mapped to (-pi, pi]
+    double LatticeContainer::getWrappedDifference(double diff)
+    {
+        if ( (fabs(fmod(diff - M_PI, 2*M_PI)) <= 1E-12) )
+            return M_PI;
+        else
+            return diff - 2 * M_PI * round(diff / (2 * M_PI));
+    }
+
+    // Charge of link after xpos (0 outside of bulk)
+    double LatticeContainer::getChargeSummand(int xpos)
+    {
+        if (!isBulkLink(xpos))
+            return 0.;
+        return getWrappedDifference(tslice[tslice[xpos].idAfter].phi - tslice[xpos].phi);
+    }
+    
+    // Compute and set topological charge q (of bulk, not integer with
+    // open boundaries)
     void LatticeContainer::computeQ()
     {
-        double sum = 0, diff, add;
+        double sum = 0;
         for (int i=0; i<xdim; i++)
-        {
-            diff = tslice[tslice[i].idAfter].phi - tslice[i].phi;
-            if ( (fabs(fmod(diff - M_PI, 2*M_PI)) <= 1E-12) )
-                add = M_PI;
-            else
-                add = diff - 2 * M_PI * round(diff / (2 * M_PI));
+            sum += getChargeSummand(i);
 
-            sum += add;
-            
-        }
         q = 1./(2*M_PI) * sum;
     }
 
@@ -222,6 +311,19 @@ namespace TopoOsciSim
         for (int i=0; i<xdim; i++)
             corr[i] = 0.;
 
+        // open boundaries: pairs inside the bulk
+        if (boundary == 'o')
+        {
+            int Nbulk = xdim - 2*bulkMargin;
+            for (int j=0; j<Nbulk; j++)
+            {
+                for (int i=bulkMargin; i+j<xdim-bulkMargin; i++)
+                    corr[j] += tslice[i].phi * tslice[i+j].phi;
+                corr[j] /= Nbulk - j;
+            }
+            return;
+        }
+
         // compute correlation
         for (int j=0; j<xdim; j++) // over Gamma entries
             for (int i=0; i<xdim; i++) // over seperation
@@ -234,9 +336,14 @@ namespace TopoOsciSim
     double LatticeContainer::computePlaquette()
     {
         double plaquette = 0.;
+        int Nlinks = 0;
         for (int i=0; i<xdim; i++)
-            plaquette += computeLocalPlaquetteAt(i);
-        return plaquette/(double)xdim;            
+            if (isBulkLink(i))
+            {
+                plaquette += computeLocalPlaquetteAt(i);
+                Nlinks++;
+            }
+        return plaquette/(double)Nlinks;            
     }
     
     double LatticeContainer::computeLocalPlaquetteAt(int tpos)
@@ -247,9 +354,14 @@ namespace TopoOsciSim
     complex<double> LatticeContainer::computeComplexPlaquette()
     {
         complex<double> plaquette = 0.;
+        int Nlinks = 0;
         for (int i=0; i<xdim; i++)
-            plaquette += computeComplexLocalPlaquetteAt(i);
-        return plaquette/(double)xdim;            
+            if (isBulkLink(i))
+            {
+                plaquette += computeComplexLocalPlaquetteAt(i);
+                Nlinks++;
+            }
+        return plaquette/(double)Nlinks;            
     }
 
     complex<double> LatticeContainer::computeComplexLocalPlaquetteAt(int tpos)
@@ -281,6 +393,7 @@ namespace TopoOsciSim
     // Write lattice charge to file
     void LatticeContainer::dumpQ(FileObs& Out)
     {
+        PROFILE_SCOPE(observableIO);
         Out.f << q << endl;
 
         if (!Out.f.good())
@@ -291,6 +404,7 @@ namespace TopoOsciSim
     // Write correlation of lattice variables to file
     void LatticeContainer::dumpCorr(FileObs& Out, int iConf)
     {
+        PROFILE_SCOPE(observableIO);
         for (int j=0; j<xdim; j++)
             Out.f << iConf << "\t" << j << "\t" << corr[j] << endl;
 
@@ -332,9 +446,11 @@ namespace TopoOsciSim
         In.f.read(&boundary,                      sizeof(boundary));
         In.f.read(&algorithm,                     sizeof(algorithm));
 
-        // set periodic boundaries of lattice
+        // set boundaries of lattice
         if (boundary == 'p')
             setPeriodicBoundaries();
+        else if (boundary == 'o')
+            setOpenBoundaries();
 
 	if (In.f.good())
 	{
@@ -352,8 +468,31 @@ namespace TopoOsciSim
     // Write Lattice to file
     void LatticeContainer::dumpConf(FileConfig& Out)
     {
-        for (int i=0; i<xdim; i++)
-            Out.f.write(reinterpret_cast<char*>(&(tslice[i].phi)), sizeof(double));
+        PROFILE_SCOPE(configIO);
+        if (floatConfigs)
+        {
+            PROFILE_COUNT(bytesWritten, xdim * sizeof(float));
+
+            for (int i=0; i<xdim; i++)
+            {
+                float phi = tslice[i].phi;
+                Out.f.write(reinterpret_cast<char*>(&phi), sizeof(float));
+            }
+        }
+        else
+        {
+            PROFILE_COUNT(bytesWritten, xdim * sizeof(double));
+
+            for (int i=0; i<xdim; i++)
+                Out.f.write(reinterpret_cast<char*>(&(tslice[i].phi)), sizeof(double));
+        }
+
+        // bias for reweighting
+        if (biasConfigs)
+        {
+            PROFILE_COUNT(bytesWritten, sizeof(double));
+            Out.f.write(reinterpret_cast<char*>(&biasWeight), sizeof(double));
+        }
 
         if (Out.f.good())
             ;//cout << "Configuration written successfully to " << Out.name.fullName << endl;
@@ -365,13 +504,25 @@ namespace TopoOsciSim
     // Read Lattice from file
     bool LatticeContainer::readConf(FileConfig& In)
     {
+        PROFILE_SCOPE(configIO);
+        PROFILE_COUNT(bytesRead, xdim * (floatConfigs ? sizeof(float) : sizeof(double)) + (biasConfigs ? sizeof(double) : 0));
+
         int i;
         for (i=0; i<xdim; i++)
         {
-            In.f.read(reinterpret_cast<char*>(&(tslice[i].phi)), sizeof(double));
+            if (floatConfigs)
+            {
+                float phi;
+                In.f.read(reinterpret_cast<char*>(&phi), sizeof(float));
+                tslice[i].phi = phi;
+            }
+            else
+                In.f.read(reinterpret_cast<char*>(&(tslice[i].phi)), sizeof(double));
             if (In.f.eof()) break;
             // cout << i << ") ... " << In.f.eof() << ", ";
         }
+        if (biasConfigs && (i == xdim))
+            In.f.read(reinterpret_cast<char*>(&biasWeight), sizeof(double));
         
         // error messages
         if (In.f.good())
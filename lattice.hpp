@@ -14,6 +14,8 @@ using namespace std;
 
 namespace TopoOsciSim
 {
+
+    class MetadynamicsContainer;
     
     class LatticeContainer
     {
@@ -26,10 +28,27 @@ namespace TopoOsciSim
         double theta;
         vector<TimestepContainer> tslice;
         char algorithm;
+        // 'p' (periodic) or 'o' (open: no link between the ends,
+        // idBefore of the first and idAfter of the last site are -1)
         char boundary;
+
+        // Sites at each open end that are not measured
+        int bulkMargin;
         double q;
         double meanPhiSq;
         vector<double> corr;
+
+        // Configurations are written and read as float
+        // (precision float) instead of double
+        bool floatConfigs;
+
+        // Bias of metadynamics in the local action (NULL: no bias)
+        MetadynamicsContainer* bias;
+
+        // Configurations are followed by their bias V (metaHeight > 0),
+        // bias of the last written or read configuration
+        bool biasConfigs;
+        double biasWeight;
         
         LatticeContainer(const double& IIn, const double& aIn, const int& xdimIn, const double& thetaIn);
         LatticeContainer(const double& IIn, const double& aIn, const int& xdimIn);
@@ -43,8 +62,33 @@ namespace TopoOsciSim
         bool operator==(const LatticeContainer& l2);
 
         void copyContent(const LatticeContainer& l);        
+
+        /**
+           Set I, a and theta of parameters (xdim has to be the same,
+           reuse of lattice for another parameter point)
+
+           @param p Parameters
+        */
+        void setParameters(const ParameterContainer& p);
         int getId(int i);
         void setPeriodicBoundaries();
+        void setOpenBoundaries();
+
+        /**
+           Set boundaries of parameters (periodic or open)
+
+           @param p Parameters
+        */
+        void setBoundaries(const ParameterContainer& p);
+
+        /**
+           Return true if the link from xpos to the next site exists and
+           is measured (both sites outside of the bulk margins)
+
+           @param xpos Lattice index
+           @return     true for bulk link
+        */
+        bool isBulkLink(int xpos);
         void setZero();
         void setRandom(mt19937_64& seed);
         double getActionSummand(int xpos);
@@ -56,6 +100,35 @@ namespace TopoOsciSim
         complex<double> getAlphaAction();
         complex<double> getAlphaWeight();
         void mod2Pi();
+
+        /**
+           Return angle mod 2pi in [-pi, pi] in scalar type Real
+
+           @param phi Angle
+           @return    Angle mod 2pi
+        */
+        template<class Real>
+        static Real getAngleMod2Pi(Real phi);
+
+        /**
+           Copy angles mod 2pi into array of scalar type Real (storage
+           of the float sweeps, mod 2pi to keep the precision)
+
+           @param phi Angles in site order
+        */
+        template<class Real>
+        void getAngles(vector<Real>& phi) const;
+
+        /**
+           Set angles from array of scalar type Real
+
+           @param phi Angles in site order
+        */
+        template<class Real>
+        void setAngles(const vector<Real>& phi);
+
+        static double getWrappedDifference(double diff);
+        double getChargeSummand(int xpos);
         void computeQ();
         void computeCorr();
         double computePlaquette();
@@ -73,6 +146,33 @@ namespace TopoOsciSim
         void dumpConf(FileConfig& Out);
         bool readConf(FileConfig& In);
     };
+
+    template<class Real>
+    Real LatticeContainer::getAngleMod2Pi(Real phi)
+    {
+        return phi - Real(2 * M_PI) * round(phi / Real(2 * M_PI));
+    }
+
+    template<class Real>
+    void LatticeContainer::getAngles(vector<Real>& phi) const
+    {
+        // angles in range are kept, so the float angles of a run come
+        // back unchanged in the next one
+        phi.resize(xdim);
+        for (int i=0; i<xdim; i++)
+        {
+            phi[i] = tslice[i].phi;
+            if (fabs(phi[i]) > Real(M_PI))
+                phi[i] = getAngleMod2Pi(tslice[i].phi);
+        }
+    }
+
+    template<class Real>
+    void LatticeContainer::setAngles(const vector<Real>& phi)
+    {
+        for (int i=0; i<xdim; i++)
+            tslice[i].phi = phi[i];
+    }
     
 } // TopoOsciSim
 
@@ -1,19 +1,92 @@
 #ifndef LATTICEEQUILIBRATION_H
 #define LATTICEEQUILIBRATION_H
 
+#include <random>
+#include "observableTracker.hpp"
+#include "measurementSink.hpp"
+#include "profiler.hpp"
+
 using namespace std;
 
 namespace TopoOsciSim
 {
+    // Number of measured steps whose diagnostics are handed to the sink at once
+    const int infoBlockSize = 1024;
+
     // abstract class
     class LatticeEquilibration
-    {   
-    public:        
+    {
+    public:
+        virtual ~LatticeEquilibration() {}
         virtual void doStep(mt19937_64& seed, double deltaIn) = 0;
         virtual void doStep(mt19937_64& seed) = 0;
         virtual void writeInfosToFile() = 0;
+        virtual void setTracker(ObservableTracker* t) = 0;
+
+        // Number of values of each diagnostic (empty: one each), hidden
+        // by engines with vector-valued diagnostics
+        vector<int> getInfoWidths() { return vector<int>(); }
+
+        // Take parameters of next point on same lattice (reuse of engine)
+        virtual void setParameters(const ParameterContainer& p) {}
+
+        // Write and read state kept between steps (for checkpoints)
+        virtual void dumpState(ostream& out) {}
+        virtual void readState(istream& in) {}
+
+        /**
+           Do nSteps steps and measure after every measureEvery-th step
+
+           @param seed         Seed number
+           @param nSteps       Number of steps
+           @param measureEvery Number of steps between measurements
+           @param sink         Gets measurements and diagnostics (NULL: no measurements)
+        */
+        virtual void run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink) = 0;
     };
-    
+
+
+    /**
+       Loop of LatticeEquilibration::run. All calls are bound to Engine
+       at compile time, so the step is inlined into the loop. Engine
+       needs doStep(seed), finishStep(), prepareMeasurement(),
+       getInfoNames(), getInfoWidths() and appendInfos(values).
+    */
+    template<class Engine>
+    void runEquilibration(Engine& engine, mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink)
+    {
+        InfoBlock block;
+        block.names = engine.Engine::getInfoNames();
+        block.widths = engine.Engine::getInfoWidths();
+        block.values.reserve(infoBlockSize * block.getStride());
+
+        for (int k=0; k<nSteps; k++)
+        {
+            engine.Engine::doStep(seed);
+            engine.Engine::finishStep();
+
+            if ((sink == NULL) || ((k+1) % measureEvery != 0))
+                continue;
+
+            {
+                PROFILE_SCOPE(observables);
+                engine.Engine::prepareMeasurement();
+                engine.Engine::appendInfos(block.values);
+                block.Nsteps++;
+            }
+            sink->measure(k);
+
+            if (block.Nsteps == infoBlockSize)
+            {
+                sink->processInfos(block);
+                block.clear();
+            }
+        }
+
+        if ((sink != NULL) && (block.Nsteps > 0))
+            sink->processInfos(block);
+    }
+
 } // TopoOsciSim
 
 #endif
@@ -3,23 +3,50 @@
 
 #include "latticeEquilibration.hpp"
 #include "metropolis.hpp"
+#include "fixedMetropolis.hpp"
 #include "cluster.hpp"
+#include "xyMetropolis.hpp"
+#include "xyCluster.hpp"
 
 using namespace std;
 
 namespace TopoOsciSim
 {
     
-    LatticeEquilibration *NewLatticeEquilibrationFor(
+    inline LatticeEquilibration *NewLatticeEquilibrationFor(
         LatticeContainer *l,
         const ParameterContainer& p)
     {
+        // float sweeps are sequential, without instanton moves and bias
+        if ((p.precision == "float") && ((p.fastMath != "off") || (p.instantonEvery > 0) || (p.metaHeight > 0.)))
+        {
+            cerr << "ERROR: precision float supports neither fastMath, instanton moves nor metadynamics" << endl;
+            exit(0);
+        }
+
         if (p.equilibrationAlgorithm == "metropolis")
         {
+            // hills are only deposited during thermalization
+            if ((p.metaHeight > 0.) && (p.metaBuildup > p.Nthermal))
+            {
+                cerr << "ERROR: metaBuildup " << p.metaBuildup << " is longer than Nthermal " << p.Nthermal << endl;
+                exit(0);
+            }
+            // unrolled sweep for small periodic lattices (fastMath
+            // uses the batched sweep, metadynamics the bias in the
+            // local action, precision float the float angles)
+            if ((l->boundary == 'p') && LatticeKernelDispatcher::isSpecialized(l->xdim) && (p.fastMath == "off")
+                && (p.metaHeight <= 0.) && (p.precision == "double"))
+                return FixedMetropolisFactory<fixedXdimMin>::create(l, p);
             return new MetropolisContainer(l, p);
         }
         else if (p.equilibrationAlgorithm == "cluster")
         {
+            if (p.metaHeight > 0.)
+            {
+                cerr << "ERROR: Metadynamics bias needs equilibrationAlgorithm metropolis" << endl;
+                exit(0);
+            }
             return new ClusterContainer(l, p);
         }
         else
@@ -27,6 +54,25 @@ namespace TopoOsciSim
             return NULL;
         }
     }
+
+    template<int D, int B>
+    LatticeEquilibration *NewLatticeEquilibrationFor(
+        XYLatticeContainer<D, B> *l,
+        const ParameterContainer& p)
+    {
+        if (p.equilibrationAlgorithm == "metropolis")
+        {
+            return new XYMetropolisContainer<D, B>(l, p);
+        }
+        else if (p.equilibrationAlgorithm == "cluster")
+        {
+            return new XYClusterContainer<D, B>(l, p);
+        }
+        else
+        {
+            return NULL;
+        }
+    }
     
 } // TopoOsciSim
 
@@ -0,0 +1,69 @@
+#include <iostream>
+#include "measurementSink.hpp"
+#include "profiler.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    FileSink::FileSink(LatticeContainer* l, FileConfig* c, const ParameterContainer& p, bool appendIn) :
+        lattice    {l},
+        conf       {c},
+        parameters {p},
+        append     {appendIn}
+    {}
+
+    FileSink::~FileSink()
+    {
+        for (unsigned int i=0; i<files.size(); i++)
+            delete files[i];
+    }
+
+    void FileSink::measure(int step)
+    {
+        if (conf)
+            lattice->dumpConf(*conf);
+    }
+
+    // Write one file per diagnostic (one line per step), flushing once per block
+    void FileSink::processInfos(const InfoBlock& block)
+    {
+        PROFILE_SCOPE(observableIO);
+        int Ninfos = block.names.size();
+        int stride = block.getStride();
+
+        // create files with first block
+        if (files.empty())
+            for (int c=0; c<Ninfos; c++)
+            {
+                files.push_back(new FileObs(block.names[c], parameters));
+                if (append)
+                    files.back()->append();
+                else
+                    files.back()->create();
+            }
+
+        for (int c=0; c<Ninfos; c++)
+        {
+#ifdef TOPOOSCI_PROFILE
+            streampos start = files[c]->f.tellp();
+#endif
+            int offset = block.getOffset(c);
+            int width = block.getWidth(c);
+            for (int k=0; k<block.Nsteps; k++)
+                for (int w=0; w<width; w++)
+                    files[c]->f << block.values[k*stride + offset + w] << ((w+1 < width) ? '\t' : '\n');
+            files[c]->f.flush();
+            PROFILE_COUNT(bytesWritten, files[c]->f.tellp() - start);
+        }
+    }
+
+    void SeriesSink::measure(int step)
+    {
+        q.push_back(tracker->q);
+        action.push_back(tracker->action);
+        meanPhiSq.push_back(tracker->getMeanPhiSq());
+    }
+
+} // TopoOsciSim
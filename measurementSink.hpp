@@ -0,0 +1,131 @@
+#ifndef MEASUREMENTSINK_H
+#define MEASUREMENTSINK_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "observableTracker.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Diagnostics of a block of measured steps
+    class InfoBlock
+    {
+    public:
+
+        // Name of each diagnostic (used as file type)
+        vector<string> names;
+
+        // Number of measured steps in block
+        int Nsteps;
+
+        // Number of values of each diagnostic (empty: one each)
+        vector<int> widths;
+
+        // Values of measured step k at [k*getStride() + getOffset(c) ...]
+        vector<double> values;
+
+        InfoBlock() : Nsteps {0} {}
+
+        int getWidth(int c) const { return widths.empty() ? 1 : widths[c]; }
+
+        // Position of first value of diagnostic c within a step
+        int getOffset(int c) const
+        {
+            int offset = 0;
+            for (int i=0; i<c; i++)
+                offset += getWidth(i);
+            return offset;
+        }
+
+        // Number of values of one step
+        int getStride() const { return getOffset(names.size()); }
+
+        void clear()
+        {
+            Nsteps = 0;
+            values.clear();
+        }
+    };
+
+
+    // abstract class
+    class MeasurementSink
+    {
+    public:
+        virtual ~MeasurementSink() {}
+
+        /**
+           Called after every measured step of LatticeEquilibration::run
+
+           @param step Number of step (starting at 0)
+        */
+        virtual void measure(int step) = 0;
+
+        /**
+           Process diagnostics of a block of measured steps
+
+           @param block Diagnostics
+        */
+        virtual void processInfos(const InfoBlock& block) = 0;
+    };
+
+
+    /**
+       Write lattice configurations to a FileConfig and each
+       diagnostic to its own FileObs
+    */
+    class FileSink : public MeasurementSink
+    {
+    public:
+
+        LatticeContainer* lattice;
+
+        // Configuration file (NULL: configurations are not written)
+        FileConfig* conf;
+
+        ParameterContainer parameters;
+
+        // Observable file for each diagnostic
+        vector<FileObs*> files;
+
+        // Append to existing observable files (resumed run)
+        bool append;
+
+        FileSink(LatticeContainer* l, FileConfig* c, const ParameterContainer& p, bool appendIn = false);
+        ~FileSink();
+
+        void measure(int step);
+        void processInfos(const InfoBlock& block);
+    };
+
+
+    /**
+       Keep time series of the tracked observables in memory
+       (diagnostics are dropped)
+    */
+    class SeriesSink : public MeasurementSink
+    {
+    public:
+
+        ObservableTracker* tracker;
+
+        vector<double> q;
+        vector<double> action;
+        vector<double> meanPhiSq;
+
+        SeriesSink(ObservableTracker* t) : tracker {t} {}
+
+        void measure(int step);
+        void processInfos(const InfoBlock& block) {}
+    };
+
+} // TopoOsciSim
+
+#endif // MEASUREMENTSINK_H
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <cmath>
+#include "metadynamics.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Create MetadynamicsContainer on lattice
+    MetadynamicsContainer::MetadynamicsContainer(LatticeContainer* l, const ParameterContainer& p) :
+        lattice      {l},
+        height       {0.},
+        width        {0.},
+        range        {0.},
+        buildupSteps {0},
+        stepsDone    {0},
+        spacing      {0.},
+        charge       {0.}
+    {
+        setParameters(p);
+    }
+
+    bool MetadynamicsContainer::enabled() const
+    {
+        return (height > 0.);
+    }
+
+    bool MetadynamicsContainer::frozen() const
+    {
+        return (stepsDone >= buildupSteps);
+    }
+
+    // Take parameters of next point (bias starts from zero)
+    void MetadynamicsContainer::setParameters(const ParameterContainer& p)
+    {
+        height = p.metaHeight;
+        width = p.metaWidth;
+        range = p.metaRange;
+        buildupSteps = p.metaBuildup;
+        stepsDone = 0;
+        charge = 0.;
+        potential.clear();
+        if (!enabled())
+            return;
+
+        // four grid points per width: interpolation error below 1% of height
+        spacing = width / 4.;
+        int Nhalf = ceil(range / spacing);
+        range = Nhalf * spacing;
+        potential.assign(2*Nhalf + 1, 0.);
+    }
+
+    // Compute smooth charge of whole lattice
+    void MetadynamicsContainer::computeCharge()
+    {
+        double sum = 0.;
+        for (int i=0; i<lattice->xdim; i++)
+            if (lattice->tslice[i].idAfter >= 0)
+                sum += sin(lattice->tslice[lattice->tslice[i].idAfter].phi - lattice->tslice[i].phi);
+        charge = sum / (2*M_PI);
+    }
+
+    // Return charge of both links of xpos (one at an open end)
+    double MetadynamicsContainer::getLocalCharge(int xpos, double phiTest)
+    {
+        int after = lattice->tslice[xpos].idAfter;
+        int before = lattice->tslice[xpos].idBefore;
+        double sum = 0.;
+        if (after >= 0)
+            sum += sin(lattice->tslice[after].phi - phiTest);
+        if (before >= 0)
+            sum += sin(phiTest - lattice->tslice[before].phi);
+        return sum / (2*M_PI);
+    }
+
+    // Return linearly interpolated bias (constant outside of grid)
+    double MetadynamicsContainer::getBias(double q)
+    {
+        if (potential.empty())
+            return 0.;
+        double u = (q + range) / spacing;
+        if (u <= 0.)
+            return potential.front();
+        int k = u;
+        if (k >= (int)potential.size() - 1)
+            return potential.back();
+        u -= k;
+        return (1. - u) * potential[k] + u * potential[k+1];
+    }
+
+    double MetadynamicsContainer::getBias()
+    {
+        return getBias(charge);
+    }
+
+    // Bias with phiTest at xpos, O(1) with tracked charge
+    double MetadynamicsContainer::getLocalBias(int xpos, double phiTest)
+    {
+        double phiOld = lattice->tslice[xpos].phi;
+        if (phiTest == phiOld)
+            return getBias(charge);
+        return getBias(charge + getLocalCharge(xpos, phiTest) - getLocalCharge(xpos, phiOld));
+    }
+
+    // Update smooth charge before angle is set
+    void MetadynamicsContainer::setPhi(int xpos, double phiNew)
+    {
+        charge += getLocalCharge(xpos, phiNew) - getLocalCharge(xpos, lattice->tslice[xpos].phi);
+    }
+
+    // Add Gaussian on grid points within 5 widths
+    void MetadynamicsContainer::depositHill(double q)
+    {
+        int Ngrid = potential.size();
+        int kMin = max(0, (int)floor((q - 5*width + range) / spacing));
+        int kMax = min(Ngrid - 1, (int)ceil((q + 5*width + range) / spacing));
+        for (int k=kMin; k<=kMax; k++)
+        {
+            double d = (-range + k * spacing - q) / width;
+            potential[k] += height * exp(-0.5 * d * d);
+        }
+    }
+
+    // Deposit during build-up and set bias weight of lattice
+    void MetadynamicsContainer::finishStep()
+    {
+        if (!frozen())
+        {
+            depositHill(charge);
+            stepsDone++;
+        }
+        lattice->biasWeight = getBias();
+    }
+
+    void MetadynamicsContainer::dumpState(ostream& out)
+    {
+        out << stepsDone << " " << potential.size();
+        for (unsigned int k=0; k<potential.size(); k++)
+            out << " " << potential[k];
+    }
+
+    void MetadynamicsContainer::readState(istream& in)
+    {
+        unsigned int Ngrid;
+        in >> stepsDone >> Ngrid;
+        if (Ngrid != potential.size())
+        {
+            cerr << "ERROR: Bias of checkpoint has " << Ngrid << " instead of " << potential.size() << " grid points" << endl;
+            exit(0);
+        }
+        for (unsigned int k=0; k<Ngrid; k++)
+            in >> potential[k];
+    }
+
+} // TopoOsciSim
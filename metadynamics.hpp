@@ -0,0 +1,132 @@
+#ifndef METADYNAMICS_H
+#define METADYNAMICS_H
+
+#include <iostream>
+#include <vector>
+#include "parameters.hpp"
+#include "lattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       History-dependent bias V(q_s) in the smooth topological charge
+       q_s = 1/(2pi) sum_x sin(phi_{x+1} - phi_x), which is continuous
+       in the angles. During the first metaBuildup steps a Gaussian of
+       height metaHeight and width metaWidth is added at the current
+       q_s after every step, afterwards the bias is frozen and the
+       configurations are distributed with exp(-S - V). V is kept on a
+       grid in [-metaRange, metaRange] (constant outside) and linearly
+       interpolated, q_s is tracked per site update, so the bias term
+       of the local action costs O(1).
+    */
+    class MetadynamicsContainer
+    {
+
+    public:
+
+        // Pointer to LatticeContainer
+        LatticeContainer* lattice;
+
+        // Height and width of the Gaussians, range of the grid
+        double height;
+        double width;
+        double range;
+
+        // Steps with deposition of Gaussians and steps done
+        int buildupSteps;
+        int stepsDone;
+
+        // Bias at q = -range + k * spacing
+        double spacing;
+        vector<double> potential;
+
+        // Smooth charge of lattice
+        double charge;
+
+        /**
+           Create MetadynamicsContainer on lattice (bias is zero)
+
+           @param l Pointer to LatticeContainer
+           @param p Parameters (metaHeight, metaWidth, metaRange, metaBuildup)
+        */
+        MetadynamicsContainer(LatticeContainer* l, const ParameterContainer& p);
+
+        // true if a bias is used (metaHeight > 0)
+        bool enabled() const;
+
+        // true after the build-up phase
+        bool frozen() const;
+
+        /**
+           Take parameters of next point on same lattice (bias starts
+           from zero)
+
+           @param p Parameters
+        */
+        void setParameters(const ParameterContainer& p);
+
+        // Compute smooth charge of whole lattice
+        void computeCharge();
+
+        /**
+           Return contribution of both links of a timestep to the
+           smooth charge
+
+           @param xpos    Lattice index
+           @param phiTest Angle of timestep
+           @return        Charge of links xpos-1 and xpos
+        */
+        double getLocalCharge(int xpos, double phiTest);
+
+        /**
+           Return bias at smooth charge q
+
+           @param q Smooth charge
+           @return  V(q)
+        */
+        double getBias(double q);
+
+        // Bias of lattice
+        double getBias();
+
+        /**
+           Return bias of lattice with angle phiTest at xpos (term of
+           the local action)
+
+           @param xpos    Lattice index
+           @param phiTest Angle of timestep
+           @return        V(q_s) with phiTest at xpos
+        */
+        double getLocalBias(int xpos, double phiTest);
+
+        /**
+           Update smooth charge for new angle of one timestep (called
+           before the angle is set on the lattice)
+
+           @param xpos   Lattice index
+           @param phiNew New angle
+        */
+        void setPhi(int xpos, double phiNew);
+
+        /**
+           Add Gaussian at q to bias
+
+           @param q Smooth charge
+        */
+        void depositHill(double q);
+
+        // Deposit at current charge during build-up and set bias
+        // weight of lattice
+        void finishStep();
+
+        // Write and read step counter and bias (for checkpoints)
+        void dumpState(ostream& out);
+        void readState(istream& in);
+    };
+
+} // TopoOsciSim
+
+#endif // METADYNAMICS_H
@@ -1,5 +1,6 @@
 #include <iostream>
 #include "metropolis.hpp"
+#include "profiler.hpp"
 
 using namespace std;
 
@@ -9,13 +10,26 @@ namespace TopoOsciSim
     // Create MetropolisContainer on lattice
     MetropolisContainer::MetropolisContainer(LatticeContainer* l, const ParameterContainer& p) : 
         lattice     {l},
+        tracker     {NULL},
         delta       {p.deltaMetro},
         acceptance  (0.),
+        fastMath    {FastMath::getAccuracy(p.fastMath)},
+        floatSweeps {p.precision == "float"},
+        instanton   (l, p),
+        metadynamics(l, p),
         fAcc        ("MetropolisAcc", p),
         fMeanPhiSq  ("MeanPhiSq", p)
     {
-        fAcc.create();
-        fMeanPhiSq.create();
+        if (metadynamics.enabled())
+            lattice->bias = &metadynamics;
+        if (floatSweeps)
+            lattice->getAngles(phiFloat);
+    }
+
+    MetropolisContainer::~MetropolisContainer()
+    {
+        if (lattice->bias == &metadynamics)
+            lattice->bias = NULL;
     }
     
     
@@ -29,13 +43,33 @@ namespace TopoOsciSim
     
     void MetropolisContainer::doStep(mt19937_64& seed, double deltaIn)
     {
+        // smooth charge from scratch once per sweep (no drift)
+        if (metadynamics.enabled())
+            metadynamics.computeCharge();
+
+        int acceptCount = floatSweeps ? doSweepFloat(seed, deltaIn) : doSiteUpdates(seed, deltaIn, 0, lattice->xdim);
+
+        lattice->algorithm = 'm';
+        acceptance = acceptCount / (double) lattice->xdim;
+
+        PROFILE_COUNT(siteUpdates, lattice->xdim);
+        PROFILE_COUNT(accepts, acceptCount);
+    }
+
+    // Metropolis update of sites [first, last)
+    int MetropolisContainer::doSiteUpdates(mt19937_64& seed, double deltaIn, int first, int last)
+    {
+        // the bias couples all sites: sequential sweep
+        if ((fastMath != FastMath::libm) && !metadynamics.enabled())
+            return doSiteUpdatesBatched(seed, deltaIn, first, last);
+
         uniform_real_distribution< > dist_newPhi( 0 , 1 );
         uniform_real_distribution< > dist_metro(0 , 1 );
         
         int acceptCount = 0;
         double phiOld, phiNew, deltaS;
         double r, r2;
-        for (int i=0; i<lattice->xdim; i++)
+        for (int i=first; i<last; i++)
         {
             r = 2*dist_newPhi(seed) - 1;
             
@@ -48,26 +82,264 @@ namespace TopoOsciSim
             
             if (r2 <= exp(-deltaS))
             {
-                lattice->tslice[i].phi = phiNew;
+                if (metadynamics.enabled())
+                    metadynamics.setPhi(i, phiNew);
+                if (tracker)
+                    tracker->setPhi(i, phiNew);
+                else
+                    lattice->tslice[i].phi = phiNew;
                 acceptCount += 1;
 
             }
 
         }
-        lattice->algorithm = 'm';
-        acceptance = acceptCount / (double) lattice->xdim;
+        return acceptCount;
+    }
+
+    // Sequential sweep on the float angles
+    int MetropolisContainer::doSweepFloat(mt19937_64& seed, double deltaIn)
+    {
+        uniform_real_distribution< > dist_newPhi( 0 , 1 );
+        uniform_real_distribution< > dist_metro(0 , 1 );
+
+        int xdim = lattice->xdim;
+        bool periodic = (lattice->boundary == 'p');
+        float Ia = lattice->I / lattice->a;
+        float deltaFloat = deltaIn;
+
+        int acceptCount = 0;
+        for (int i=0; i<xdim; i++)
+        {
+            float r = 2*dist_newPhi(seed) - 1;
+            float phiOld = phiFloat[i];
+            float phiNew = phiOld + deltaFloat * r;
+
+            // -deltaS / Ia, missing neighbour at open end drops out
+            int after = (i+1 < xdim) ? i+1 : (periodic ? 0 : -1);
+            int before = (i > 0) ? i-1 : (periodic ? xdim-1 : -1);
+            float deltaCos = 0.f;
+            if (after >= 0)
+                deltaCos += cos(phiFloat[after] - phiNew) - cos(phiFloat[after] - phiOld);
+            if (before >= 0)
+                deltaCos += cos(phiNew - phiFloat[before]) - cos(phiOld - phiFloat[before]);
+
+            if (dist_metro(seed) <= exp(Ia * deltaCos))
+            {
+                // mod 2pi, float loses precision for large angles
+                if (fabs(phiNew) > float(M_PI))
+                    phiNew = LatticeContainer::getAngleMod2Pi(phiNew);
+                phiFloat[i] = phiNew;
+                acceptCount += 1;
+            }
+        }
+        return acceptCount;
+    }
+
+    // Metropolis update of sites [first, last) in classes of
+    // independent sites
+    int MetropolisContainer::doSiteUpdatesBatched(mt19937_64& seed, double deltaIn, int first, int last)
+    {
+        uniform_real_distribution< > dist(0 , 1);
+
+        int n = last - first;
+        randomPhi.resize(n);
+        randomMetro.resize(n);
+        for (int k=0; k<n; k++)
+        {
+            randomPhi[k] = 2*dist(seed) - 1;
+            randomMetro[k] = dist(seed);
+        }
+
+        // the last site is a neighbour of the first one on a ring
+        // with odd number of sites
+        bool lastAlone = (n % 2 == 1) && (n > 1) && (lattice->tslice[last-1].idAfter == first);
+
+        int acceptCount = 0;
+        for (int parity=0; parity<2; parity++)
+        {
+            batchSites.clear();
+            for (int i=first+parity; i<last; i+=2)
+                if (!lastAlone || (i != last-1))
+                    batchSites.push_back(i);
+            acceptCount += updateBatch(deltaIn, first);
+        }
+        if (lastAlone)
+        {
+            batchSites.assign(1, last-1);
+            acceptCount += updateBatch(deltaIn, first);
+        }
+        return acceptCount;
+    }
+
+    // Update the sites of batchSites at the same time
+    int MetropolisContainer::updateBatch(double deltaIn, int first)
+    {
+        int m = batchSites.size();
+        batchPhiNew.resize(m);
+        batchCos.resize(4*m);
+        batchExp.resize(m);
+
+        // arguments of the four cos of deltaS
+        for (int j=0; j<m; j++)
+        {
+            int i = batchSites[j];
+            double phiOld = lattice->tslice[i].phi;
+            double phiNew = phiOld + deltaIn * randomPhi[i-first];
+            int after = lattice->tslice[i].idAfter;
+            int before = lattice->tslice[i].idBefore;
+            batchPhiNew[j] = phiNew;
+
+            // missing neighbour at open end: cos(0) - cos(0) drops out
+            if (after >= 0)
+            {
+                batchCos[4*j]   = lattice->tslice[after].phi - phiNew;
+                batchCos[4*j+2] = lattice->tslice[after].phi - phiOld;
+            }
+            else
+                batchCos[4*j] = batchCos[4*j+2] = 0.;
+            if (before >= 0)
+            {
+                batchCos[4*j+1] = phiNew - lattice->tslice[before].phi;
+                batchCos[4*j+3] = phiOld - lattice->tslice[before].phi;
+            }
+            else
+                batchCos[4*j+1] = batchCos[4*j+3] = 0.;
+        }
+        FastMath::cos(batchCos.data(), batchCos.data(), 4*m, fastMath);
+
+        // exp(-deltaS)
+        double Ia = lattice->I / lattice->a;
+        for (int j=0; j<m; j++)
+            batchExp[j] = Ia * (batchCos[4*j] + batchCos[4*j+1] - batchCos[4*j+2] - batchCos[4*j+3]);
+        FastMath::exp(batchExp.data(), batchExp.data(), m, fastMath);
+
+        int acceptCount = 0;
+        for (int j=0; j<m; j++)
+        {
+            int i = batchSites[j];
+            if (randomMetro[i-first] <= batchExp[j])
+            {
+                if (tracker)
+                    tracker->setPhi(i, batchPhiNew[j]);
+                else
+                    lattice->tslice[i].phi = batchPhiNew[j];
+                acceptCount += 1;
+            }
+        }
+        return acceptCount;
     }
 
     void MetropolisContainer::doStep(mt19937_64& seed)
     {
-        doStep(seed, delta);
+        instanton.doStep(seed);
+        MetropolisContainer::doStep(seed, delta);
     }
     
     void MetropolisContainer::writeInfosToFile()
     {
+        // create files with first output
+        if (!fAcc.f.is_open())
+        {
+            fAcc.create();
+            fMeanPhiSq.create();
+        }
+
         fAcc.printValueToFile(acceptance);
         fMeanPhiSq.printValueToFile(lattice->meanPhiSq);
     }
+
+    void MetropolisContainer::setTracker(ObservableTracker* t)
+    {
+        tracker = t;
+        instanton.setTracker(t);
+    }
+
+    // Take parameters of next point (diagnostic files get new names)
+    void MetropolisContainer::setParameters(const ParameterContainer& p)
+    {
+        delta = p.deltaMetro;
+        fastMath = FastMath::getAccuracy(p.fastMath);
+        floatSweeps = (p.precision == "float");
+        instanton.setParameters(p);
+        metadynamics.setParameters(p);
+        lattice->bias = metadynamics.enabled() ? &metadynamics : NULL;
+        if (fAcc.f.is_open())
+            fAcc.f.close();
+        fAcc.name = FileName("MetropolisAcc", p.outputDirectory, p);
+        if (fMeanPhiSq.f.is_open())
+            fMeanPhiSq.f.close();
+        fMeanPhiSq.name = FileName("MeanPhiSq", p.outputDirectory, p);
+    }
+
+    void MetropolisContainer::dumpState(ostream& out)
+    {
+        out << delta << " ";
+        instanton.dumpState(out);
+        if (metadynamics.enabled())
+        {
+            out << " ";
+            metadynamics.dumpState(out);
+        }
+    }
+
+    void MetropolisContainer::readState(istream& in)
+    {
+        in >> delta;
+        instanton.readState(in);
+        if (metadynamics.enabled())
+            metadynamics.readState(in);
+    }
+
+    void MetropolisContainer::run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink)
+    {
+        if (floatSweeps)
+            lattice->getAngles(phiFloat);
+        runEquilibration(*this, seed, nSteps, measureEvery, sink);
+        if (floatSweeps)
+            lattice->setAngles(phiFloat);
+    }
+
+    void MetropolisContainer::finishStep()
+    {
+        if (metadynamics.enabled())
+            metadynamics.finishStep();
+        if (tracker && !floatSweeps)
+            tracker->finishStep();
+    }
+
+    void MetropolisContainer::prepareMeasurement()
+    {
+        // float sweeps: observables summed in double from the float angles
+        if (floatSweeps)
+        {
+            lattice->setAngles(phiFloat);
+            if (tracker)
+            {
+                tracker->recompute();
+                tracker->finishStep();
+                return;
+            }
+        }
+        if (tracker)
+            return;
+        lattice->mod2Pi();
+        lattice->computeMeanPhiSq();
+    }
+
+    vector<string> MetropolisContainer::getInfoNames()
+    {
+        if (instanton.enabled())
+            return {"MetropolisAcc", "MeanPhiSq", "InstantonAcc"};
+        return {"MetropolisAcc", "MeanPhiSq"};
+    }
+
+    void MetropolisContainer::appendInfos(vector<double>& values)
+    {
+        values.push_back(acceptance);
+        values.push_back(lattice->meanPhiSq);
+        if (instanton.enabled())
+            values.push_back(instanton.getAcceptance());
+    }
     
 
 } // TopoOsciSim
@@ -4,7 +4,11 @@
 #include <iostream>
 #include <random>
 #include "lattice.hpp"
+#include "observableTracker.hpp"
 #include "latticeEquilibration.hpp"
+#include "fastMath.hpp"
+#include "instanton.hpp"
+#include "metadynamics.hpp"
 
 using namespace std;
 
@@ -19,10 +23,37 @@ namespace TopoOsciSim
         // Pointer to LatticeContainer
         LatticeContainer* lattice;
 
+        // Pointer to ObservableTracker (NULL if observables are not tracked)
+        ObservableTracker* tracker;
+
         // vicinity of old link to look for new one
         double delta;
 
         double acceptance;
+
+        // Accuracy of cos and exp (libm: sequential sweep)
+        FastMath::Accuracy fastMath;
+
+        // Angles of the float sweeps (precision float), the lattice is
+        // only set from them for measurements and at the end of run
+        bool floatSweeps;
+        vector<float> phiFloat;
+
+        // Buffers of the batched sweep: random numbers of all sites,
+        // sites of one class, cos arguments and exp arguments
+        vector<double> randomPhi;
+        vector<double> randomMetro;
+        vector<int> batchSites;
+        vector<double> batchPhiNew;
+        vector<double> batchCos;
+        vector<double> batchExp;
+
+        // Winding insertion proposed after every instantonEvery-th step
+        InstantonContainer instanton;
+
+        // Bias in the smooth charge, set on the lattice if enabled
+        MetadynamicsContainer metadynamics;
+
         FileObs fAcc;
         FileObs fMeanPhiSq;
         
@@ -33,6 +64,9 @@ namespace TopoOsciSim
         */
         MetropolisContainer(LatticeContainer* l, const ParameterContainer& p);
 
+        // Remove bias from lattice
+        ~MetropolisContainer();
+
         /**
            Return ostream for ClusterContainer class
            
@@ -46,7 +80,92 @@ namespace TopoOsciSim
 
         void doStep(mt19937_64& seed);
 
-        void writeInfosToFile();        
+        /**
+           Metropolis update of sites [first, last), the other sites
+           stay fixed
+
+           @param seed    Seed number
+           @param deltaIn Step size
+           @param first   First site
+           @param last    One after last site
+           @return        Number of accepted updates
+        */
+        int doSiteUpdates(mt19937_64& seed, double deltaIn, int first, int last);
+
+        /**
+           Sequential sweep on the float angles with the random numbers
+           of doSiteUpdates, action differences in float
+
+           @param seed    Seed number
+           @param deltaIn Step size
+           @return        Number of accepted updates
+        */
+        int doSweepFloat(mt19937_64& seed, double deltaIn);
+
+        /**
+           Metropolis update of sites [first, last) with vectorized cos
+           and exp: all random numbers are drawn in the order of the
+           sequential sweep, then the sites are updated in classes
+           without neighbours among each other (even and odd offsets,
+           the last site alone if it is a neighbour of the first)
+
+           @param seed    Seed number
+           @param deltaIn Step size
+           @param first   First site
+           @param last    One after last site
+           @return        Number of accepted updates
+        */
+        int doSiteUpdatesBatched(mt19937_64& seed, double deltaIn, int first, int last);
+
+        /**
+           Update the sites of batchSites at the same time
+
+           @param deltaIn Step size
+           @param first   First site of sweep (offset of random numbers)
+           @return        Number of accepted updates
+        */
+        int updateBatch(double deltaIn, int first);
+
+        void writeInfosToFile();
+
+        /**
+           Update lattice through tracker to keep observables up to date
+
+           @param t pointer to ObservableTracker
+        */
+        void setTracker(ObservableTracker* t);
+
+        /**
+           Take parameters of next point on same lattice
+
+           @param p Parameters
+        */
+        void setParameters(const ParameterContainer& p);        
+
+        // Write and read step size delta, instanton state and bias (for checkpoints)
+        void dumpState(ostream& out);
+        void readState(istream& in);
+
+        /**
+           Do nSteps steps and measure after every measureEvery-th step
+
+           @param seed         Seed number
+           @param nSteps       Number of steps
+           @param measureEvery Number of steps between measurements
+           @param sink         Gets measurements and diagnostics (NULL: no measurements)
+        */
+        void run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink);
+
+        // Update tracked observables and bias after each step of run
+        void finishStep();
+
+        // Set lattice mod 2pi and meanPhiSq if observables are not tracked
+        // (float sweeps: lattice and tracked observables from phiFloat)
+        void prepareMeasurement();
+
+        // Names and values of the diagnostics of one step
+        vector<string> getInfoNames();
+        void appendInfos(vector<double>& values);
     };
 
     
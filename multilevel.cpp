@@ -0,0 +1,112 @@
+#include <iostream>
+#include <cmath>
+#include "multilevel.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    MultilevelContainer::MultilevelContainer(LatticeContainer* l, const ParameterContainer& p) :
+        lattice       {l},
+        inner         (l, p),
+        Nsegments     {p.multilevelSegments},
+        segmentLength {0},
+        Nupdates      {p.multilevelUpdates}
+    {
+        // resampled segments stay in the chain, which has no weights
+        if (p.metaHeight > 0.)
+        {
+            cerr << "ERROR: Multilevel correlator does not support metadynamics" << endl;
+            exit(0);
+        }
+        if (lattice->boundary != 'p')
+        {
+            cerr << "ERROR: Multilevel correlator needs periodic boundaries" << endl;
+            exit(0);
+        }
+        if ((Nsegments < 1) || (lattice->xdim % Nsegments != 0) || (lattice->xdim / Nsegments < 2))
+        {
+            cerr << "ERROR: xdim = " << lattice->xdim << " cannot be divided into "
+                 << Nsegments << " segments of at least 2 sites" << endl;
+            exit(0);
+        }
+        segmentLength = lattice->xdim / Nsegments;
+
+        sumPhi.resize(lattice->xdim);
+        sumPhiPhi.resize(Nsegments * (segmentLength+1) * (segmentLength+1));
+        segmentPhi.resize(segmentLength+1);
+    }
+
+    // Resample segments and set multilevel correlator
+    void MultilevelContainer::computeCorr(mt19937_64& seed)
+    {
+        fill(sumPhi.begin(), sumPhi.end(), 0.);
+        fill(sumPhiPhi.begin(), sumPhiPhi.end(), 0.);
+
+        for (int n=0; n<Nupdates; n++)
+        {
+            // interiors of the segments, frozen sites s*segmentLength stay
+            for (int s=0; s<Nsegments; s++)
+                inner.doSiteUpdates(seed, inner.delta, s*segmentLength + 1, (s+1)*segmentLength);
+            accumulate();
+        }
+
+        int xdim = lattice->xdim;
+        for (int j=0; j<xdim; j++)
+        {
+            lattice->corr[j] = 0.;
+            for (int i=0; i<xdim; i++)
+                lattice->corr[j] += getPairAverage(i, lattice->getId(i+j));
+            lattice->corr[j] /= xdim;
+        }
+    }
+
+    // Add wrapped phi of all sites to sums
+    void MultilevelContainer::accumulate()
+    {
+        int xdim = lattice->xdim;
+        int L = segmentLength;
+        vector<double>& phi = segmentPhi;
+
+        for (int s=0; s<Nsegments; s++)
+        {
+            // phi in [-pi, pi] like the dumped configurations
+            for (int b=0; b<=L; b++)
+            {
+                phi[b] = lattice->tslice[(s*L + b) % xdim].phi;
+                phi[b] -= 2*M_PI * round(phi[b] / (2*M_PI));
+            }
+
+            for (int b=0; b<L; b++)
+                sumPhi[s*L + b] += phi[b];
+
+            double* pairs = &sumPhiPhi[s * (L+1) * (L+1)];
+            for (int b=0; b<=L; b++)
+                for (int c=0; c<=L; c++)
+                    pairs[b*(L+1) + c] += phi[b] * phi[c];
+        }
+    }
+
+    // Return estimate of <phi_i phi_k> for fixed frozen sites
+    double MultilevelContainer::getPairAverage(int i, int k)
+    {
+        int xdim = lattice->xdim;
+        int L = segmentLength;
+
+        // closed segments of i (two if i is frozen)
+        int s = i / L;
+        for (int t=0; t<2; t++, s=(s+Nsegments-1) % Nsegments)
+        {
+            int b = (i - s*L + xdim) % xdim;
+            int c = (k - s*L + xdim) % xdim;
+            if ((b <= L) && (c <= L))
+                return sumPhiPhi[(s*(L+1) + b)*(L+1) + c] / Nupdates;
+            if (i % L != 0)
+                break;
+        }
+
+        return sumPhi[i] / Nupdates * sumPhi[k] / Nupdates;
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,82 @@
+#ifndef MULTILEVEL_H
+#define MULTILEVEL_H
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include "parameters.hpp"
+#include "lattice.hpp"
+#include "metropolis.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Multilevel (Luescher-Weisz) estimate of the correlator of
+       computeCorr. The sites k*segmentLength are frozen, the
+       segments between them are independent and resampled
+       Nupdates times. Products of sites in different segments are
+       replaced by products of their sub-averages.
+    */
+    class MultilevelContainer
+    {
+
+    public:
+
+        // Pointer to LatticeContainer
+        LatticeContainer* lattice;
+
+        // Updates segment interiors
+        MetropolisContainer inner;
+
+        int Nsegments;
+        int segmentLength;
+
+        // Number of resamplings of each segment per measurement
+        int Nupdates;
+
+        // Sum of phi (mod 2pi) of each site over resamplings
+        vector<double> sumPhi;
+
+        // Sum of phi*phi of sites (b,c) of closed segment s (including both
+        // frozen ends) at [(s*(segmentLength+1) + b)*(segmentLength+1) + c]
+        vector<double> sumPhiPhi;
+
+        // Wrapped phi of one closed segment (buffer)
+        vector<double> segmentPhi;
+
+        /**
+           Create MultilevelContainer on lattice
+
+           @param l pointer to LatticeContainer (periodic)
+           @param p Parameters (multilevelSegments, multilevelUpdates, deltaMetro)
+        */
+        MultilevelContainer(LatticeContainer* l, const ParameterContainer& p);
+
+        /**
+           Resample segments and set correlator of lattice to the
+           multilevel estimate. The lattice keeps the last resampling.
+
+           @param seed Seed number
+        */
+        void computeCorr(mt19937_64& seed);
+
+        // Add wrapped phi of all sites to sums
+        void accumulate();
+
+        /**
+           Return estimate of <phi_i phi_k> for fixed frozen sites
+
+           @param i Lattice index
+           @param k Lattice index
+           @return  Sub-average of product in same closed segment,
+                    otherwise product of sub-averages
+        */
+        double getPairAverage(int i, int k);
+    };
+
+} // TopoOsciSim
+
+#endif // MULTILEVEL_H
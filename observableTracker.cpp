@@ -0,0 +1,147 @@
+#include <iostream>
+#include "observableTracker.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Create ObservableTracker on lattice
+    ObservableTracker::ObservableTracker(LatticeContainer* l, const ParameterContainer& p) :
+        lattice             {l},
+        action              {0.},
+        q                   {0.},
+        sumPhi              {0.},
+        sumPhiSq            {0.},
+        recomputeInterval   {p.recomputeInterval},
+        stepsSinceRecompute {0}
+    {
+        recompute();
+    }
+
+    // Return ostream for ObservableTracker class
+    ostream& operator<<(ostream& out, const ObservableTracker &t)
+    {
+        out << "S = " << t.action << ", q = " << t.q << ", sum phi = " << t.sumPhi << ", sum phi^2 = " << t.sumPhiSq;
+        return out;
+    }
+
+    // Recompute all observables from the whole lattice
+    void ObservableTracker::recompute()
+    {
+        action = lattice->getAction();
+        lattice->computeQ();
+        q = lattice->q;
+
+        sumPhi = 0.;
+        sumPhiSq = 0.;
+        for (int i=0; i<lattice->xdim; i++)
+        {
+            sumPhi   += lattice->tslice[i].phi;
+            sumPhiSq += lattice->tslice[i].phi * lattice->tslice[i].phi;
+        }
+
+        stepsSinceRecompute = 0;
+    }
+
+    // Set angle of one timestep and update observables
+    void ObservableTracker::setPhi(int xpos, double phiNew)
+    {
+        int before = lattice->tslice[xpos].idBefore;
+        double phiOld = lattice->tslice[xpos].phi;
+
+        // remove both links of xpos (first site of open lattice has no link before)
+        action -= lattice->getActionSummand(xpos);
+        q      -= lattice->getChargeSummand(xpos) / (2*M_PI);
+        if (before >= 0)
+        {
+            action -= lattice->getActionSummand(before);
+            q      -= lattice->getChargeSummand(before) / (2*M_PI);
+        }
+
+        lattice->tslice[xpos].phi = phiNew;
+        lattice->tslice[xpos].mod2Pi();
+        phiNew = lattice->tslice[xpos].phi;
+
+        // add both links of xpos
+        action += lattice->getActionSummand(xpos);
+        q      += lattice->getChargeSummand(xpos) / (2*M_PI);
+        if (before >= 0)
+        {
+            action += lattice->getActionSummand(before);
+            q      += lattice->getChargeSummand(before) / (2*M_PI);
+        }
+
+        sumPhi   += phiNew - phiOld;
+        sumPhiSq += phiNew * phiNew - phiOld * phiOld;
+    }
+
+    // Project all angles in cluster and update observables
+    void ObservableTracker::reflectSegment(int leftBorder, int rightBorder, double angle)
+    {
+        int left  = lattice->getId(leftBorder);
+        int right = lattice->getId(rightBorder);
+        int outside = lattice->tslice[left].idBefore;
+        bool wholeLattice = (rightBorder + 1 - leftBorder >= lattice->xdim);
+
+        // remove boundary links (just one if cluster covers the whole
+        // lattice or starts at the first site of an open lattice)
+        action -= lattice->getActionSummand(right);
+        q      -= lattice->getChargeSummand(right) / (2*M_PI);
+        if (!wholeLattice && (outside >= 0))
+        {
+            action -= lattice->getActionSummand(outside);
+            q      -= lattice->getChargeSummand(outside) / (2*M_PI);
+        }
+
+        // project and track charge of inner links, whose action stays the
+        // same (with open boundaries only links of the bulk have charge)
+        bool open = (lattice->boundary == 'o');
+        int index;
+        double phiOld, phiNew, phiPrevOld=0., phiPrevNew=0.;
+        for (int i=leftBorder; i<=rightBorder; i++)
+        {
+            index = lattice->getId(i);
+            phiOld = lattice->tslice[index].phi;
+            lattice->tslice[index].phi = lattice->tslice[index].getProjectedAngle(angle);
+            lattice->tslice[index].mod2Pi();
+            phiNew = lattice->tslice[index].phi;
+
+            if ((i > leftBorder) && (!open || lattice->isBulkLink(lattice->tslice[index].idBefore)))
+                q += (LatticeContainer::getWrappedDifference(phiNew - phiPrevNew)
+                      - LatticeContainer::getWrappedDifference(phiOld - phiPrevOld)) / (2*M_PI);
+
+            sumPhi   += phiNew - phiOld;
+            sumPhiSq += phiNew * phiNew - phiOld * phiOld;
+
+            phiPrevOld = phiOld;
+            phiPrevNew = phiNew;
+        }
+
+        // add boundary links
+        action += lattice->getActionSummand(right);
+        q      += lattice->getChargeSummand(right) / (2*M_PI);
+        if (!wholeLattice && (outside >= 0))
+        {
+            action += lattice->getActionSummand(outside);
+            q      += lattice->getChargeSummand(outside) / (2*M_PI);
+        }
+    }
+
+    // Set tracked observables on lattice and recompute from time to time
+    void ObservableTracker::finishStep()
+    {
+        stepsSinceRecompute++;
+        if ((recomputeInterval > 0) && (stepsSinceRecompute >= recomputeInterval))
+            recompute();
+
+        lattice->q = q;
+        lattice->meanPhiSq = getMeanPhiSq();
+    }
+
+    double ObservableTracker::getMeanPhiSq()
+    {
+        return sumPhiSq / (double)lattice->xdim;
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,84 @@
+#ifndef OBSERVABLETRACKER_H
+#define OBSERVABLETRACKER_H
+
+#include <iostream>
+#include "parameters.hpp"
+#include "lattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    class ObservableTracker
+    {
+
+    public:
+
+        // Pointer to LatticeContainer
+        LatticeContainer* lattice;
+
+        // Tracked observables
+        double action;
+        double q;
+        double sumPhi;
+        double sumPhiSq;
+
+        // Number of steps between full recomputations (guard against drift)
+        int recomputeInterval;
+        int stepsSinceRecompute;
+
+        /**
+           Create ObservableTracker on lattice
+
+           @param l pointer to LatticeContainer
+           @param p Parameters (recomputeInterval)
+        */
+        ObservableTracker(LatticeContainer* l, const ParameterContainer& p);
+
+        /**
+           Return ostream for ObservableTracker class
+
+           @param out Ostream where output goes
+           @param t   This class
+           @return    Ostream including t
+        */
+        friend ostream& operator<<(ostream& out, const ObservableTracker &t);
+
+        /**
+           Recompute all observables from the whole lattice
+        */
+        void recompute();
+
+        /**
+           Set angle of one timestep (mod 2pi) and update observables
+           in O(1)
+
+           @param xpos   Lattice index
+           @param phiNew New angle
+        */
+        void setPhi(int xpos, double phiNew);
+
+        /**
+           Project all angles in [leftBorder, rightBorder] on angle
+           (mod 2pi) and update observables. The action only changes
+           at the cluster boundary.
+
+           @param leftBorder  Left border of cluster (can be < 0)
+           @param rightBorder Right border of cluster (can be >= xdim)
+           @param angle       Projection angle
+        */
+        void reflectSegment(int leftBorder, int rightBorder, double angle);
+
+        /**
+           Set tracked q and meanPhiSq on lattice and recompute all
+           observables every recomputeInterval steps
+        */
+        void finishStep();
+
+        double getMeanPhiSq();
+    };
+
+} // TopoOsciSim
+
+#endif // OBSERVABLETRACKER_H
@@ -16,6 +16,7 @@ namespace TopoOsciSim
         theta   { 0.  },
         a         { 1.  },
         xdim      { 4   },
+        dim       { 1   },
         Nsteps    { 10000},
         NPermutationSets {1},
         Nsym      { -1   },
@@ -26,7 +27,47 @@ namespace TopoOsciSim
         equilibrationAlgorithm{ "cluster" },
         deltaMetro{ 0.5  },
         fileId    { 0    },
-        verbosity { 10   }  {}
+        verbosity { 10   },
+        Nthreads  { 0    },
+        recomputeInterval { 1000 },
+        profileTime { 10. },
+        checkpointInterval { 0 },
+        resume    { 0    },
+        cacheDirectory { "" },
+        Nrethermal { 10000 },
+        sweepFile { "" },
+        multilevelSegments { 4 },
+        multilevelUpdates { 100 },
+        improvedEstimators { 0 },
+        precision { "double" },
+        fastMath   { "off" },
+        instantonEvery { 0 },
+        metaHeight { 0. },
+        metaWidth  { 0.1 },
+        metaRange  { 3. },
+        metaBuildup { 10000 },
+        boundary   { "periodic" },
+        bulkMargin { -1 },
+        analysisThreads { 0 },
+        pipelineSlots { 64 },
+        exportInfos { "" },
+        derived    { "chi=<Q^2>/xdim" },
+        resampling { "bootstrap" },
+        Nbootstrap { 1000 },
+        blockSize  { 0 },
+        budget     { 0. },
+        targetError { 0. },
+        budgetObservable { "Q2" },
+        pilotSteps { 10000 },
+        extrapolationPower { 1. },
+        reweightMin { 0. },
+        reweightMax { 0. },
+        reweightPoints { 50 },
+        reweightBlocks { 20 },
+        smoothing  { "flow" },
+        flowTimes  { "1,2,4" },
+        flowStep   { 0.05 },
+        smoothingBatch { 64 }  {}
     
     // Return ostream for ParameterContainer class
     ostream& operator<<(ostream& out, const ParameterContainer& p)
@@ -36,6 +77,7 @@ namespace TopoOsciSim
         out << "\t theta        = " << p.theta << endl;
         out << "\t a            = " << p.a << endl;
         out << "\t xdim         = " << p.xdim << endl;
+        out << "\t dim          = " << p.dim << endl;
         out << "\t Nsteps       = " << p.Nsteps << endl;    
         out << "\t NPermutationSets = " << p.NPermutationSets << endl;    
         out << "\t Nsym         = " << p.Nsym << endl;
@@ -47,6 +89,46 @@ namespace TopoOsciSim
         out << "\t outputDirectory = " << p.outputDirectory << endl;    
         out << "\t fileId       = " << p.fileId << endl;
         out << "\t verbosity    = " << p.verbosity << endl;
+        out << "\t Nthreads     = " << p.Nthreads << endl;
+        out << "\t recomputeInterval = " << p.recomputeInterval << endl;
+        out << "\t profileTime  = " << p.profileTime << endl;
+        out << "\t checkpointInterval = " << p.checkpointInterval << endl;
+        out << "\t resume       = " << p.resume << endl;
+        out << "\t cacheDirectory = " << p.cacheDirectory << endl;
+        out << "\t Nrethermal   = " << p.Nrethermal << endl;
+        out << "\t sweepFile    = " << p.sweepFile << endl;
+        out << "\t multilevelSegments = " << p.multilevelSegments << endl;
+        out << "\t multilevelUpdates  = " << p.multilevelUpdates << endl;
+        out << "\t improvedEstimators = " << p.improvedEstimators << endl;
+        out << "\t precision    = " << p.precision << endl;
+        out << "\t fastMath     = " << p.fastMath << endl;
+        out << "\t instantonEvery = " << p.instantonEvery << endl;
+        out << "\t metaHeight   = " << p.metaHeight << endl;
+        out << "\t metaWidth    = " << p.metaWidth << endl;
+        out << "\t metaRange    = " << p.metaRange << endl;
+        out << "\t metaBuildup  = " << p.metaBuildup << endl;
+        out << "\t boundary     = " << p.boundary << endl;
+        out << "\t bulkMargin   = " << p.bulkMargin << endl;
+        out << "\t analysisThreads = " << p.analysisThreads << endl;
+        out << "\t pipelineSlots = " << p.pipelineSlots << endl;
+        out << "\t exportInfos  = " << p.exportInfos << endl;
+        out << "\t derived      = " << p.derived << endl;
+        out << "\t resampling   = " << p.resampling << endl;
+        out << "\t Nbootstrap   = " << p.Nbootstrap << endl;
+        out << "\t blockSize    = " << p.blockSize << endl;
+        out << "\t budget       = " << p.budget << endl;
+        out << "\t targetError  = " << p.targetError << endl;
+        out << "\t budgetObservable = " << p.budgetObservable << endl;
+        out << "\t pilotSteps   = " << p.pilotSteps << endl;
+        out << "\t extrapolationPower = " << p.extrapolationPower << endl;
+        out << "\t reweightMin  = " << p.reweightMin << endl;
+        out << "\t reweightMax  = " << p.reweightMax << endl;
+        out << "\t reweightPoints = " << p.reweightPoints << endl;
+        out << "\t reweightBlocks = " << p.reweightBlocks << endl;
+        out << "\t smoothing    = " << p.smoothing << endl;
+        out << "\t flowTimes    = " << p.flowTimes << endl;
+        out << "\t flowStep     = " << p.flowStep << endl;
+        out << "\t smoothingBatch = " << p.smoothingBatch << endl;
         
         return out;        
     }
@@ -58,6 +140,7 @@ namespace TopoOsciSim
                  (theta    == p2.theta   ) &&
                  (a          == p2.a         ) &&
                  (xdim       == p2.xdim      ) &&
+                 (dim        == p2.dim       ) &&
                  (Nsteps     == p2.Nsteps    ) &&
                  (NPermutationSets == p2.NPermutationSets) &&
                  (Nsym       == p2.Nsym      ) &&
@@ -68,7 +151,47 @@ namespace TopoOsciSim
                  (equilibrationAlgorithm == p2.equilibrationAlgorithm) &&
                  (deltaMetro == p2.deltaMetro) &&
                  (fileId   == p2.fileId  ) &&
-                 (verbosity  == p2.verbosity )
+                 (verbosity  == p2.verbosity ) &&
+                 (Nthreads   == p2.Nthreads  ) &&
+                 (recomputeInterval == p2.recomputeInterval) &&
+                 (profileTime == p2.profileTime) &&
+                 (checkpointInterval == p2.checkpointInterval) &&
+                 (resume     == p2.resume    ) &&
+                 (cacheDirectory == p2.cacheDirectory) &&
+                 (Nrethermal == p2.Nrethermal) &&
+                 (sweepFile  == p2.sweepFile ) &&
+                 (multilevelSegments == p2.multilevelSegments) &&
+                 (multilevelUpdates == p2.multilevelUpdates) &&
+                 (improvedEstimators == p2.improvedEstimators) &&
+                 (precision == p2.precision) &&
+                 (fastMath   == p2.fastMath  ) &&
+                 (instantonEvery == p2.instantonEvery) &&
+                 (metaHeight == p2.metaHeight) &&
+                 (metaWidth  == p2.metaWidth ) &&
+                 (metaRange  == p2.metaRange ) &&
+                 (metaBuildup == p2.metaBuildup) &&
+                 (boundary   == p2.boundary  ) &&
+                 (bulkMargin == p2.bulkMargin) &&
+                 (analysisThreads == p2.analysisThreads) &&
+                 (pipelineSlots == p2.pipelineSlots) &&
+                 (exportInfos == p2.exportInfos) &&
+                 (derived    == p2.derived   ) &&
+                 (resampling == p2.resampling) &&
+                 (Nbootstrap == p2.Nbootstrap) &&
+                 (blockSize  == p2.blockSize ) &&
+                 (budget     == p2.budget    ) &&
+                 (targetError == p2.targetError) &&
+                 (budgetObservable == p2.budgetObservable) &&
+                 (pilotSteps == p2.pilotSteps) &&
+                 (extrapolationPower == p2.extrapolationPower) &&
+                 (reweightMin == p2.reweightMin) &&
+                 (reweightMax == p2.reweightMax) &&
+                 (reweightPoints == p2.reweightPoints) &&
+                 (reweightBlocks == p2.reweightBlocks) &&
+                 (smoothing  == p2.smoothing ) &&
+                 (flowTimes  == p2.flowTimes ) &&
+                 (flowStep   == p2.flowStep  ) &&
+                 (smoothingBatch == p2.smoothingBatch)
                );        
     }
     
@@ -84,6 +207,7 @@ namespace TopoOsciSim
         cout << "\t --theta    <double> # Set complex action" << endl;
         cout << "\t --a          <double> # Set lattice spacing" << endl;
         cout << "\t --xdim       <int>    # Set number of lattice points" << endl;
+        cout << "\t --dim        <int>    # Set number of lattice dimensions" << endl;
         cout << "\t --Nsteps     <int>    # Set number of repetitions" << endl;
         cout << "\t --NPermutationSets<int> # Set number of different permutations" << endl;
         cout << "\t --Nsym       <int>    # Set number of symmetrizations" << endl;
@@ -94,6 +218,46 @@ namespace TopoOsciSim
         cout << "\t --configDirectory <string> # Choose path configuration folder for in- and output" << endl;
         cout << "\t --outputDirectory <string> # Choose path output folder for in- and output" << endl;
         cout << "\t --fileId   <int>    # Choose number of created configuration to use" << endl;
+        cout << "\t --Nthreads   <int>    # Set number of threads (0: all cores)" << endl;
+        cout << "\t --recomputeInterval <int> # Set number of steps between full recomputations of tracked observables" << endl;
+        cout << "\t --profileTime <double> # Set wall-clock seconds per algorithm for profileAlgorithms" << endl;
+        cout << "\t --checkpointInterval <int> # Set number of steps between checkpoints (0: none)" << endl;
+        cout << "\t --resume     <int>    # Continue run from its checkpoint (1) or start new run (0)" << endl;
+        cout << "\t --cacheDirectory <string> # Choose folder of thermalized lattices (warm start)" << endl;
+        cout << "\t --Nrethermal <int>    # Set number of thermalization steps when starting from cached lattice" << endl;
+        cout << "\t --sweepFile  <string> # Choose file with parameter points for sweepConfigs" << endl;
+        cout << "\t --multilevelSegments <int> # Set number of segments of multilevel correlator" << endl;
+        cout << "\t --multilevelUpdates <int> # Set number of resamplings of segments per measurement" << endl;
+        cout << "\t --improvedEstimators <int> # Write cluster-improved estimators (1), with correlator (2) or not (0)" << endl;
+        cout << "\t --precision  <string> # Store angles and configurations as double or float" << endl;
+        cout << "\t --fastMath   <string> # Use vectorized cos and exp in updates: off, double or float accuracy" << endl;
+        cout << "\t --instantonEvery <int> # Set number of steps between instanton moves (0: none)" << endl;
+        cout << "\t --metaHeight <double> # Set height of metadynamics Gaussians in smooth charge (0: no bias)" << endl;
+        cout << "\t --metaWidth  <double> # Set width of metadynamics Gaussians" << endl;
+        cout << "\t --metaRange  <double> # Set range [-metaRange, metaRange] of metadynamics bias grid" << endl;
+        cout << "\t --metaBuildup <int>   # Set number of steps with deposition before the bias is frozen" << endl;
+        cout << "\t --boundary   <string> # Choose periodic or open boundary conditions" << endl;
+        cout << "\t --bulkMargin <int>    # Set number of sites at each open end that are not measured (-1: xdim/4)" << endl;
+        cout << "\t --analysisThreads <int> # Set number of threads computing Q, S, Plaq and Corr during createConfigs (0: none)" << endl;
+        cout << "\t --pipelineSlots <int> # Set number of configurations buffered for the analysis threads" << endl;
+        cout << "\t --exportInfos <string> # Set diagnostics exported by exportNpy (comma separated, e.g. ClusterSize,MeanPhiSq)" << endl;
+        cout << "\t --derived    <string> # Set derived quantities of resample, e.g. chi=<Q^2>/xdim;meff=log(<Corr[t]>/<Corr[t+1]>)" << endl;
+        cout << "\t --resampling <string> # Choose bootstrap or jackknife" << endl;
+        cout << "\t --Nbootstrap <int>   # Set number of bootstrap samples" << endl;
+        cout << "\t --blockSize  <int>   # Set configurations per block (0: 10 times the autocorrelation time)" << endl;
+        cout << "\t --budget     <double> # Set cpu seconds of budgetConfigs for all points" << endl;
+        cout << "\t --targetError <double> # Set error of the observable to reach at each point (0: none)" << endl;
+        cout << "\t --budgetObservable <string> # Choose observable of budgetConfigs: Q2 or S" << endl;
+        cout << "\t --pilotSteps <int>   # Set steps of the pilot chains of budgetConfigs" << endl;
+        cout << "\t --extrapolationPower <double> # Set power of a in the extrapolation c0 + c1 a^power" << endl;
+        cout << "\t --reweightMin <double> # Set smallest I/a of reweight (0: smallest I/a of the ensembles)" << endl;
+        cout << "\t --reweightMax <double> # Set largest I/a of reweight (0: largest I/a of the ensembles)" << endl;
+        cout << "\t --reweightPoints <int> # Set number of values of I/a of reweight" << endl;
+        cout << "\t --reweightBlocks <int> # Set jackknife blocks per ensemble of reweight (0: no errors)" << endl;
+        cout << "\t --smoothing  <string> # Choose smoothing of computeFlow_MC: flow or cooling" << endl;
+        cout << "\t --flowTimes  <string> # Set flow times (cooling: sweeps) of measurements, e.g. 1,2,4" << endl;
+        cout << "\t --flowStep   <double> # Set step of the flow integration" << endl;
+        cout << "\t --smoothingBatch <int> # Set configurations smoothed at once" << endl;
         cout << endl;   
     }
 
@@ -242,6 +406,11 @@ namespace TopoOsciSim
             xdim = stoi(value);            
         }
 
+        else if ( name == "dim")
+        {
+            dim = stoi(value);            
+        }
+
         else if ( name == "a")
         {
             a = stof(value);            
@@ -302,6 +471,296 @@ namespace TopoOsciSim
             verbosity = stoi(value);
         }        
 
+        else if (name == "Nthreads")
+        {        
+            Nthreads = stoi(value);
+        }        
+
+        else if (name == "recomputeInterval")
+        {        
+            recomputeInterval = stoi(value);
+        }        
+
+        else if (name == "profileTime")
+        {        
+            profileTime = stod(value);
+        }        
+
+        else if (name == "checkpointInterval")
+        {        
+            checkpointInterval = stoi(value);
+        }        
+
+        else if (name == "resume")
+        {        
+            resume = stoi(value);
+        }        
+
+        else if (name == "cacheDirectory")
+        {
+            cacheDirectory = value;
+        }
+
+        else if (name == "Nrethermal")
+        {        
+            Nrethermal = stoi(value);
+        }        
+
+        else if (name == "sweepFile")
+        {
+            sweepFile = value;
+        }
+
+        else if (name == "multilevelSegments")
+        {        
+            multilevelSegments = stoi(value);
+        }        
+
+        else if (name == "multilevelUpdates")
+        {        
+            multilevelUpdates = stoi(value);
+        }        
+
+        else if (name == "improvedEstimators")
+        {        
+            improvedEstimators = stoi(value);
+            if ((improvedEstimators < 0) || (improvedEstimators > 2))
+            {
+                cerr << "ERROR: improvedEstimators has to be 0, 1 or 2" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "precision")
+        {        
+            if ((value != "double") && (value != "float"))
+            {
+                cerr << "ERROR: Unknown precision " << value << endl;
+                exit(0);
+            }
+            precision = value;
+        }        
+
+        else if (name == "fastMath")
+        {        
+            if ((value != "off") && (value != "double") && (value != "float"))
+            {
+                cerr << "ERROR: Unknown fastMath " << value << endl;
+                exit(0);
+            }
+            fastMath = value;
+        }        
+
+        else if (name == "instantonEvery")
+        {        
+            instantonEvery = stoi(value);
+        }        
+
+        else if (name == "metaHeight")
+        {        
+            metaHeight = stod(value);
+        }        
+
+        else if (name == "metaWidth")
+        {        
+            metaWidth = stod(value);
+            if (metaWidth <= 0.)
+            {
+                cerr << "ERROR: metaWidth has to be positive" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "metaRange")
+        {        
+            metaRange = stod(value);
+        }        
+
+        else if (name == "metaBuildup")
+        {        
+            metaBuildup = stoi(value);
+        }        
+
+        else if (name == "boundary")
+        {        
+            if ((value != "periodic") && (value != "open"))
+            {
+                cerr << "ERROR: Unknown boundary " << value << endl;
+                exit(0);
+            }
+            boundary = value;
+        }        
+
+        else if (name == "bulkMargin")
+        {        
+            bulkMargin = stoi(value);
+        }        
+
+        else if (name == "analysisThreads")
+        {        
+            analysisThreads = stoi(value);
+        }        
+
+        else if (name == "pipelineSlots")
+        {        
+            pipelineSlots = stoi(value);
+            if (pipelineSlots < 1)
+            {
+                cerr << "ERROR: pipelineSlots has to be positive" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "exportInfos")
+        {        
+            exportInfos = value;
+        }        
+
+        else if (name == "derived")
+        {        
+            derived = value;
+        }        
+
+        else if (name == "resampling")
+        {        
+            if ((value != "bootstrap") && (value != "jackknife"))
+            {
+                cerr << "ERROR: Unknown resampling " << value << endl;
+                exit(0);
+            }
+            resampling = value;
+        }        
+
+        else if (name == "Nbootstrap")
+        {        
+            Nbootstrap = stoi(value);
+            if (Nbootstrap < 2)
+            {
+                cerr << "ERROR: Nbootstrap has to be at least 2" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "blockSize")
+        {        
+            blockSize = stoi(value);
+        }        
+
+        else if (name == "budget")
+        {        
+            budget = stod(value);
+        }        
+
+        else if (name == "targetError")
+        {        
+            targetError = stod(value);
+        }        
+
+        else if (name == "budgetObservable")
+        {        
+            if ((value != "Q2") && (value != "S"))
+            {
+                cerr << "ERROR: Unknown budgetObservable " << value << endl;
+                exit(0);
+            }
+            budgetObservable = value;
+        }        
+
+        else if (name == "pilotSteps")
+        {        
+            pilotSteps = stoi(value);
+            if (pilotSteps < 2)
+            {
+                cerr << "ERROR: pilotSteps has to be at least 2" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "extrapolationPower")
+        {        
+            extrapolationPower = stod(value);
+            if (extrapolationPower <= 0.)
+            {
+                cerr << "ERROR: extrapolationPower has to be positive" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "reweightMin")
+        {        
+            reweightMin = stod(value);
+            if (reweightMin < 0.)
+            {
+                cerr << "ERROR: reweightMin has to be positive" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "reweightMax")
+        {        
+            reweightMax = stod(value);
+            if (reweightMax < 0.)
+            {
+                cerr << "ERROR: reweightMax has to be positive" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "reweightPoints")
+        {        
+            reweightPoints = stoi(value);
+            if (reweightPoints < 1)
+            {
+                cerr << "ERROR: reweightPoints has to be at least 1" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "reweightBlocks")
+        {        
+            reweightBlocks = stoi(value);
+            if ((reweightBlocks < 0) || (reweightBlocks == 1))
+            {
+                cerr << "ERROR: reweightBlocks has to be 0 or at least 2" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "smoothing")
+        {        
+            smoothing = value;
+            if ((smoothing != "flow") && (smoothing != "cooling"))
+            {
+                cerr << "ERROR: smoothing has to be flow or cooling" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "flowTimes")
+        {        
+            flowTimes = value;
+        }        
+
+        else if (name == "flowStep")
+        {        
+            flowStep = stod(value);
+            if (flowStep <= 0.)
+            {
+                cerr << "ERROR: flowStep has to be positive" << endl;
+                exit(0);
+            }
+        }        
+
+        else if (name == "smoothingBatch")
+        {        
+            smoothingBatch = stoi(value);
+            if (smoothingBatch < 1)
+            {
+                cerr << "ERROR: smoothingBatch has to be at least 1" << endl;
+                exit(0);
+            }
+        }        
+
         
     }
     
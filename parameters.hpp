@@ -26,6 +26,9 @@ namespace TopoOsciSim
         // Number of lattice points (in x direction)
         int xdim;
 
+        // Number of lattice dimensions (XY lattice if > 1)
+        int dim;
+
         // Number of simulation steps (MC or Symm)
         int Nsteps;
         int NPermutationSets;
@@ -55,6 +58,106 @@ namespace TopoOsciSim
         // How verbose should the output be
         int verbosity;
 
+        // Number of threads to use (0: all available cores)
+        int Nthreads;
+
+        // Number of steps between full recomputations of tracked observables
+        int recomputeInterval;
+
+        // Wall-clock budget per algorithm of the efficiency profiler (seconds)
+        double profileTime;
+
+        // Number of steps between checkpoints (0: no checkpoints)
+        int checkpointInterval;
+
+        // Continue run from its checkpoint (0: new run)
+        int resume;
+
+        // Directory of thermalized lattices (empty: no cache)
+        string cacheDirectory;
+
+        // Thermalization steps when starting from a cached lattice
+        int Nrethermal;
+
+        // File with parameter points of sweepConfigs
+        string sweepFile;
+
+        // Multilevel correlator: number of segments and resamplings
+        int multilevelSegments;
+        int multilevelUpdates;
+
+        // Write cluster-improved estimators as diagnostics (1), also the
+        // O(cluster size^2) correlator (2) or not (0)
+        int improvedEstimators;
+
+        // Scalar type of the angles of Metropolis and cluster sweeps and
+        // of the stored configurations (double or float)
+        string precision;
+
+        // Vectorized cos and exp in Metropolis and cluster updates:
+        // off (libm), double (full accuracy) or float (1E-7 relative)
+        string fastMath;
+
+        // Steps between instanton (winding insertion) moves, 0: none
+        int instantonEvery;
+
+        // Metadynamics bias in the smooth charge: height (0: no bias)
+        // and width of the Gaussians, range of the bias grid and number
+        // of build-up steps (bias is frozen afterwards)
+        double metaHeight;
+        double metaWidth;
+        double metaRange;
+        int metaBuildup;
+
+        // Boundary conditions of the ring: periodic or open
+        string boundary;
+
+        // Sites at each end that are not measured with open boundaries
+        // (-1: xdim/4)
+        int bulkMargin;
+
+        // Threads analysing the configurations of createConfigs next to
+        // the Markov chain (0: no analysis) and slots of their ring buffer
+        int analysisThreads;
+        int pipelineSlots;
+
+        // Diagnostic files exported by exportNpy (comma separated types,
+        // e.g. ClusterSize,MeanPhiSq)
+        string exportInfos;
+
+        // Derived quantities of resample (name=expression, separated by
+        // ;), bootstrap or jackknife, bootstrap samples and
+        // configurations per block (0: from autocorrelation time)
+        string derived;
+        string resampling;
+        int Nbootstrap;
+        int blockSize;
+
+        // cpu seconds of budgetConfigs, target error of the observable
+        // (Q2 or S) at each point, steps of the pilot chains and power
+        // of a in the extrapolation c0 + c1 a^power
+        double budget;
+        double targetError;
+        string budgetObservable;
+        int pilotSteps;
+        double extrapolationPower;
+
+        // Range of I/a and number of points of the multi-ensemble
+        // reweighting (0, 0: range of the ensembles) and jackknife
+        // blocks per ensemble (0: no errors)
+        double reweightMin;
+        double reweightMax;
+        int reweightPoints;
+        int reweightBlocks;
+
+        // Smoothing of computeFlow_MC (flow or cooling), flow times
+        // (cooling: sweeps) of the measurements (comma separated),
+        // step of the flow integration and configurations per batch
+        string smoothing;
+        string flowTimes;
+        double flowStep;
+        int smoothingBatch;
+
         // Create paramter container
         ParameterContainer();
 
@@ -0,0 +1,193 @@
+#include <iostream>
+#include "pipeline.hpp"
+#include "fixedLattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Create files and start threads
+    PipelineSink::PipelineSink(MeasurementSink* n, LatticeContainer* l, const ParameterContainer& p, long firstIndexIn, bool append) :
+        next       {n},
+        lattice    {l},
+        Nslots     {p.pipelineSlots},
+        slots      (p.pipelineSlots),
+        Npushed    {0},
+        Nproduced  {0},
+        nextTicket {0},
+        Nwritten   {0},
+        closed     {false},
+        Nidle      {0},
+        firstIndex {firstIndexIn}
+    {
+        int xdim = lattice->xdim;
+        for (int k=0; k<Nslots; k++)
+        {
+            slots[k].sequence.store(3L * k);
+            slots[k].phi.assign(xdim, 0.);
+            slots[k].results.assign(3 + xdim, 0.);
+        }
+
+        const char* types[] = {"Q", "S", "Plaq", "Corr", "V"};
+        int Ntypes = lattice->biasConfigs ? 5 : 4;
+        for (int c=0; c<Ntypes; c++)
+        {
+            files.push_back(new FileObs(types[c], p));
+            if (append)
+                files.back()->append();
+            else
+                files.back()->create();
+        }
+
+        for (int w=0; w<p.analysisThreads; w++)
+            workerLattices.push_back(new LatticeContainer(*lattice));
+        for (int w=0; w<p.analysisThreads; w++)
+            workers.push_back(thread(&PipelineSink::runWorker, this, w));
+        writer = thread(&PipelineSink::runWriter, this);
+    }
+
+    PipelineSink::~PipelineSink()
+    {
+        finish();
+        for (unsigned int w=0; w<workerLattices.size(); w++)
+            delete workerLattices[w];
+        for (unsigned int c=0; c<files.size(); c++)
+            delete files[c];
+    }
+
+    // Pass on and push copy of configuration into next free slot
+    void PipelineSink::measure(int step)
+    {
+        if (next)
+            next->measure(step);
+
+        long ticket = Npushed;
+        PipelineSlot& slot = slots[ticket % Nslots];
+
+        // backpressure: wait until writer has freed the slot
+        waitFor(ticket, 0);
+
+        slot.index = firstIndex + ticket;
+        for (int i=0; i<lattice->xdim; i++)
+            slot.phi[i] = lattice->tslice[i].phi;
+        slot.biasWeight = lattice->biasWeight;
+
+        slot.sequence.store(3*ticket + 1, memory_order_release);
+        Npushed++;
+        Nproduced.store(Npushed, memory_order_release);
+        wakeIdle();
+    }
+
+    void PipelineSink::processInfos(const InfoBlock& block)
+    {
+        if (next)
+            next->processInfos(block);
+    }
+
+    // Wait until writer has caught up with the chain
+    void PipelineSink::drain()
+    {
+        waitUntil([this]() { return Nwritten.load(memory_order_acquire) >= Npushed; });
+        for (unsigned int c=0; c<files.size(); c++)
+            files[c]->f.flush();
+    }
+
+    // Close pipeline, the threads finish the pushed configurations
+    void PipelineSink::finish()
+    {
+        if (!writer.joinable())
+            return;
+        closed.store(true, memory_order_release);
+        wakeIdle();
+        for (unsigned int w=0; w<workers.size(); w++)
+            workers[w].join();
+        writer.join();
+        for (unsigned int c=0; c<files.size(); c++)
+            files[c]->f.flush();
+    }
+
+    // Wait until slot of ticket reaches state
+    bool PipelineSink::waitFor(long ticket, int state)
+    {
+        PipelineSlot& slot = slots[ticket % Nslots];
+        long sequence = 3*ticket + state;
+        bool reached = false;
+        waitUntil([&]()
+                  {
+                      reached = (slot.sequence.load(memory_order_acquire) == sequence);
+                      // only the chain pushes, it never waits for a closed pipeline
+                      return reached || ((state > 0) && closed.load(memory_order_acquire)
+                                         && (ticket >= Nproduced.load(memory_order_acquire)));
+                  });
+        return reached;
+    }
+
+    // Notify only if a thread sleeps (no lock in the common case)
+    void PipelineSink::wakeIdle()
+    {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (Nidle.load(memory_order_relaxed) > 0)
+        {
+            lock_guard<mutex> lock(idleMutex);
+            idle.notify_all();
+        }
+    }
+
+    // Analyse slots of next tickets (any order)
+    void PipelineSink::runWorker(int id)
+    {
+        LatticeContainer& l = *workerLattices[id];
+        while (true)
+        {
+            long ticket = nextTicket.fetch_add(1, memory_order_relaxed);
+            if (!waitFor(ticket, 1))
+                return;
+            PipelineSlot& slot = slots[ticket % Nslots];
+            analyse(l, slot);
+            slot.sequence.store(3*ticket + 2, memory_order_release);
+            wakeIdle();
+        }
+    }
+
+    // Write slots in order of the chain and free them
+    void PipelineSink::runWriter()
+    {
+        for (long ticket=0; ; ticket++)
+        {
+            if (!waitFor(ticket, 2))
+                return;
+            PipelineSlot& slot = slots[ticket % Nslots];
+
+            files[0]->f << slot.results[0] << '\n';
+            files[1]->f << slot.results[1] << '\n';
+            files[2]->f << slot.results[2] << '\n';
+            for (int j=0; j<lattice->xdim; j++)
+                files[3]->f << slot.index << "\t" << j << "\t" << slot.results[3+j] << '\n';
+            if (files.size() > 4)
+                files[4]->f << slot.biasWeight << '\n';
+
+            slot.sequence.store(3*(ticket + Nslots), memory_order_release);
+            Nwritten.store(ticket + 1, memory_order_release);
+            wakeIdle();
+        }
+    }
+
+    // Q, S, plaquette and correlator like the analysis drivers
+    void PipelineSink::analyse(LatticeContainer& l, PipelineSlot& slot)
+    {
+        for (int i=0; i<l.xdim; i++)
+            l.tslice[i].phi = slot.phi[i];
+        l.biasWeight = slot.biasWeight;
+
+        LatticeKernelDispatcher::computeQ(l);
+        slot.results[0] = l.q;
+        slot.results[1] = LatticeKernelDispatcher::getAction(l);
+        slot.results[2] = l.computePlaquette();
+
+        LatticeKernelDispatcher::computeCorr(l);
+        for (int j=0; j<l.xdim; j++)
+            slot.results[3+j] = l.corr[j];
+    }
+
+} // TopoOsciSim
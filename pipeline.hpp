@@ -0,0 +1,182 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "measurementSink.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Preallocated configuration of the ring buffer of PipelineSink
+    class PipelineSlot
+    {
+    public:
+
+        // State for ticket t: 3t free, 3t+1 filled, 3t+2 analysed
+        atomic<long> sequence;
+
+        // Number of measurement (of whole run)
+        long index;
+
+        vector<double> phi;
+        double biasWeight;
+
+        // Q, S, plaquette and correlator (xdim values)
+        vector<double> results;
+
+        PipelineSlot() : sequence {0}, index {0}, biasWeight {0.} {}
+    };
+
+
+    /**
+       Analysis of the measured configurations on other threads. The
+       Markov chain thread copies each configuration into the next
+       slot of a bounded lock-free ring buffer (waits if all slots are
+       in use), analysisThreads workers take the filled slots in any
+       order and compute Q, S, plaquette and correlator, and a writer
+       thread writes the results in the order of the chain and frees
+       the slots. Slots are preallocated, there is no allocation per
+       configuration. A thread that waits for a slot yields a few
+       times, then sleeps on a condition variable, which is only
+       notified while some thread sleeps, so idle workers do not take
+       cores from the chain. All measurements go to the next sink
+       first.
+    */
+    class PipelineSink : public MeasurementSink
+    {
+    public:
+
+        // Sink of configurations and diagnostics (can be NULL)
+        MeasurementSink* next;
+
+        LatticeContainer* lattice;
+
+        // Ring buffer
+        int Nslots;
+        vector<PipelineSlot> slots;
+
+        // Configurations pushed by the chain (only written by it) and
+        // published for the workers
+        long Npushed;
+        atomic<long> Nproduced;
+
+        // Next ticket of a worker and written configurations
+        atomic<long> nextTicket;
+        atomic<long> Nwritten;
+
+        // No more configurations after Nproduced
+        atomic<bool> closed;
+
+        // Sleeping threads and their condition variable
+        atomic<int> Nidle;
+        mutex idleMutex;
+        condition_variable idle;
+
+        // Number of first measurement (resumed run)
+        long firstIndex;
+
+        // Lattice of each worker
+        vector<LatticeContainer*> workerLattices;
+        vector<thread> workers;
+        thread writer;
+
+        // Q, S, Plaq and Corr (like computeCharge_MC and
+        // computeCorrelation_MC), V of metadynamics configurations
+        vector<FileObs*> files;
+
+        /**
+           Create files and start worker and writer threads
+
+           @param n          Next sink (NULL: none)
+           @param l          Lattice of the chain
+           @param p          Parameters (analysisThreads, pipelineSlots)
+           @param firstIndex Number of first measurement
+           @param append     Append to existing files (resumed run)
+        */
+        PipelineSink(MeasurementSink* n, LatticeContainer* l, const ParameterContainer& p, long firstIndex, bool append);
+
+        // Finish pipeline and delete files
+        ~PipelineSink();
+
+        // Pass measurement to next sink and push copy of configuration
+        void measure(int step);
+        void processInfos(const InfoBlock& block);
+
+        // Wait until all pushed configurations are written and flush files
+        void drain();
+
+        // Write all pushed configurations and stop threads
+        void finish();
+
+        /**
+           Analyse filled slots until the pipeline is closed
+
+           @param id Number of worker
+        */
+        void runWorker(int id);
+
+        // Write analysed slots in order until the pipeline is closed
+        void runWriter();
+
+        /**
+           Wait until slot of ticket has state
+
+           @param ticket Ticket
+           @param state  0 free, 1 filled, 2 analysed
+           @return       false if closed before ticket was pushed
+        */
+        bool waitFor(long ticket, int state);
+
+        /**
+           Yield until ready returns true, then sleep until it does
+
+           @param ready Condition of the wait
+        */
+        template<class Ready>
+        void waitUntil(Ready ready);
+
+        // Wake sleeping threads after a change of the ring
+        void wakeIdle();
+
+        /**
+           Compute observables of slot on lattice
+
+           @param l    Lattice of worker
+           @param slot Filled slot
+        */
+        void analyse(LatticeContainer& l, PipelineSlot& slot);
+    };
+
+    // Sleeping thread is counted before the last check of ready, the
+    // fences make sure that it or wakeIdle sees the change
+    template<class Ready>
+    void PipelineSink::waitUntil(Ready ready)
+    {
+        const int maxSpins = 100;
+        for (int spin=0; spin<maxSpins; spin++)
+        {
+            if (ready())
+                return;
+            this_thread::yield();
+        }
+
+        unique_lock<mutex> lock(idleMutex);
+        Nidle.fetch_add(1);
+        atomic_thread_fence(memory_order_seq_cst);
+        idle.wait(lock, ready);
+        Nidle.fetch_sub(1);
+    }
+
+} // TopoOsciSim
+
+#endif // PIPELINE_H
@@ -0,0 +1,51 @@
+/**
+   TopoOsciSim
+   profileAlgorithms.cpp
+   Purpose: Compare the equilibration algorithms by effective independent
+            samples per cpu second and recommend the best one.
+
+   @author Julia Volmer
+   @version 1.0 
+*/
+
+#include <iostream>
+#include <random>
+#include "parameters.hpp"
+#include "algorithmProfiler.hpp"
+ 
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // initialize random generator
+    random_device rd;
+    mt19937_64 generator(rd());
+
+    // define and initialize parameters
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION       " << endl;
+        cout << endl;
+        cout << "     Profile Algorithms  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    TopoOsciSim::AlgorithmProfiler profiler(parameters);
+    profiler.run(generator);
+    profiler.writeToFile();
+
+    // last line can be passed to the other programs by sweep scripts
+    const TopoOsciSim::AlgorithmProfile& best = profiler.getBest();
+    if (parameters.verbosity > 2)
+        cout << "recommended: " << best.getName() << endl;
+    cout << "--equilibrationAlgorithm " << best.equilibrationAlgorithm
+         << " --deltaMetro " << best.deltaMetro << endl;
+}
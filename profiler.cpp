@@ -0,0 +1,119 @@
+#include <iostream>
+#include "file.hpp"
+#include "profiler.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    thread_local Profiler::ThreadData Profiler::local;
+    Profiler::Data Profiler::finished;
+    int Profiler::Nfinished = 0;
+    mutex Profiler::finishedMutex;
+
+    static const char* phaseNames[Profiler::Nphases] =
+        { "none", "thermalization", "production", "observables", "configIO", "observableIO" };
+
+    static const char* counterNames[Profiler::Ncounters] =
+        { "siteUpdates", "accepts", "clusters", "clusterSites", "bytesWritten", "bytesRead" };
+
+    Profiler::Data::Data() :
+        seconds  {},
+        calls    {},
+        counters {}
+    {}
+
+    void Profiler::Data::add(const Data& d)
+    {
+        for (int i=0; i<Nphases; i++)
+        {
+            seconds[i] += d.seconds[i];
+            calls[i] += d.calls[i];
+        }
+        for (int i=0; i<Ncounters; i++)
+            counters[i] += d.counters[i];
+    }
+
+    // Clock of thread starts with its first profiled call
+    Profiler::ThreadData::ThreadData() :
+        current      {none},
+        currentStart {Clock::now()}
+    {}
+
+    // Account running phase and add thread to profile of run
+    Profiler::ThreadData::~ThreadData()
+    {
+        seconds[current] += chrono::duration<double>(Clock::now() - currentStart).count();
+
+        lock_guard<mutex> lock(finishedMutex);
+        finished.add(*this);
+        Nfinished++;
+    }
+
+    // Stop running phase and start phase
+    Profiler::Phase Profiler::enter(Phase phase)
+    {
+        ThreadData& d = local;
+        Clock::time_point now = Clock::now();
+        d.seconds[d.current] += chrono::duration<double>(now - d.currentStart).count();
+
+        Phase parent = d.current;
+        d.current = phase;
+        d.currentStart = now;
+        d.calls[phase]++;
+        return parent;
+    }
+
+    // Stop running phase and continue phase
+    void Profiler::leave(Phase phase)
+    {
+        ThreadData& d = local;
+        Clock::time_point now = Clock::now();
+        d.seconds[d.current] += chrono::duration<double>(now - d.currentStart).count();
+
+        d.current = phase;
+        d.currentStart = now;
+    }
+
+    // Write profile of run as JSON to output directory
+    void Profiler::writeJson(const string& program, const ParameterContainer& p)
+    {
+        // account time of running phase
+        enter(local.current);
+        local.calls[local.current]--;
+
+        // calling thread and ended threads
+        Data total;
+        int Nthreads;
+        {
+            lock_guard<mutex> lock(finishedMutex);
+            total = finished;
+            Nthreads = Nfinished + 1;
+        }
+        total.add(local);
+
+        FileObs fProfile("Profile" + program, p);
+        fProfile.create();
+
+        double totalSeconds = 0.;
+        for (int i=0; i<Nphases; i++)
+            totalSeconds += total.seconds[i];
+
+        fProfile.f << "{" << endl;
+        fProfile.f << "  \"total\": " << totalSeconds << "," << endl;
+        fProfile.f << "  \"threads\": " << Nthreads << "," << endl;
+        fProfile.f << "  \"phases\": {" << endl;
+        for (int i=1; i<Nphases; i++)
+            fProfile.f << "    \"" << phaseNames[i] << "\": {\"seconds\": " << total.seconds[i]
+                       << ", \"calls\": " << total.calls[i] << "}" << ((i+1 < Nphases) ? "," : "") << endl;
+        fProfile.f << "  }," << endl;
+        fProfile.f << "  \"counters\": {" << endl;
+        for (int i=0; i<Ncounters; i++)
+            fProfile.f << "    \"" << counterNames[i] << "\": " << total.counters[i]
+                       << ((i+1 < Ncounters) ? "," : "") << endl;
+        fProfile.f << "  }" << endl;
+        fProfile.f << "}" << endl;
+    }
+
+} // TopoOsciSim
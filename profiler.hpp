@@ -0,0 +1,114 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include "parameters.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Phase timers and hot-path counters. Times are exclusive: a
+       nested phase pauses the enclosing one. Every thread has its own
+       timers and counters (thread_local), which are added to the
+       profile of the run when the thread ends, so worker threads of
+       sweeps and pipelines need no locks on the hot path. writeJson
+       reports the calling thread and all threads that ended before.
+    */
+    class Profiler
+    {
+
+    public:
+
+        enum Phase { none, thermalization, production, observables, configIO, observableIO, Nphases };
+        enum Counter { siteUpdates, accepts, clusters, clusterSites, bytesWritten, bytesRead, Ncounters };
+
+        typedef chrono::steady_clock Clock;
+
+        // Times, calls and counters of one or several threads
+        struct Data
+        {
+            double seconds[Nphases];
+            long calls[Nphases];
+            long counters[Ncounters];
+
+            Data();
+
+            void add(const Data& d);
+        };
+
+        // Profile of one thread, added to finished when the thread ends
+        struct ThreadData : public Data
+        {
+            // Running phase and its start time
+            Phase current;
+            Clock::time_point currentStart;
+
+            ThreadData();
+            ~ThreadData();
+        };
+
+        static thread_local ThreadData local;
+
+        // Sum of ended threads and their number
+        static Data finished;
+        static int Nfinished;
+        static mutex finishedMutex;
+
+        /**
+           Stop running phase and start phase
+
+           @param phase Phase to start
+           @return      Phase that was running
+        */
+        static Phase enter(Phase phase);
+
+        /**
+           Stop running phase and continue phase
+
+           @param phase Phase to continue
+        */
+        static void leave(Phase phase);
+
+        static void count(Counter counter, long n) { local.counters[counter] += n; }
+
+        /**
+           Write profile of run as JSON to output directory (call after
+           worker threads are joined, seconds are summed over threads)
+
+           @param program Name of program (part of file type)
+           @param p       Parameters of run (for file name)
+        */
+        static void writeJson(const string& program, const ParameterContainer& p);
+    };
+
+
+    // Time phase until end of scope
+    class ScopedTimer
+    {
+    public:
+        Profiler::Phase parent;
+
+        ScopedTimer(Profiler::Phase phase) : parent {Profiler::enter(phase)} {}
+        ~ScopedTimer() { Profiler::leave(parent); }
+    };
+
+} // TopoOsciSim
+
+
+// The profiler is only compiled in with -DTOPOOSCI_PROFILE (make PROFILE=1)
+#ifdef TOPOOSCI_PROFILE
+#define PROFILE_SCOPE(phase)     TopoOsciSim::ScopedTimer profileScope(TopoOsciSim::Profiler::phase)
+#define PROFILE_COUNT(counter, n) TopoOsciSim::Profiler::count(TopoOsciSim::Profiler::counter, n)
+#define PROFILE_WRITE(program, p) TopoOsciSim::Profiler::writeJson(program, p)
+#else
+#define PROFILE_SCOPE(phase)
+#define PROFILE_COUNT(counter, n)
+#define PROFILE_WRITE(program, p)
+#endif
+
+#endif // PROFILER_H
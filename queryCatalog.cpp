@@ -0,0 +1,44 @@
+/**
+   TopoOsciSim
+   queryCatalog.cpp
+   Purpose: List the runs of a directory catalog that match a parameter query.
+
+   Usage: queryCatalog.x <directory/> [name=value ...]
+
+   @author Julia Volmer
+   @version 1.0 
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "catalog.hpp"
+ 
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cout << "Usage: " << argv[0] << " <directory/> [name=value ...]" << endl;
+        exit(0);
+    }
+
+    vector<pair<string, string> > constraints;
+    for (int i=2; i<argc; i++)
+    {
+        string constraint = argv[i];
+        size_t pos = constraint.find('=');
+        if (pos == string::npos)
+        {
+            cerr << "ERROR: Query " << constraint << " is not of the form name=value" << endl;
+            exit(0);
+        }
+        constraints.push_back(make_pair(constraint.substr(0, pos), constraint.substr(pos + 1)));
+    }
+
+    TopoOsciSim::RunCatalog catalog(argv[1]);
+    vector<TopoOsciSim::CatalogRecord> records = catalog.find(constraints);
+    for (unsigned int i=0; i<records.size(); i++)
+        cout << records[i] << endl;
+}
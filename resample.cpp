@@ -0,0 +1,61 @@
+/**
+   TopoOsciSim
+   resample.cpp
+   Purpose: Compute bootstrap or jackknife errors and covariance of derived
+            quantities from the observable files of a run
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include "parameters.hpp"
+#include "resampling.hpp"
+
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // initialize random generator
+    random_device rd;
+    mt19937_64 generator(rd());
+
+    // define and initialize parameters
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+    parameters.Nthermal = -1;
+    parameters.Nsym = -1;
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION            " << endl;
+        cout << endl;
+        cout << "     Resampling  --  Derived Quantities       " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    TopoOsciSim::ResamplingContainer resampling(parameters);
+
+    // observables of each configuration
+    vector<double> data;
+    resampling.readStreams(parameters, data);
+    resampling.computeBlockMeans(data);
+    data.clear();
+
+    cout << resampling.Nconfigs << " configurations, " << resampling.Nblocks << " blocks of " << resampling.blockSize;
+    if (parameters.blockSize <= 0)
+        cout << " (tau_int = " << resampling.tauMax << ")";
+    cout << ", " << resampling.means.size() << " means" << endl;
+
+    resampling.resample(generator);
+    cout << resampling.Nsamples << " " << resampling.method << " samples" << endl;
+    cout << resampling;
+    resampling.dumpResults(parameters);
+}
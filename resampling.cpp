@@ -0,0 +1,324 @@
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include "resampling.hpp"
+#include "autocorrelation.hpp"
+#include "file.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Parse derived quantities (separated by ;) and compile entries
+    ResamplingContainer::ResamplingContainer(const ParameterContainer& p) :
+        method    {p.resampling},
+        Nsamples  {p.Nbootstrap},
+        blockSize {p.blockSize},
+        Nthreads  {p.Nthreads},
+        tauMax    {0.5},
+        Nconfigs  {0},
+        Nblocks   {0}
+    {
+        if (Nthreads <= 0)
+            Nthreads = thread::hardware_concurrency();
+        if (Nthreads <= 0)
+            Nthreads = 1;
+
+        stringstream definitions(p.derived);
+        string definition;
+        while (getline(definitions, definition, ';'))
+            if (!definition.empty())
+                quantities.push_back(Expression(definition, p));
+        if (quantities.empty())
+        {
+            cerr << "ERROR: No derived quantities given" << endl;
+            exit(0);
+        }
+
+        for (unsigned int q=0; q<quantities.size(); q++)
+        {
+            if (!quantities[q].dependsOnT())
+            {
+                names.push_back(quantities[q].name);
+                programs.push_back(quantities[q].compile(0, means, streams));
+                continue;
+            }
+            for (int t=0; t<p.xdim/2; t++)
+            {
+                names.push_back(quantities[q].name + "[" + to_string(t) + "]");
+                programs.push_back(quantities[q].compile(t, means, streams));
+            }
+        }
+    }
+
+    ostream& operator<<(ostream& out, const ResamplingContainer& r)
+    {
+        for (unsigned int e=0; e<r.names.size(); e++)
+            out << r.names[e] << " = " << r.values[e] << " +- " << r.errors[e] << endl;
+        return out;
+    }
+
+    // Read needed columns of each observable file
+    void ResamplingContainer::readStreams(const ParameterContainer& p, vector<double>& data)
+    {
+        int Nstreams = streams.size();
+        if (Nstreams == 0)
+        {
+            cerr << "ERROR: Derived quantities use no observables" << endl;
+            exit(0);
+        }
+        vector<vector<double> > columns(Nstreams);
+        vector<bool> done(Nstreams, false);
+
+        for (int k=0; k<Nstreams; k++)
+        {
+            if (done[k])
+                continue;
+
+            // streams of this file by column
+            const string& name = streams[k].name;
+            vector<int> streamOfColumn;
+            for (int l=k; l<Nstreams; l++)
+                if (streams[l].name == name)
+                {
+                    if (streams[l].column >= (int)streamOfColumn.size())
+                        streamOfColumn.resize(streams[l].column + 1, -1);
+                    streamOfColumn[streams[l].column] = l;
+                    done[l] = true;
+                }
+            int Ncolumns = streamOfColumn.size();
+
+            FileObs f(name, p);
+            f.open();
+            if (name == "Corr")
+            {
+                // one line per distance
+                long iConf, firstConf = -1;
+                int j;
+                double value;
+                while (f.f >> iConf >> j >> value)
+                {
+                    if (firstConf < 0)
+                        firstConf = iConf;
+                    if ((j < Ncolumns) && (streamOfColumn[j] >= 0)
+                        && ((long)columns[streamOfColumn[j]].size() == iConf - firstConf))
+                        columns[streamOfColumn[j]].push_back(value);
+                }
+            }
+            else
+            {
+                // one line per configuration
+                string line;
+                while (getline(f.f, line))
+                {
+                    const char* start = line.c_str();
+                    char* end;
+                    for (int c=0; c<Ncolumns; c++)
+                    {
+                        double value = strtod(start, &end);
+                        if (end == start)
+                            break;
+                        start = end;
+                        if (streamOfColumn[c] >= 0)
+                            columns[streamOfColumn[c]].push_back(value);
+                    }
+                }
+            }
+            // end of file is expected
+            f.f.clear();
+
+            for (int c=0; c<Ncolumns; c++)
+                if ((streamOfColumn[c] >= 0) && columns[streamOfColumn[c]].empty())
+                {
+                    cerr << "ERROR: File " << f.name.fullName << " has no column " << c << endl;
+                    exit(0);
+                }
+        }
+
+        // configurations of all files
+        Nconfigs = columns[0].size();
+        for (int k=1; k<Nstreams; k++)
+            if ((int)columns[k].size() != Nconfigs)
+            {
+                cerr << "WARNING: Observable files have different lengths, the first configurations are used" << endl;
+                Nconfigs = min(Nconfigs, (int)columns[k].size());
+            }
+
+        data.assign((long)Nconfigs * Nstreams, 0.);
+        for (int k=0; k<Nstreams; k++)
+            for (int i=0; i<Nconfigs; i++)
+                data[(long)i*Nstreams + k] = columns[k][i];
+    }
+
+    // Means of each configuration, autocorrelation and blocks
+    void ResamplingContainer::computeBlockMeans(const vector<double>& data)
+    {
+        int Nmeans = means.size();
+        vector<double> configMeans((long)Nconfigs * Nmeans);
+
+        vector<thread> workers;
+        for (int w=0; w<Nthreads; w++)
+            workers.push_back(thread(&ResamplingContainer::evaluateMeans, this, cref(data), ref(configMeans),
+                                     (int)((long)Nconfigs * w / Nthreads), (int)((long)Nconfigs * (w+1) / Nthreads)));
+        for (int w=0; w<Nthreads; w++)
+            workers[w].join();
+
+        // tauInt from at most 10^4 bins (cost of the windowing)
+        if (blockSize <= 0)
+        {
+            int binSize = max(1, Nconfigs / 10000);
+            int Nbins = Nconfigs / binSize;
+            vector<double> series(Nbins);
+            tauMax = 0.5;
+            for (int m=0; m<Nmeans; m++)
+            {
+                for (int b=0; b<Nbins; b++)
+                {
+                    series[b] = 0.;
+                    for (int i=b*binSize; i<(b+1)*binSize; i++)
+                        series[b] += configMeans[(long)i*Nmeans + m];
+                    series[b] /= binSize;
+                }
+                AutocorrelationContainer autocorrelation;
+                autocorrelation.analyse(series);
+                // a constant series has no error
+                if (autocorrelation.frozen)
+                    continue;
+
+                // same error of the mean from bins and configurations
+                double variance = 0.;
+                for (int i=0; i<Nbins*binSize; i++)
+                {
+                    double d = configMeans[(long)i*Nmeans + m] - autocorrelation.mean;
+                    variance += d * d;
+                }
+                variance /= Nbins * binSize;
+                tauMax = max(tauMax, binSize * autocorrelation.tauInt * autocorrelation.variance / variance);
+            }
+            blockSize = ceil(10 * tauMax);
+        }
+
+        Nblocks = Nconfigs / blockSize;
+        if (Nblocks < 2)
+        {
+            cerr << "ERROR: " << Nconfigs << " configurations are less than two blocks of " << blockSize << endl;
+            exit(0);
+        }
+        if (Nblocks < 20)
+            cerr << "WARNING: Only " << Nblocks << " blocks of " << blockSize << " configurations" << endl;
+
+        blockMeans.assign((long)Nblocks * Nmeans, 0.);
+        totalMeans.assign(Nmeans, 0.);
+        for (int b=0; b<Nblocks; b++)
+            for (int m=0; m<Nmeans; m++)
+            {
+                double sum = 0.;
+                for (int i=b*blockSize; i<(b+1)*blockSize; i++)
+                    sum += configMeans[(long)i*Nmeans + m];
+                blockMeans[(long)b*Nmeans + m] = sum / blockSize;
+                totalMeans[m] += sum / blockSize / Nblocks;
+            }
+    }
+
+    void ResamplingContainer::evaluateMeans(const vector<double>& data, vector<double>& configMeans, int first, int last)
+    {
+        int Nmeans = means.size();
+        int Nstreams = streams.size();
+        for (int i=first; i<last; i++)
+            for (int m=0; m<Nmeans; m++)
+                configMeans[(long)i*Nmeans + m] = Expression::evaluate(means[m], &data[(long)i*Nstreams]);
+    }
+
+    // Samples on threads and statistics
+    void ResamplingContainer::resample(mt19937_64& seed)
+    {
+        if (method == "jackknife")
+            Nsamples = Nblocks;
+        int Nentries = names.size();
+        samples.assign((long)Nsamples * Nentries, 0.);
+
+        sampleSeeds.resize(Nsamples);
+        for (int s=0; s<Nsamples; s++)
+            sampleSeeds[s] = seed();
+
+        vector<thread> workers;
+        for (int w=0; w<Nthreads; w++)
+            workers.push_back(thread(&ResamplingContainer::computeSamples, this, w, Nthreads));
+        for (int w=0; w<Nthreads; w++)
+            workers[w].join();
+
+        values.resize(Nentries);
+        for (int e=0; e<Nentries; e++)
+            values[e] = Expression::evaluate(programs[e], totalMeans.data());
+
+        vector<double> average(Nentries, 0.);
+        for (int s=0; s<Nsamples; s++)
+            for (int e=0; e<Nentries; e++)
+                average[e] += samples[(long)s*Nentries + e] / Nsamples;
+
+        // jackknife samples scatter (N-1) times less than bootstrap samples
+        double norm = (method == "jackknife") ? (Nsamples - 1.) / Nsamples : 1. / (Nsamples - 1.);
+        covariance.assign(Nentries * Nentries, 0.);
+        for (int s=0; s<Nsamples; s++)
+            for (int e=0; e<Nentries; e++)
+                for (int f=0; f<Nentries; f++)
+                    covariance[e*Nentries + f] += norm * (samples[(long)s*Nentries + e] - average[e])
+                                                       * (samples[(long)s*Nentries + f] - average[f]);
+
+        errors.resize(Nentries);
+        for (int e=0; e<Nentries; e++)
+            errors[e] = sqrt(covariance[e*Nentries + e]);
+    }
+
+    // Means of drawn (bootstrap) or all but one (jackknife) blocks
+    void ResamplingContainer::computeSamples(int first, int stride)
+    {
+        int Nmeans = means.size();
+        int Nentries = names.size();
+        vector<double> sampleMeans(Nmeans);
+
+        for (int s=first; s<Nsamples; s+=stride)
+        {
+            if (method == "jackknife")
+                for (int m=0; m<Nmeans; m++)
+                    sampleMeans[m] = (Nblocks * totalMeans[m] - blockMeans[(long)s*Nmeans + m]) / (Nblocks - 1);
+            else
+            {
+                mt19937_64 generator(sampleSeeds[s]);
+                uniform_int_distribution< > dist_block(0, Nblocks - 1);
+                sampleMeans.assign(Nmeans, 0.);
+                for (int b=0; b<Nblocks; b++)
+                {
+                    const double* block = &blockMeans[(long)dist_block(generator) * Nmeans];
+                    for (int m=0; m<Nmeans; m++)
+                        sampleMeans[m] += block[m];
+                }
+                for (int m=0; m<Nmeans; m++)
+                    sampleMeans[m] /= Nblocks;
+            }
+
+            for (int e=0; e<Nentries; e++)
+                samples[(long)s*Nentries + e] = Expression::evaluate(programs[e], sampleMeans.data());
+        }
+    }
+
+    void ResamplingContainer::dumpResults(const ParameterContainer& p)
+    {
+        int Nentries = names.size();
+
+        FileObs fDerived("Derived", p);
+        fDerived.create();
+        for (int e=0; e<Nentries; e++)
+            fDerived.f << names[e] << "\t" << values[e] << "\t" << errors[e] << endl;
+
+        FileObs fCovariance("Covariance", p);
+        fCovariance.create();
+        for (int e=0; e<Nentries; e++)
+            for (int f=0; f<Nentries; f++)
+                fCovariance.f << covariance[e*Nentries + f] << ((f+1 < Nentries) ? '\t' : '\n');
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,139 @@
+#ifndef RESAMPLING_H
+#define RESAMPLING_H
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include "parameters.hpp"
+#include "expression.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Blocked bootstrap or jackknife errors and covariance of derived
+       quantities (see Expression) of the observable files of a run.
+       The per-configuration expressions of all means are evaluated
+       once and averaged over blocks of blockSize configurations
+       (0: 10 times the largest integrated autocorrelation time), so
+       the blocks are independent. Each bootstrap sample draws Nblocks
+       blocks with replacement, each jackknife sample leaves out one
+       block. Samples are computed on Nthreads threads, each bootstrap
+       sample has its own generator seeded in advance, so the result
+       does not depend on the number of threads.
+    */
+    class ResamplingContainer
+    {
+
+    public:
+
+        // Derived quantities
+        vector<Expression> quantities;
+
+        // Entries (quantities depending on t for t < xdim/2) and their
+        // programs on the means
+        vector<string> names;
+        vector<vector<Instruction> > programs;
+
+        // Programs of the means on the streams and streams
+        vector<vector<Instruction> > means;
+        vector<StreamReference> streams;
+
+        // bootstrap or jackknife
+        string method;
+        int Nsamples;
+        int blockSize;
+        int Nthreads;
+
+        // Largest integrated autocorrelation time of the means
+        double tauMax;
+
+        int Nconfigs;
+        int Nblocks;
+
+        // Means of each block (Nblocks x means) and of all blocks
+        vector<double> blockMeans;
+        vector<double> totalMeans;
+
+        // Value of entries for each sample (Nsamples x entries)
+        vector<double> samples;
+        vector<unsigned long> sampleSeeds;
+
+        // Central values, errors and covariance (entries x entries)
+        vector<double> values;
+        vector<double> errors;
+        vector<double> covariance;
+
+        /**
+           Parse and compile derived quantities
+
+           @param p Parameters (derived, resampling, Nbootstrap, blockSize, Nthreads, xdim)
+        */
+        ResamplingContainer(const ParameterContainer& p);
+
+        /**
+           Return ostream for ResamplingContainer class
+
+           @param out Ostream where output goes
+           @param r   This class
+           @return    Ostream including values and errors
+        */
+        friend ostream& operator<<(ostream& out, const ResamplingContainer& r);
+
+        /**
+           Read streams from observable files of run (Corr: lines iConf
+           j corr, other files: one line per configuration), up to the
+           end of the shortest file
+
+           @param p    Parameters (file names)
+           @param data Streams of each configuration (Nconfigs x streams)
+        */
+        void readStreams(const ParameterContainer& p, vector<double>& data);
+
+        /**
+           Evaluate means of each configuration, choose block size and
+           average blocks
+
+           @param data Streams of each configuration
+        */
+        void computeBlockMeans(const vector<double>& data);
+
+        /**
+           Compute samples on threads, values, errors and covariance
+
+           @param seed Random generator (seeds of bootstrap samples)
+        */
+        void resample(mt19937_64& seed);
+
+        /**
+           Evaluate means of configurations first to last-1
+
+           @param data   Streams of each configuration
+           @param values Means of each configuration
+           @param first  First configuration
+           @param last   Last configuration + 1
+        */
+        void evaluateMeans(const vector<double>& data, vector<double>& values, int first, int last);
+
+        /**
+           Compute samples first, first + stride, ...
+
+           @param first  First sample
+           @param stride Number of threads
+        */
+        void computeSamples(int first, int stride);
+
+        /**
+           Write values and errors (Derived) and covariance (Covariance)
+           to observable files
+
+           @param p Parameters (file names)
+        */
+        void dumpResults(const ParameterContainer& p);
+    };
+
+} // TopoOsciSim
+
+#endif // RESAMPLING_H
@@ -0,0 +1,61 @@
+/**
+   TopoOsciSim
+   reweight.cpp
+   Purpose: Interpolate observables in I/a by multi-ensemble reweighting
+            of the ensembles of a sweep file
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <chrono>
+#include "parameters.hpp"
+#include "reweighting.hpp"
+
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // define and initialize parameters (defaults of all ensembles)
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+
+    if (parameters.sweepFile.empty())
+    {
+        cerr << "ERROR: No sweepFile given" << endl;
+        exit(0);
+    }
+
+    TopoOsciSim::ReweightingContainer reweighting(parameters);
+    reweighting.readSweepFile(parameters.sweepFile);
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION       " << endl;
+        cout << endl;
+        cout << "     Multi-Ensemble Reweighting  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+    }
+
+    reweighting.readEnsembles();
+
+    chrono::steady_clock::time_point wallStart = chrono::steady_clock::now();
+
+    reweighting.run();
+
+    if (parameters.verbosity > 2)
+    {
+        cout << reweighting.ensembles.size() << " ensembles, " << reweighting.data.action.size() << " configurations, "
+             << reweighting.Niterations << " iterations on " << reweighting.Nthreads << " threads" << endl;
+        cout << "wall time = " << chrono::duration<double>(chrono::steady_clock::now() - wallStart).count() << " s" << endl;
+    }
+    cout << reweighting;
+
+    reweighting.writeToFile();
+}
@@ -0,0 +1,360 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include "reweighting.hpp"
+#include "sweepScheduler.hpp"
+#include "fastMath.hpp"
+#include "file.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Convergence of the free energies
+    static const double tolerance = 1E-10;
+    static const int maxIterations = 100000;
+
+    // Configurations per batch of FastMath::exp
+    static const int batchSize = 256;
+
+    // Configurations per thread of the sums (cost of starting threads)
+    static const long configsPerWorker = 10000;
+
+    // Blocks are contiguous parts of each ensemble
+    ReweightingData ReweightingData::leaveOutBlock(int block, int Nblocks) const
+    {
+        ReweightingData d;
+        long offset = 0;
+        for (unsigned int k=0; k<Nconfigs.size(); k++)
+        {
+            long first = Nconfigs[k] * block / Nblocks;
+            long last = Nconfigs[k] * (block + 1) / Nblocks;
+            d.Nconfigs.push_back(Nconfigs[k] - (last - first));
+            for (long i=0; i<Nconfigs[k]; i++)
+                if ((i < first) || (i >= last))
+                {
+                    d.action.push_back(action[offset + i]);
+                    d.charge.push_back(charge[offset + i]);
+                    d.plaquette.push_back(plaquette[offset + i]);
+                }
+            offset += Nconfigs[k];
+        }
+        return d;
+    }
+
+
+    ReweightingContainer::ReweightingContainer(const ParameterContainer& p) :
+        base        {p},
+        Nblocks     {p.reweightBlocks},
+        Nthreads    {p.Nthreads},
+        Niterations {0}
+    {
+        if (Nthreads <= 0)
+            Nthreads = thread::hardware_concurrency();
+        if (Nthreads <= 0)
+            Nthreads = 1;
+    }
+
+    void ReweightingContainer::readSweepFile(const string& fileName)
+    {
+        SweepScheduler sweep(base);
+        sweep.readSweepFile(fileName);
+        ensembles = sweep.points;
+    }
+
+    // One value per line up to the end of the file
+    static void readColumn(const string& type, const ParameterContainer& p, vector<double>& values)
+    {
+        FileObs f(type, p);
+        f.open();
+        double value;
+        while (f.f >> value)
+            values.push_back(value);
+        // end of file is expected
+        f.f.clear();
+    }
+
+    void ReweightingContainer::readEnsembles()
+    {
+        if (ensembles.size() < 2)
+        {
+            cerr << "ERROR: Reweighting needs at least two ensembles" << endl;
+            exit(0);
+        }
+
+        for (unsigned int k=0; k<ensembles.size(); k++)
+        {
+            const ParameterContainer& p = ensembles[k];
+            // actions of different lattices are not comparable
+            if ((p.xdim != ensembles[0].xdim) || (p.boundary != ensembles[0].boundary))
+            {
+                cerr << "ERROR: Ensembles of reweighting need the same xdim and boundary" << endl;
+                exit(0);
+            }
+            if (p.metaHeight > 0.)
+            {
+                cerr << "ERROR: Reweighting of metadynamics ensembles is not supported" << endl;
+                exit(0);
+            }
+            couplings.push_back(p.I / p.a);
+
+            vector<double> Q, S, Plaq;
+            readColumn("Q", p, Q);
+            readColumn("S", p, S);
+            readColumn("Plaq", p, Plaq);
+            long N = min(Q.size(), min(S.size(), Plaq.size()));
+            if ((Q.size() != S.size()) || (Q.size() != Plaq.size()))
+                cerr << "WARNING: Observable files of I/a = " << couplings[k] << " have different lengths, the first "
+                     << N << " configurations are used" << endl;
+            if ((N == 0) || (N < Nblocks))
+            {
+                cerr << "ERROR: " << N << " configurations of I/a = " << couplings[k] << " are less than "
+                     << max(1, Nblocks) << " blocks" << endl;
+                exit(0);
+            }
+
+            data.Nconfigs.push_back(N);
+            for (long i=0; i<N; i++)
+            {
+                data.action.push_back(S[i] / couplings[k]);
+                data.charge.push_back(Q[i]);
+                data.plaquette.push_back(Plaq[i]);
+            }
+        }
+
+        // range of the ensembles by default
+        double gridMin = base.reweightMin;
+        double gridMax = base.reweightMax;
+        if (gridMin <= 0.)
+            gridMin = *min_element(couplings.begin(), couplings.end());
+        if (gridMax <= 0.)
+            gridMax = *max_element(couplings.begin(), couplings.end());
+        grid.clear();
+        for (int g=0; g<base.reweightPoints; g++)
+            grid.push_back((base.reweightPoints > 1) ? gridMin + (gridMax - gridMin) * g / (base.reweightPoints - 1) : gridMin);
+    }
+
+    // All configurations, then jackknife samples on threads
+    void ReweightingContainer::run()
+    {
+        int K = couplings.size();
+        freeEnergies.assign(K, 0.);
+        Niterations = solve(data, freeEnergies, Nthreads);
+        interpolate(data, freeEnergies, values);
+
+        freeEnergyErrors.assign(K, 0.);
+        errors.assign(values.size(), 0.);
+        if (Nblocks == 0)
+            return;
+
+        sampleFreeEnergies.assign(Nblocks, freeEnergies);
+        sampleValues.assign(Nblocks, vector<double>());
+        vector<thread> workers;
+        for (int w=0; w<Nthreads; w++)
+            workers.push_back(thread(&ReweightingContainer::computeSamples, this, w, Nthreads));
+        for (int w=0; w<Nthreads; w++)
+            workers[w].join();
+
+        // jackknife samples scatter N-1 times less than independent ones
+        double norm = (Nblocks - 1.) / Nblocks;
+        for (int k=0; k<K; k++)
+        {
+            double average = 0.;
+            for (int s=0; s<Nblocks; s++)
+                average += sampleFreeEnergies[s][k] / Nblocks;
+            for (int s=0; s<Nblocks; s++)
+                freeEnergyErrors[k] += norm * (sampleFreeEnergies[s][k] - average) * (sampleFreeEnergies[s][k] - average);
+            freeEnergyErrors[k] = sqrt(freeEnergyErrors[k]);
+        }
+        for (unsigned int e=0; e<values.size(); e++)
+        {
+            double average = 0.;
+            for (int s=0; s<Nblocks; s++)
+                average += sampleValues[s][e] / Nblocks;
+            for (int s=0; s<Nblocks; s++)
+                errors[e] += norm * (sampleValues[s][e] - average) * (sampleValues[s][e] - average);
+            errors[e] = sqrt(errors[e]);
+        }
+    }
+
+    void ReweightingContainer::computeSamples(int first, int stride)
+    {
+        for (int s=first; s<Nblocks; s+=stride)
+        {
+            ReweightingData d = data.leaveOutBlock(s, Nblocks);
+            solve(d, sampleFreeEnergies[s], 1);
+            interpolate(d, sampleFreeEnergies[s], sampleValues[s]);
+        }
+    }
+
+    // Self-consistent iteration, f_0 = 0
+    int ReweightingContainer::solve(const ReweightingData& d, vector<double>& f, int Nworkers)
+    {
+        int K = couplings.size();
+        long N = d.action.size();
+        Nworkers = max(1L, min((long)Nworkers, N / configsPerWorker));
+
+        vector<double> logDenominators(N);
+        vector<vector<double> > sums(Nworkers, vector<double>(K));
+        for (int iteration=1; iteration<=maxIterations; iteration++)
+        {
+            for (int w=0; w<Nworkers; w++)
+                sums[w].assign(K, 0.);
+            if (Nworkers == 1)
+                sumProbabilities(d, f, sums[0], logDenominators, 0, N);
+            else
+            {
+                vector<thread> workers;
+                for (int w=0; w<Nworkers; w++)
+                    workers.push_back(thread(&ReweightingContainer::sumProbabilities, this, cref(d), cref(f), ref(sums[w]),
+                                             ref(logDenominators), N * w / Nworkers, N * (w+1) / Nworkers));
+                for (int w=0; w<Nworkers; w++)
+                    workers[w].join();
+            }
+
+            // sum over n of p_kn is N_k at the solution
+            vector<double> fNew(K);
+            for (int k=0; k<K; k++)
+            {
+                double sum = 0.;
+                for (int w=0; w<Nworkers; w++)
+                    sum += sums[w][k];
+                fNew[k] = f[k] - log(sum / d.Nconfigs[k]);
+            }
+            double change = 0.;
+            for (int k=0; k<K; k++)
+            {
+                change = max(change, fabs(fNew[k] - fNew[0] - f[k]));
+                f[k] = fNew[k] - fNew[0];
+            }
+            if (change < tolerance)
+                return iteration;
+        }
+        cerr << "WARNING: Free energies did not converge in " << maxIterations << " iterations" << endl;
+        return maxIterations;
+    }
+
+    // Exponentials of a batch of configurations at once, shifted by
+    // their largest exponent
+    void ReweightingContainer::sumProbabilities(const ReweightingData& d, const vector<double>& f, vector<double>& sums,
+                                                vector<double>& logDenominators, long first, long last)
+    {
+        int K = couplings.size();
+        vector<double> offsets(K);
+        for (int k=0; k<K; k++)
+            offsets[k] = log((double)d.Nconfigs[k]) + f[k];
+
+        vector<double> x(batchSize * K);
+        vector<double> maxima(batchSize);
+        for (long start=first; start<last; start+=batchSize)
+        {
+            int n = min((long)batchSize, last - start);
+            for (int c=0; c<n; c++)
+            {
+                double s = d.action[start + c];
+                double* xc = &x[c * K];
+                double m = -numeric_limits<double>::infinity();
+                for (int k=0; k<K; k++)
+                {
+                    xc[k] = offsets[k] - couplings[k] * s;
+                    m = max(m, xc[k]);
+                }
+                for (int k=0; k<K; k++)
+                    xc[k] -= m;
+                maxima[c] = m;
+            }
+
+            FastMath::exp(x.data(), x.data(), n * K, FastMath::full);
+
+            for (int c=0; c<n; c++)
+            {
+                const double* xc = &x[c * K];
+                double sum = 0.;
+                for (int k=0; k<K; k++)
+                    sum += xc[k];
+                logDenominators[start + c] = maxima[c] + log(sum);
+                for (int k=0; k<K; k++)
+                    sums[k] += xc[k] / sum;
+            }
+        }
+    }
+
+    // Weights exp(-(I/a) s_n) / denominator_n, shifted by the largest one
+    void ReweightingContainer::interpolate(const ReweightingData& d, const vector<double>& f, vector<double>& result)
+    {
+        int K = couplings.size();
+        long N = d.action.size();
+        vector<double> logDenominators(N);
+        vector<double> sums(K, 0.);
+        sumProbabilities(d, f, sums, logDenominators, 0, N);
+
+        result.assign(grid.size() * Nobservables, 0.);
+        vector<double> w(N);
+        for (unsigned int g=0; g<grid.size(); g++)
+        {
+            double m = -numeric_limits<double>::infinity();
+            for (long n=0; n<N; n++)
+            {
+                w[n] = -grid[g] * d.action[n] - logDenominators[n];
+                m = max(m, w[n]);
+            }
+            for (long n=0; n<N; n++)
+                w[n] -= m;
+            FastMath::exp(w.data(), w.data(), N, FastMath::full);
+
+            double norm = 0., normSq = 0., qSq = 0., action = 0., plaquette = 0.;
+            for (long n=0; n<N; n++)
+            {
+                norm += w[n];
+                normSq += w[n] * w[n];
+                qSq += w[n] * d.charge[n] * d.charge[n];
+                action += w[n] * d.action[n];
+                plaquette += w[n] * d.plaquette[n];
+            }
+            double* r = &result[g * Nobservables];
+            r[0] = qSq / norm;
+            r[1] = grid[g] * action / norm;
+            r[2] = plaquette / norm;
+            r[3] = norm * norm / normSq;
+        }
+    }
+
+    ostream& operator<<(ostream& out, const ReweightingContainer& r)
+    {
+        for (unsigned int k=0; k<r.couplings.size(); k++)
+            out << "\t I/a = " << r.couplings[k] << ": " << r.data.Nconfigs[k] << " configurations, f = "
+                << r.freeEnergies[k] << " +- " << r.freeEnergyErrors[k] << endl;
+        out << "# I/a\t<Q^2>\terror\t<S>\terror\t<Plaq>\terror\tNeff" << endl;
+        for (unsigned int g=0; g<r.grid.size(); g++)
+        {
+            const double* v = &r.values[g * r.Nobservables];
+            const double* e = &r.errors[g * r.Nobservables];
+            out << r.grid[g] << "\t" << v[0] << "\t" << e[0] << "\t" << v[1] << "\t" << e[1] << "\t"
+                << v[2] << "\t" << e[2] << "\t" << v[3] << endl;
+        }
+        return out;
+    }
+
+    void ReweightingContainer::writeToFile()
+    {
+        FileObs fReweighting("Reweighting", base);
+        fReweighting.create();
+
+        for (unsigned int k=0; k<couplings.size(); k++)
+            fReweighting.f << "# ensemble I/a = " << couplings[k] << "\t" << data.Nconfigs[k] << "\t"
+                           << freeEnergies[k] << "\t" << freeEnergyErrors[k] << endl;
+        fReweighting.f << "# I/a\tQ2\terror\tS\terror\tPlaq\terror\tNeff" << endl;
+        for (unsigned int g=0; g<grid.size(); g++)
+        {
+            const double* v = &values[g * Nobservables];
+            const double* e = &errors[g * Nobservables];
+            fReweighting.f << grid[g] << "\t" << v[0] << "\t" << e[0] << "\t" << v[1] << "\t" << e[1] << "\t"
+                           << v[2] << "\t" << e[2] << "\t" << v[3] << endl;
+        }
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,165 @@
+#ifndef REWEIGHTING_H
+#define REWEIGHTING_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "parameters.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Configurations of several ensembles, ensemble by ensemble
+    class ReweightingData
+    {
+    public:
+
+        // Configurations of each ensemble
+        vector<long> Nconfigs;
+
+        // Action S/(I/a), Q and Plaq of each configuration
+        vector<double> action;
+        vector<double> charge;
+        vector<double> plaquette;
+
+        /**
+           Return data without one block of each ensemble (jackknife)
+
+           @param block   Block to leave out
+           @param Nblocks Blocks per ensemble
+           @return        Remaining configurations
+        */
+        ReweightingData leaveOutBlock(int block, int Nblocks) const;
+    };
+
+
+    /**
+       Multi-ensemble (Ferrenberg-Swendsen) reweighting in the coupling
+       I/a. The ensembles of a sweep file (same xdim, different I/a)
+       are joined by their actions, the free energies f_k = -log Z_k
+       solve self-consistently
+
+          exp(-f_k) = sum_n exp(-(I/a)_k s_n) / sum_j N_j exp(f_j - (I/a)_j s_n)
+
+       over all configurations n with s = S/(I/a). The iteration
+       f_k -> f_k - log(sum_n p_kn / N_k), with p_kn the probability
+       that configuration n belongs to ensemble k, sums over the
+       configurations on Nthreads threads and computes the
+       exponentials in batches with the vectorized FastMath::exp. The
+       observables <Q^2>, <S> and <Plaq> follow at any I/a between
+       the ensembles. Errors come from a jackknife that leaves out one
+       block of every ensemble, its samples are solved in parallel,
+       starting from the free energies of all configurations.
+    */
+    class ReweightingContainer
+    {
+
+    public:
+
+        // Parameters every ensemble starts from
+        ParameterContainer base;
+
+        // Parameters and I/a of ensembles
+        vector<ParameterContainer> ensembles;
+        vector<double> couplings;
+
+        // Configurations of all ensembles
+        ReweightingData data;
+
+        // Values of I/a of the interpolation
+        vector<double> grid;
+
+        int Nblocks;
+        int Nthreads;
+
+        // Free energies from all configurations (f_0 = 0), their errors
+        // and iterations
+        vector<double> freeEnergies;
+        vector<double> freeEnergyErrors;
+        int Niterations;
+
+        // <Q^2>, <S>, <Plaq> and effective number of configurations at
+        // each value of the grid (grid x observables) and their errors
+        vector<double> values;
+        vector<double> errors;
+
+        // Free energies of jackknife samples and their results
+        vector<vector<double> > sampleFreeEnergies;
+        vector<vector<double> > sampleValues;
+
+        static const int Nobservables = 4;
+
+        ReweightingContainer(const ParameterContainer& p);
+
+        /**
+           Read ensembles like SweepScheduler
+
+           @param fileName Name of sweep file
+        */
+        void readSweepFile(const string& fileName);
+
+        // Read Q, S and Plaq files of computeCharge_MC of all ensembles
+        void readEnsembles();
+
+        // Solve, interpolate and compute jackknife errors
+        void run();
+
+        /**
+           Iterate free energies until they change less than 1E-10
+
+           @param d        Configurations
+           @param f        Free energies (start and result)
+           @param Nworkers Threads summing over the configurations
+           @return         Number of iterations
+        */
+        int solve(const ReweightingData& d, vector<double>& f, int Nworkers);
+
+        /**
+           Add p_kn (sum over k is 1) of configurations first to last-1
+           and log(sum_j N_j exp(f_j - (I/a)_j s_n))
+
+           @param d                Configurations
+           @param f                Free energies
+           @param sums             Sums over n of p_kn (added to)
+           @param logDenominators  Logarithm of denominator of each configuration
+           @param first            First configuration
+           @param last             Last configuration + 1
+        */
+        void sumProbabilities(const ReweightingData& d, const vector<double>& f, vector<double>& sums,
+                              vector<double>& logDenominators, long first, long last);
+
+        /**
+           Compute observables at the values of the grid
+
+           @param d      Configurations
+           @param f      Free energies
+           @param result Observables (grid x observables)
+        */
+        void interpolate(const ReweightingData& d, const vector<double>& f, vector<double>& result);
+
+        /**
+           Solve and interpolate jackknife samples first, first + stride, ...
+
+           @param first  First sample
+           @param stride Number of threads
+        */
+        void computeSamples(int first, int stride);
+
+        /**
+           Return ostream for ReweightingContainer class
+
+           @param out Ostream where output goes
+           @param r   This class
+           @return    Ostream including free energies and table of grid
+        */
+        friend ostream& operator<<(ostream& out, const ReweightingContainer& r);
+
+        // Write table of grid to output directory
+        void writeToFile();
+    };
+
+} // TopoOsciSim
+
+#endif // REWEIGHTING_H
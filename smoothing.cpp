@@ -0,0 +1,255 @@
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include "smoothing.hpp"
+#include "fastMath.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // 1.5 * 2^52: (x + magic) - magic rounds x to an integer without a
+    // call, so the loops over the batch vectorize
+    static const double magic = 6755399441055744.;
+
+    // Difference mapped to [-pi, pi]
+    static inline double wrap(double diff)
+    {
+        return diff - 2*M_PI * ((diff * (0.5/M_PI) + magic) - magic);
+    }
+
+    // Parse times and allocate batch
+    SmoothingContainer::SmoothingContainer(const ParameterContainer& p, const LatticeContainer& l) :
+        method     {p.smoothing},
+        step       {p.flowStep},
+        xdim       {l.xdim},
+        Ia         {l.I / l.a},
+        boundary   {l.boundary},
+        bulkMargin {l.bulkMargin},
+        Nlinks     {(l.boundary == 'o') ? l.xdim - 1 : l.xdim},
+        batchSize  {p.smoothingBatch},
+        Nconfigs   {0}
+    {
+        stringstream list(p.flowTimes);
+        string time;
+        while (getline(list, time, ','))
+            if (!time.empty())
+            {
+                times.push_back(stod(time));
+                if ((times.back() < 0.) || ((times.size() > 1) && (times.back() < times[times.size()-2])))
+                {
+                    cerr << "ERROR: flowTimes have to be ascending and not negative" << endl;
+                    exit(0);
+                }
+            }
+        if (times.empty())
+        {
+            cerr << "ERROR: No flowTimes given" << endl;
+            exit(0);
+        }
+
+        phi.assign(xdim * batchSize, 0.);
+        angles.assign(xdim * batchSize, 0.);
+        differences.assign(Nlinks * batchSize, 0.);
+        sines.assign(Nlinks * batchSize, 0.);
+        cosines.assign(Nlinks * batchSize, 0.);
+        velocity.assign(xdim * batchSize, 0.);
+        stages.assign(xdim * batchSize, 0.);
+
+        charges.assign(times.size() * batchSize, 0.);
+        actions.assign(times.size() * batchSize, 0.);
+        correlations.assign(times.size() * xdim * batchSize, 0.);
+    }
+
+    void SmoothingContainer::push(const LatticeContainer& l)
+    {
+        for (int x=0; x<xdim; x++)
+            phi[x*batchSize + Nconfigs] = l.tslice[x].phi;
+        Nconfigs++;
+    }
+
+    void SmoothingContainer::clear()
+    {
+        Nconfigs = 0;
+    }
+
+    // Smooth up to each time and measure (whole batch, unused
+    // configurations cost little and keep the loops simple)
+    void SmoothingContainer::run()
+    {
+        if (method == "cooling")
+        {
+            long sweeps = 0;
+            for (unsigned int k=0; k<times.size(); k++)
+            {
+                for (; sweeps<lround(times[k]); sweeps++)
+                    doCoolingSweep();
+                measure(k);
+            }
+            return;
+        }
+
+        double t = 0.;
+        for (unsigned int k=0; k<times.size(); k++)
+        {
+            // last step ends at the time of the measurement
+            while (times[k] - t > 1E-9 * step)
+            {
+                double epsilon = min(step, times[k] - t);
+                doFlowStep(epsilon);
+                t += epsilon;
+            }
+            measure(k);
+        }
+    }
+
+    void SmoothingContainer::computeDifferences()
+    {
+        for (int l=0; l<Nlinks; l++)
+        {
+            const double* phiX = &phi[l*batchSize];
+            const double* phiNext = &phi[((l+1 == xdim) ? 0 : l+1)*batchSize];
+            double* d = &differences[l*batchSize];
+            for (int b=0; b<batchSize; b++)
+                d[b] = phiNext[b] - phiX[b];
+        }
+    }
+
+    // Sines of all links at once
+    void SmoothingContainer::computeVelocity(double epsilon)
+    {
+        computeDifferences();
+        FastMath::sincos(differences.data(), sines.data(), cosines.data(), Nlinks * batchSize, FastMath::full);
+
+        for (int x=0; x<xdim; x++)
+        {
+            double* v = &velocity[x*batchSize];
+            int after = (x < Nlinks) ? x : -1;
+            int before = (x > 0) ? x-1 : ((boundary == 'o') ? -1 : xdim-1);
+            for (int b=0; b<batchSize; b++)
+                v[b] = 0.;
+            if (after >= 0)
+            {
+                const double* s = &sines[after*batchSize];
+                for (int b=0; b<batchSize; b++)
+                    v[b] += epsilon * s[b];
+            }
+            if (before >= 0)
+            {
+                const double* s = &sines[before*batchSize];
+                for (int b=0; b<batchSize; b++)
+                    v[b] -= epsilon * s[b];
+            }
+        }
+    }
+
+    // W1 = W0 + 1/4 Z0, W2 = W1 + 8/9 Z1 - 17/36 Z0,
+    // W3 = W2 + 3/4 Z2 - 8/9 Z1 + 17/36 Z0 (exact for U(1))
+    void SmoothingContainer::doFlowStep(double epsilon)
+    {
+        int N = xdim * batchSize;
+
+        computeVelocity(epsilon);
+        for (int i=0; i<N; i++)
+        {
+            phi[i] += 0.25 * velocity[i];
+            stages[i] = -17./36. * velocity[i];
+        }
+
+        computeVelocity(epsilon);
+        for (int i=0; i<N; i++)
+        {
+            stages[i] += 8./9. * velocity[i];
+            phi[i] += stages[i];
+        }
+
+        computeVelocity(epsilon);
+        for (int i=0; i<N; i++)
+            phi[i] += 0.75 * velocity[i] - stages[i];
+    }
+
+    // Minimum of local action: circular midpoint of both neighbours,
+    // angle of the only neighbour at an open end
+    void SmoothingContainer::doCoolingSweep()
+    {
+        for (int x=0; x<xdim; x++)
+        {
+            int before = (x > 0) ? x-1 : ((boundary == 'o') ? -1 : xdim-1);
+            int after = (x+1 < xdim) ? x+1 : ((boundary == 'o') ? -1 : 0);
+            double* phiX = &phi[x*batchSize];
+
+            if ((before >= 0) && (after >= 0))
+            {
+                const double* phiBefore = &phi[before*batchSize];
+                const double* phiAfter = &phi[after*batchSize];
+                for (int b=0; b<batchSize; b++)
+                {
+                    double target = phiBefore[b] + 0.5 * wrap(phiAfter[b] - phiBefore[b]);
+                    phiX[b] += wrap(target - phiX[b]);
+                }
+            }
+            else if ((before >= 0) || (after >= 0))
+            {
+                const double* phiNeighbour = &phi[((before >= 0) ? before : after)*batchSize];
+                for (int b=0; b<batchSize; b++)
+                    phiX[b] += wrap(phiNeighbour[b] - phiX[b]);
+            }
+        }
+    }
+
+    // Like computeQ, getAction and computeCorr of LatticeContainer
+    void SmoothingContainer::measure(int k)
+    {
+        computeDifferences();
+        FastMath::cos(differences.data(), cosines.data(), Nlinks * batchSize, FastMath::full);
+
+        double* q = &charges[k*batchSize];
+        double* S = &actions[k*batchSize];
+        for (int b=0; b<batchSize; b++)
+        {
+            q[b] = 0.;
+            S[b] = 0.;
+        }
+        for (int l=0; l<Nlinks; l++)
+        {
+            const double* d = &differences[l*batchSize];
+            const double* c = &cosines[l*batchSize];
+            bool bulk = (boundary != 'o') || ((l >= bulkMargin) && (l+1 < xdim - bulkMargin));
+            if (bulk)
+                for (int b=0; b<batchSize; b++)
+                    q[b] += wrap(d[b]) * (0.5/M_PI);
+            for (int b=0; b<batchSize; b++)
+                S[b] += Ia * (1. - c[b]);
+        }
+
+        // angles in [-pi, pi] like the dumped configurations (flow and
+        // cooling do not keep them there)
+        for (int i=0; i<xdim*batchSize; i++)
+            angles[i] = wrap(phi[i]);
+
+        double* corr = &correlations[k*xdim*batchSize];
+        for (int i=0; i<xdim*batchSize; i++)
+            corr[i] = 0.;
+
+        // open boundaries: pairs inside the bulk
+        int first = (boundary == 'o') ? bulkMargin : 0;
+        int Nsites = (boundary == 'o') ? xdim - 2*bulkMargin : xdim;
+        for (int j=0; j<Nsites; j++)
+        {
+            double* corrJ = &corr[j*batchSize];
+            int Npairs = (boundary == 'o') ? Nsites - j : xdim;
+            for (int i=first; i<first+Npairs; i++)
+            {
+                const double* phiI = &angles[i*batchSize];
+                const double* phiJ = &angles[((i+j) % xdim)*batchSize];
+                for (int b=0; b<batchSize; b++)
+                    corrJ[b] += phiI[b] * phiJ[b];
+            }
+            for (int b=0; b<batchSize; b++)
+                corrJ[b] /= Npairs;
+        }
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,119 @@
+#ifndef SMOOTHING_H
+#define SMOOTHING_H
+
+#include <string>
+#include <vector>
+#include "parameters.hpp"
+#include "lattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Gradient flow or cooling of a batch of configurations with
+       measurements at several flow times. The angles are stored site
+       by site, the configurations of a site next to each other
+       (phi[x * batchSize + b]), so every operation on a site runs over
+       the whole batch in unit stride. The flow dphi_x/dt = sin(phi_{x+1}
+       - phi_x) - sin(phi_x - phi_{x-1}) decreases the action without
+       I/a. It is integrated with the third order Runge-Kutta scheme of
+       Luescher with steps of flowStep, and the sines of all links of
+       the batch are computed at once with FastMath::sincos. A cooling
+       sweep moves each angle to the minimum of its local action, the
+       circular midpoint of its neighbours. After smoothing, the
+       differences of neighbours are far from pi, so the winding
+       number is a stable charge.
+    */
+    class SmoothingContainer
+    {
+
+    public:
+
+        // flow or cooling
+        string method;
+
+        // Flow times (cooling: sweeps) of the measurements, ascending
+        vector<double> times;
+        double step;
+
+        // Lattice constants
+        int xdim;
+        double Ia;
+        char boundary;
+        int bulkMargin;
+
+        // Links (xdim periodic, xdim-1 open)
+        int Nlinks;
+
+        // Capacity of batch and configurations in batch
+        int batchSize;
+        int Nconfigs;
+
+        // Angles, angles in [-pi, pi], differences of links, their sines and cosines, flow
+        // velocity and combination of the Runge-Kutta stages
+        // (sites or links x batchSize)
+        vector<double> phi;
+        vector<double> angles;
+        vector<double> differences;
+        vector<double> sines;
+        vector<double> cosines;
+        vector<double> velocity;
+        vector<double> stages;
+
+        // Q, S (total action like S, action density is S / Nlinks) and
+        // correlator (xdim values) of each configuration at
+        // each time (times x batchSize, times x xdim x batchSize)
+        vector<double> charges;
+        vector<double> actions;
+        vector<double> correlations;
+
+        /**
+           Parse flow times and allocate batch
+
+           @param p Parameters (smoothing, flowTimes, flowStep, smoothingBatch)
+           @param l Lattice with constants of the configurations
+        */
+        SmoothingContainer(const ParameterContainer& p, const LatticeContainer& l);
+
+        /**
+           Copy configuration of lattice into the batch
+
+           @param l Lattice
+        */
+        void push(const LatticeContainer& l);
+
+        // Smooth batch and measure at all times
+        void run();
+
+        // Start new batch
+        void clear();
+
+        // Differences of neighbours for all links
+        void computeDifferences();
+
+        /**
+           One Runge-Kutta step of the flow
+
+           @param epsilon Flow time of step
+        */
+        void doFlowStep(double epsilon);
+
+        // velocity = -dS/dphi of all sites times epsilon
+        void computeVelocity(double epsilon);
+
+        // One sequential cooling sweep
+        void doCoolingSweep();
+
+        /**
+           Measure Q, S and correlator
+
+           @param k Number of time
+        */
+        void measure(int k);
+    };
+
+} // TopoOsciSim
+
+#endif // SMOOTHING_H
@@ -0,0 +1,65 @@
+/**
+   TopoOsciSim
+   sweepConfigs.cpp
+   Purpose: Create configurations for many parameter points on all cores.
+
+   @author Julia Volmer
+   @version 1.0 
+*/
+
+#include <iostream>
+#include <random>
+#include <ctime>
+#include <chrono>
+#include "parameters.hpp"
+#include "sweepScheduler.hpp"
+#include "profiler.hpp"
+ 
+using namespace std;
+
+int main (int argc, char *argv[])
+{
+    // initialize random generator
+    random_device rd;
+    mt19937_64 generator(rd());
+
+    // define and initialize parameters (defaults of all points)
+    TopoOsciSim::ParameterContainer parameters;
+
+    // process command line input
+    parameters.readInput(argc, argv);
+
+    if (parameters.sweepFile.empty())
+    {
+        cerr << "ERROR: No sweepFile given" << endl;
+        exit(0);
+    }
+
+    TopoOsciSim::SweepScheduler scheduler(parameters);
+    scheduler.readSweepFile(parameters.sweepFile);
+
+    if (parameters.verbosity > 2)
+    {
+        cout << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "TOPOLOGICAL OSCILLATOR SILMULATION       " << endl;
+        cout << endl;
+        cout << "     Sweep Configurations  " << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << parameters << endl;
+        cout << scheduler.points.size() << " points on " << scheduler.Nthreads << " threads" << endl;
+    }
+
+    chrono::steady_clock::time_point wallStart = chrono::steady_clock::now();
+    clock_t cpuStart = clock();
+
+    scheduler.run(generator);
+
+    PROFILE_WRITE("SweepConfigs", parameters);
+
+    if (parameters.verbosity > 2)
+    {
+        cout << "wall time = " << chrono::duration<double>(chrono::steady_clock::now() - wallStart).count() << " s" << endl;
+        cout << "cpu time = " << (clock() - cpuStart) / (double)CLOCKS_PER_SEC << " s" << endl;
+    }
+}
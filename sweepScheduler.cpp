@@ -0,0 +1,259 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include "sweepScheduler.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+#include "observableTracker.hpp"
+#include "measurementSink.hpp"
+#include "thermalCache.hpp"
+#include "catalog.hpp"
+#include "profiler.hpp"
+#include "latticeEquilibrationFactory.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    SweepScheduler::SweepScheduler(const ParameterContainer& p) :
+        base     {p},
+        Nthreads {p.Nthreads}
+    {
+        if (Nthreads <= 0)
+            Nthreads = thread::hardware_concurrency();
+        if (Nthreads <= 0)
+            Nthreads = 1;
+    }
+
+    SweepScheduler::~SweepScheduler()
+    {
+        for (unsigned int i=0; i<queueMutexes.size(); i++)
+            delete queueMutexes[i];
+    }
+
+    // Read parameter points and grids
+    void SweepScheduler::readSweepFile(const string& fileName)
+    {
+        ifstream f(fileName);
+        if (!f.is_open())
+        {
+            cerr << "ERROR: Sweep file " << fileName << " cannot be opened" << endl;
+            exit(0);
+        }
+
+        string line;
+        while (getline(f, line))
+        {
+            line = line.substr(0, line.find('#'));
+            stringstream words(line);
+
+            string first;
+            if (!(words >> first))
+                continue;
+
+            bool grid = (first == "grid");
+            vector<string> names;
+            vector<vector<string> > values;
+            string name = first, value;
+            if (grid)
+                words >> name;
+            do
+            {
+                if (!(words >> value))
+                {
+                    cerr << "ERROR: Parameter " << name << " without value in " << fileName << endl;
+                    exit(0);
+                }
+                names.push_back(name);
+                values.push_back(vector<string>());
+                if (grid)
+                {
+                    stringstream list(value);
+                    while (getline(list, value, ','))
+                        values.back().push_back(value);
+                }
+                else
+                    values.back().push_back(value);
+            }
+            while (words >> name);
+
+            addGrid(names, values);
+        }
+    }
+
+    // Add all combinations of the values of grid to points
+    void SweepScheduler::addGrid(const vector<string>& names, const vector<vector<string> >& values)
+    {
+        vector<unsigned int> index(names.size(), 0);
+        while (true)
+        {
+            ParameterContainer p = base;
+            for (unsigned int n=0; n<names.size(); n++)
+                p.process(names[n], values[n][index[n]]);
+            points.push_back(p);
+
+            // next combination (mixed radix)
+            unsigned int n = 0;
+            while ((n < names.size()) && (++index[n] == values[n].size()))
+                index[n++] = 0;
+            if (n == names.size())
+                break;
+        }
+    }
+
+    // Cost estimate of point
+    double SweepScheduler::getCost(const ParameterContainer& p)
+    {
+        return (double)p.xdim * ((double)p.Nthermal + (double)p.Nsteps);
+    }
+
+    // Run all points on Nthreads workers
+    void SweepScheduler::run(mt19937_64& seed)
+    {
+        int Npoints = points.size();
+        costs.resize(Npoints);
+        seeds.resize(Npoints);
+        for (int i=0; i<Npoints; i++)
+        {
+            costs[i] = getCost(points[i]);
+            seeds[i] = seed();
+        }
+
+        // longest job first, dealt round robin to the workers
+        vector<int> order(Npoints);
+        for (int i=0; i<Npoints; i++)
+            order[i] = i;
+        stable_sort(order.begin(), order.end(), [this](int i, int j) { return costs[i] > costs[j]; });
+
+        queues.assign(Nthreads, deque<int>());
+        for (int t=0; t<Nthreads; t++)
+            queueMutexes.push_back(new mutex);
+        for (int i=0; i<Npoints; i++)
+            queues[i % Nthreads].push_back(order[i]);
+
+        vector<thread> threads;
+        for (int t=0; t<Nthreads; t++)
+            threads.push_back(thread(&SweepScheduler::runWorker, this, t));
+        for (unsigned int t=0; t<threads.size(); t++)
+            threads[t].join();
+    }
+
+    // Take own longest job or steal shortest job of another worker
+    bool SweepScheduler::getJob(int id, int& job)
+    {
+        for (int k=0; k<Nthreads; k++)
+        {
+            int victim = (id + k) % Nthreads;
+            lock_guard<mutex> lock(*queueMutexes[victim]);
+            if (queues[victim].empty())
+                continue;
+            if (k == 0)
+            {
+                job = queues[victim].front();
+                queues[victim].pop_front();
+            }
+            else
+            {
+                job = queues[victim].back();
+                queues[victim].pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Create configurations for each job like createConfigs
+    void SweepScheduler::runWorker(int id)
+    {
+        LatticeContainer* lattice = NULL;
+        LatticeEquilibration* latticeEquilibration = NULL;
+
+        int job;
+        while (getJob(id, job))
+        {
+            ParameterContainer p = points[job];
+            mt19937_64 generator(seeds[job]);
+
+            // one id for all files of the point
+            RunCatalog catalog(p.configDirectory);
+            if (p.fileId == -1)
+            {
+                string key = "Conf" + FileExtension("Conf", p).fullExtension;
+                p.fileId = catalog.allocateId(key, p.configDirectory + key);
+            }
+
+            // reuse lattice for same xdim, new engine for each point, the
+            // factory depends on boundary, fastMath and metaHeight too
+            delete latticeEquilibration;
+            latticeEquilibration = NULL;
+            if ((lattice == NULL) || (lattice->xdim != p.xdim))
+            {
+                delete lattice;
+                lattice = new LatticeContainer(p);
+            }
+            else
+                lattice->setParameters(p);
+            lattice->setBoundaries(p);
+
+            latticeEquilibration = NewLatticeEquilibrationFor(lattice, p);
+            if (latticeEquilibration == NULL)
+            {
+                cerr << "ERROR: Unknown equilibrationAlgorithm " << p.equilibrationAlgorithm << endl;
+                exit(0);
+            }
+            latticeEquilibration->setTracker(NULL);
+
+            // thermalization, from cached lattice if there is one
+            int Nthermal = p.Nthermal;
+            ThermalCacheContainer cache(p);
+            if (cache.enabled() && cache.load(*lattice))
+                Nthermal = min(p.Nthermal, (p.metaHeight > 0.) ? max(p.Nrethermal, p.metaBuildup) : p.Nrethermal);
+            else
+                lattice->setRandom(generator);
+            {
+                PROFILE_SCOPE(thermalization);
+                latticeEquilibration->run(generator, Nthermal, 1, NULL);
+            }
+
+            lattice->mod2Pi();
+            ObservableTracker tracker(lattice, p);
+            latticeEquilibration->setTracker(&tracker);
+
+            FileConfig Conf(p);
+            Conf.create();
+            lattice->dumpHeader(Conf);
+
+            FileSink sink(lattice, (p.Nthermal > 0) ? &Conf : NULL, p);
+            {
+                PROFILE_SCOPE(production);
+                latticeEquilibration->run(generator, p.Nsteps, 1, &sink);
+            }
+            latticeEquilibration->setTracker(NULL);
+
+            if (cache.enabled())
+                cache.store(*lattice);
+
+            Conf.f.flush();
+            vector<string> obsFiles;
+            for (unsigned int i=0; i<sink.files.size(); i++)
+            {
+                sink.files[i]->f.flush();
+                obsFiles.push_back(sink.files[i]->name.fullName);
+            }
+            catalog.recordRun(p, Conf.name.fullName, obsFiles, (p.Nthermal > 0) ? p.Nsteps : 0, to_string(seeds[job]));
+
+            if (p.verbosity > 2)
+            {
+                lock_guard<mutex> lock(outputMutex);
+                cout << "worker " << id << ": " << Conf << " finished" << endl;
+            }
+        }
+
+        delete latticeEquilibration;
+        delete lattice;
+    }
+
+} // TopoOsciSim
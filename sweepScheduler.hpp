@@ -0,0 +1,95 @@
+#ifndef SWEEPSCHEDULER_H
+#define SWEEPSCHEDULER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <random>
+#include "parameters.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Create configurations for a list of parameter points on a
+       work-stealing thread pool. Points are handed out longest job
+       first; each worker reuses its lattice while xdim stays the same
+       and creates the engine for every point.
+    */
+    class SweepScheduler
+    {
+
+    public:
+
+        // Parameters every point starts from
+        ParameterContainer base;
+
+        // Parameter points, their cost estimates and seeds
+        vector<ParameterContainer> points;
+        vector<double> costs;
+        vector<unsigned long> seeds;
+
+        int Nthreads;
+
+        // Job queue of each worker (front: own jobs, back: stolen)
+        vector<deque<int> > queues;
+        vector<mutex*> queueMutexes;
+
+        // Serializes progress output
+        mutex outputMutex;
+
+        SweepScheduler(const ParameterContainer& p);
+        ~SweepScheduler();
+
+        /**
+           Read parameter points. Each line is either a point
+           "name value [name value ...]" or a grid
+           "grid name v1,v2,... [name v1,v2,... ...]" (all combinations).
+           Parameters not given are taken from base, '#' starts a comment.
+
+           @param fileName Name of sweep file
+        */
+        void readSweepFile(const string& fileName);
+
+        /**
+           Add all combinations of the values of grid to points
+
+           @param names  Parameter names
+           @param values Values of each parameter
+        */
+        void addGrid(const vector<string>& names, const vector<vector<string> >& values);
+
+        // Cost estimate of point: xdim * (Nthermal + Nsteps)
+        static double getCost(const ParameterContainer& p);
+
+        /**
+           Run all points on Nthreads workers
+
+           @param seed Random generator to seed the points
+        */
+        void run(mt19937_64& seed);
+
+        /**
+           Worker loop: own jobs first, then steal from the others
+
+           @param id Number of worker
+        */
+        void runWorker(int id);
+
+        /**
+           Take next job of worker
+
+           @param id  Number of worker
+           @param job Index of point
+           @return    false if all queues are empty
+        */
+        bool getJob(int id, int& job);
+    };
+
+} // TopoOsciSim
+
+#endif // SWEEPSCHEDULER_H
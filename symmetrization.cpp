@@ -0,0 +1,259 @@
+#include <iostream>
+#include <thread>
+#include <ctime>
+#include "symmetrization.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // Create SymmetrizationContainer on lattice
+    SymmetrizationContainer::SymmetrizationContainer(LatticeContainer* l, const ParameterContainer& p) :
+        lattice          {l},
+        Nsym             {p.Nsym},
+        NPermutationSets {p.NPermutationSets},
+        Ncopies          {1},
+        minNormConst     {p.minNormConst},
+        normConst        {0.},
+        sumQ             {0.},
+        sumQSq           {0.},
+        pruned           {false}
+    {
+        if ((Nsym < 1) || (NPermutationSets < 1) || (NPermutationSets > lattice->xdim))
+        {
+            cerr << "ERROR: Symmetrization needs Nsym > 0 and 0 < NPermutationSets <= xdim" << endl;
+            exit(0);
+        }
+
+        // a global shift does not change action and charge,
+        // so the first set is never shifted
+        for (int j=1; j<NPermutationSets; j++)
+            Ncopies *= Nsym;
+
+        for (int j=0; j<NPermutationSets; j++)
+            setStart.push_back(j * lattice->xdim / NPermutationSets);
+
+        borderAction.resize(NPermutationSets * Nsym);
+        borderCharge.resize(NPermutationSets * Nsym);
+        copyAction.resize(Ncopies);
+        copyCharge.resize(Ncopies);
+    }
+
+    // Return ostream for SymmetrizationContainer class
+    ostream& operator<<(ostream& out, const SymmetrizationContainer &s)
+    {
+        out << *(s.lattice) << " => " << s.normConst << " (" << s.Ncopies << " copies)";
+        return out;
+    }
+
+    // Fill action and charge of all border links for all shift differences
+    void SymmetrizationContainer::fillBorderTables()
+    {
+        int last;
+        double diff;
+        for (int b=0; b<NPermutationSets; b++)
+        {
+            // link from last site of set b to first site of next set
+            last = lattice->getId(setStart[(b+1) % NPermutationSets] - 1);
+            diff = lattice->tslice[lattice->tslice[last].idAfter].phi - lattice->tslice[last].phi;
+
+            for (int ds=0; ds<Nsym; ds++)
+            {
+                borderAction[b*Nsym + ds] = lattice->I/lattice->a * (1. - cos(diff + 2 * M_PI * ds / Nsym));
+                borderCharge[b*Nsym + ds] = 1./(2*M_PI) * LatticeContainer::getWrappedDifference(diff + 2 * M_PI * ds / Nsym);
+            }
+        }
+    }
+
+    // Fill action and charge of all copies from the border tables
+    void SymmetrizationContainer::fillCopies()
+    {
+        // contribution of all links that are not borders
+        lattice->computeQ();
+        double innerAction = lattice->getAction();
+        double innerCharge = lattice->q;
+
+        if (NPermutationSets == 1)
+        {
+            copyAction[0] = innerAction;
+            copyCharge[0] = innerCharge;
+            return;
+        }
+
+        for (int b=0; b<NPermutationSets; b++)
+        {
+            innerAction -= borderAction[b*Nsym];
+            innerCharge -= borderCharge[b*Nsym];
+        }
+        copyAction[0] = innerAction;
+        copyCharge[0] = innerCharge;
+
+        // add set j with shift s to all copies of sets 0..j-1,
+        // copy index c has the shift of set j at digit j-1
+        int n = 1, sPrev, ds;
+        for (int j=1; j<NPermutationSets; j++)
+        {
+            // s=0 overwrites the old entries, therefore last
+            for (int s=Nsym-1; s>=0; s--)
+                for (int c=0; c<n; c++)
+                {
+                    sPrev = (j == 1) ? 0 : (c / (n / Nsym)) % Nsym;
+                    ds = (s - sPrev + Nsym) % Nsym;
+                    copyAction[c + s*n] = copyAction[c] + borderAction[(j-1)*Nsym + ds];
+                    copyCharge[c + s*n] = copyCharge[c] + borderCharge[(j-1)*Nsym + ds];
+                }
+            n *= Nsym;
+        }
+
+        // close ring between last set and first set (never shifted)
+        int b = NPermutationSets - 1;
+        for (int c=0; c<Ncopies; c++)
+        {
+            ds = (Nsym - c / (Ncopies / Nsym)) % Nsym;
+            copyAction[c] += borderAction[b*Nsym + ds];
+            copyCharge[c] += borderCharge[b*Nsym + ds];
+        }
+    }
+
+    // Evaluate symmetrized weights and observables of current configuration
+    void SymmetrizationContainer::evaluate()
+    {
+        fillBorderTables();
+        fillCopies();
+
+        double thetaConst = 2. * M_PI * lattice->theta;
+        double norm = 0., normIm = 0., q = 0., qIm = 0., qSq = 0., qSqIm = 0.;
+        double w, wIm;
+        for (int c=0; c<Ncopies; c++)
+        {
+            w   = exp(-copyAction[c]);
+            wIm = - w * sin(thetaConst * copyCharge[c]);
+            w   =   w * cos(thetaConst * copyCharge[c]);
+
+            norm   += w;
+            normIm += wIm;
+            q      += copyCharge[c] * w;
+            qIm    += copyCharge[c] * wIm;
+            qSq    += copyCharge[c] * copyCharge[c] * w;
+            qSqIm  += copyCharge[c] * copyCharge[c] * wIm;
+        }
+        normConst = complex<double>(norm, normIm) / (double)Ncopies;
+        sumQ      = complex<double>(q, qIm) / (double)Ncopies;
+        sumQSq    = complex<double>(qSq, qSqIm) / (double)Ncopies;
+
+        pruned = (abs(normConst) < minNormConst);
+        if (pruned)
+        {
+            normConst = 0.;
+            sumQ = 0.;
+            sumQSq = 0.;
+        }
+    }
+
+    // Set random configuration and evaluate it
+    void SymmetrizationContainer::doStep(mt19937_64& seed)
+    {
+        lattice->setRandom(seed);
+        evaluate();
+    }
+
+
+    // Create SymmetrizationIntegrator
+    SymmetrizationIntegrator::SymmetrizationIntegrator(const ParameterContainer& p) :
+        parameters {p},
+        Nthreads   {p.Nthreads},
+        normConst  (p.Nsteps, 0.),
+        sumQ       (p.Nsteps, 0.),
+        sumQSq     (p.Nsteps, 0.),
+        Npruned    {0},
+        cpuTime    {0.}
+    {
+        if (Nthreads <= 0)
+            Nthreads = thread::hardware_concurrency();
+        if (Nthreads <= 0)
+            Nthreads = 1;
+    }
+
+    // Evaluate all sampling points in parallel
+    void SymmetrizationIntegrator::run(mt19937_64& seed)
+    {
+        clock_t cpuStart = clock();
+
+        vector<thread> threads;
+        int first, last;
+        for (int t=0; t<Nthreads; t++)
+        {
+            first = (long)parameters.Nsteps * t / Nthreads;
+            last  = (long)parameters.Nsteps * (t+1) / Nthreads;
+            threads.push_back(thread(&SymmetrizationIntegrator::runRange, this, first, last, (unsigned long)seed()));
+        }
+        for (unsigned int t=0; t<threads.size(); t++)
+            threads[t].join();
+
+        cpuTime = (clock() - cpuStart) / (double)CLOCKS_PER_SEC;
+
+        Npruned = 0;
+        for (int i=0; i<parameters.Nsteps; i++)
+            if (normConst[i] == 0.)
+                Npruned++;
+    }
+
+    // Evaluate sampling points [first, last)
+    void SymmetrizationIntegrator::runRange(int first, int last, unsigned long seed)
+    {
+        mt19937_64 generator(seed);
+
+        LatticeContainer lattice(parameters);
+        lattice.setPeriodicBoundaries();
+        SymmetrizationContainer symmetrization(&lattice, parameters);
+
+        for (int i=first; i<last; i++)
+        {
+            symmetrization.doStep(generator);
+            normConst[i] = symmetrization.normConst;
+            sumQ[i]      = symmetrization.sumQ;
+            sumQSq[i]    = symmetrization.sumQSq;
+        }
+    }
+
+    // Return ratio of summed numerators and normalization constants
+    complex<double> SymmetrizationIntegrator::getExpectationValue(const vector<complex<double> >& numerator, double& error)
+    {
+        int n = parameters.Nsteps;
+        complex<double> num = 0., normSum = 0.;
+        for (int i=0; i<n; i++)
+        {
+            num     += numerator[i];
+            normSum += normConst[i];
+        }
+
+        complex<double> res = num / normSum;
+
+        // error of ratio from linearization
+        double var = 0.;
+        for (int i=0; i<n; i++)
+            var += norm(numerator[i] - res * normConst[i]);
+        error = sqrt(var / (double)n / (double)(n-1)) / abs(normSum / (double)n);
+
+        return res;
+    }
+
+    void SymmetrizationIntegrator::writeToFiles()
+    {
+        FileObs fNorm("SymNorm", parameters);
+        FileObs fQ("SymQ", parameters);
+        FileObs fQSq("SymQSq", parameters);
+        fNorm.create();
+        fQ.create();
+        fQSq.create();
+
+        for (int i=0; i<parameters.Nsteps; i++)
+        {
+            fNorm.printValueToFile(normConst[i]);
+            fQ.printValueToFile(sumQ[i]);
+            fQSq.printValueToFile(sumQSq[i]);
+        }
+    }
+
+} // TopoOsciSim
@@ -0,0 +1,153 @@
+#ifndef SYMMETRIZATION_H
+#define SYMMETRIZATION_H
+
+#include <iostream>
+#include <random>
+#include <complex>
+#include <vector>
+#include "parameters.hpp"
+#include "file.hpp"
+#include "lattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    class SymmetrizationContainer
+    {
+
+    public:
+
+        // Pointer to LatticeContainer
+        LatticeContainer* lattice;
+
+        // Number of symmetrizations per permutation set
+        int Nsym;
+
+        // Number of permutation sets (lattice blocks shifted independently)
+        int NPermutationSets;
+
+        // Number of evaluated copies
+        int Ncopies;
+
+        // Normalization constants with smaller absolute value are pruned
+        double minNormConst;
+
+        // First lattice site of each permutation set
+        vector<int> setStart;
+
+        // Action and charge of border link b shifted by ds at [b*Nsym + ds]
+        vector<double> borderAction;
+        vector<double> borderCharge;
+
+        // Action and charge of all copies
+        vector<double> copyAction;
+        vector<double> copyCharge;
+
+        // Results of last evaluation (averaged over copies)
+        complex<double> normConst;
+        complex<double> sumQ;
+        complex<double> sumQSq;
+        bool pruned;
+
+        /**
+           Create SymmetrizationContainer on lattice
+
+           @param l pointer to LatticeContainer
+           @param p Parameters (Nsym, NPermutationSets, minNormConst, theta)
+        */
+        SymmetrizationContainer(LatticeContainer* l, const ParameterContainer& p);
+
+        /**
+           Return ostream for SymmetrizationContainer class
+
+           @param out Ostream where output goes
+           @param s   This class
+           @return    Ostream including s
+        */
+        friend ostream& operator<<(ostream& out, const SymmetrizationContainer &s);
+
+        /**
+           Fill action and charge of all border links for all
+           possible shift differences of neighbouring sets
+        */
+        void fillBorderTables();
+
+        /**
+           Fill action and charge of all symmetrized copies in
+           one batch from the border tables
+        */
+        void fillCopies();
+
+        /**
+           Evaluate symmetrized weights and observables of the
+           current lattice configuration
+        */
+        void evaluate();
+
+        /**
+           Set random configuration and evaluate it
+
+           @param seed Seed number
+        */
+        void doStep(mt19937_64& seed);
+    };
+
+
+    class SymmetrizationIntegrator
+    {
+
+    public:
+
+        ParameterContainer parameters;
+        int Nthreads;
+
+        // Results per sampling point
+        vector<complex<double> > normConst;
+        vector<complex<double> > sumQ;
+        vector<complex<double> > sumQSq;
+        int Npruned;
+
+        // Used cpu time of all threads in seconds
+        double cpuTime;
+
+        /**
+           Create SymmetrizationIntegrator
+
+           @param p Parameters (Nsteps sampling points are used)
+        */
+        SymmetrizationIntegrator(const ParameterContainer& p);
+
+        /**
+           Evaluate all sampling points in parallel
+
+           @param seed Seed number used to seed the threads
+        */
+        void run(mt19937_64& seed);
+
+        /**
+           Evaluate sampling points [first, last)
+
+           @param first First sampling point
+           @param last  Last sampling point (excluded)
+           @param seed  Seed of thread generator
+        */
+        void runRange(int first, int last, unsigned long seed);
+
+        /**
+           Return ratio of summed numerators and normalization
+           constants and its statistical error
+
+           @param numerator Numerator per sampling point
+           @param error     Statistical error of result
+           @return          Expectation value
+        */
+        complex<double> getExpectationValue(const vector<complex<double> >& numerator, double& error);
+
+        void writeToFiles();
+    };
+
+} // TopoOsciSim
+
+#endif // SYMMETRIZATION_H
@@ -0,0 +1,72 @@
+/**
+   TopoOsciSim
+   testFastMath.cpp
+   Purpose: Check the error of the fastMath functions against libm for
+   every instruction set, exits with 1 if a bound is violated (make check).
+
+   @author Julia Volmer
+   @version 1.0
+*/
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include "fastMath.hpp"
+
+using namespace std;
+
+int main()
+{
+    const int n = 1 << 16;
+    const TopoOsciSim::FastMath::Accuracy accuracies[] = {TopoOsciSim::FastMath::full, TopoOsciSim::FastMath::reduced};
+    const string accuracyNames[] = {"double", "float"};
+    // ranges of the arguments: the angle differences of the updates, a wider
+    // range for cos and the range of the Metropolis acceptance for exp
+    const double cosRanges[] = {M_PI, 20., 1000.};
+    const double expRanges[] = {1., 50., 700.};
+
+    mt19937_64 generator(1);
+    bool accurate = true;
+    for (int r=0; r<3; r++)
+    {
+        uniform_real_distribution<double> distCos(-cosRanges[r], cosRanges[r]);
+        uniform_real_distribution<double> distExp(-expRanges[r], expRanges[r]);
+        vector<double> xCos(n), xExp(n);
+        for (int i=0; i<n; i++)
+        {
+            xCos[i] = distCos(generator);
+            xExp[i] = distExp(generator);
+        }
+        // multiples of pi/2 and zero, where sin or cos vanish
+        for (int i=0; i<64; i++)
+        {
+            xCos[i] = (i - 32) * M_PI_2;
+            xExp[i] = 0.;
+        }
+
+        for (const string& instructionSet : TopoOsciSim::FastMath::getInstructionSets())
+        {
+            TopoOsciSim::FastMath::setInstructionSet(instructionSet);
+            for (int a=0; a<2; a++)
+            {
+                double errorCos, errorExp, maxError = TopoOsciSim::FastMath::getMaxError(accuracies[a]);
+                TopoOsciSim::FastMath::getErrors(xCos.data(), xExp.data(), n, accuracies[a], errorCos, errorExp);
+                bool ok = (errorCos <= maxError) && (errorExp <= maxError);
+                cout << instructionSet << "/" << accuracyNames[a] << " |x| < " << cosRanges[r] << " (cos), "
+                     << expRanges[r] << " (exp): " << errorCos << ", " << errorExp
+                     << (ok ? " ok" : " FAILED") << endl;
+                accurate = accurate && ok;
+            }
+        }
+    }
+
+    if (!accurate)
+    {
+        cerr << "ERROR: fastMath differs from libm by more than " << TopoOsciSim::FastMath::getMaxError(TopoOsciSim::FastMath::full)
+             << " (double) or " << TopoOsciSim::FastMath::getMaxError(TopoOsciSim::FastMath::reduced) << " (float)" << endl;
+        return 1;
+    }
+    return 0;
+}
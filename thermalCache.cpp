@@ -0,0 +1,128 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include "thermalCache.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    ThermalCacheContainer::ThermalCacheContainer(const ParameterContainer& p) :
+        directory {p.cacheDirectory},
+        I         {0.},
+        a         {0.},
+        theta     {0.} {}
+
+    string ThermalCacheContainer::getFileName(const LatticeContainer& lattice)
+    {
+        return directory + "Thermal" + "_I" + to_string(lattice.I) + "_a" + to_string(lattice.a)
+            + "_xdim" + to_string(lattice.xdim) + "_theta" + to_string(lattice.theta)
+            + "_b" + lattice.boundary;
+    }
+
+    // Sum of relative differences in I and a and difference in theta
+    double ThermalCacheContainer::getDistance(const LatticeContainer& lattice, double IIn, double aIn, double thetaIn)
+    {
+        return fabs(IIn - lattice.I) / lattice.I + fabs(aIn - lattice.a) / lattice.a
+            + fabs(thetaIn - lattice.theta);
+    }
+
+    // Set lattice to nearest cached state with same xdim and boundary
+    bool ThermalCacheContainer::load(LatticeContainer& lattice)
+    {
+        DIR* dir = opendir(directory.c_str());
+        if (dir == NULL)
+            return false;
+
+        // search headers of all states
+        string best;
+        double bestDistance = 0.;
+        double IIn, aIn, thetaIn;
+        int xdimIn;
+        char boundaryIn;
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            string file = entry->d_name;
+            if ((file.compare(0, 7, "Thermal") != 0) || (file.find(".tmp") != string::npos))
+                continue;
+
+            ifstream f(directory + file);
+            if (!(f >> IIn >> aIn >> xdimIn >> thetaIn >> boundaryIn))
+                continue;
+            if ((xdimIn != lattice.xdim) || (boundaryIn != lattice.boundary))
+                continue;
+
+            double distance = getDistance(lattice, IIn, aIn, thetaIn);
+            if (best.empty() || (distance < bestDistance))
+            {
+                best = directory + file;
+                bestDistance = distance;
+                I = IIn;
+                a = aIn;
+                theta = thetaIn;
+            }
+        }
+        closedir(dir);
+
+        if (best.empty())
+            return false;
+
+        ifstream f(best);
+        f >> IIn >> aIn >> xdimIn >> thetaIn >> boundaryIn;
+        for (int i=0; i<lattice.xdim; i++)
+            f >> lattice.tslice[i].phi;
+        if (f.fail())
+        {
+            cerr << "ERROR: Cached state " << best << " is corrupt" << endl;
+            exit(0);
+        }
+        return true;
+    }
+
+    // Deposit state of lattice with unique temporary file and rename
+    // (workers may store the same key at once)
+    void ThermalCacheContainer::store(LatticeContainer& lattice)
+    {
+        struct stat st = {0};
+        if (stat(directory.c_str(), &st) == -1)
+            mkdir(directory.c_str(), 0777);
+
+        string name = getFileName(lattice);
+        vector<char> tmpTemplate(name.begin(), name.end());
+        const string suffix = ".tmp.XXXXXX";
+        tmpTemplate.insert(tmpTemplate.end(), suffix.begin(), suffix.end());
+        tmpTemplate.push_back('\0');
+        int fd = mkstemp(tmpTemplate.data());
+        if (fd == -1)
+        {
+            cerr << "ERROR: State cannot be written to cache " << name << endl;
+            return;
+        }
+        fchmod(fd, 0644);
+        close(fd);
+        string tmpName = tmpTemplate.data();
+        ofstream f(tmpName);
+
+        f.precision(17);
+        f << lattice.I << " " << lattice.a << " " << lattice.xdim << " " << lattice.theta << " "
+          << lattice.boundary << endl;
+        for (int i=0; i<lattice.xdim; i++)
+            f << lattice.tslice[i].phi << "\n";
+
+        f.close();
+        if (!f.good() || (rename(tmpName.c_str(), name.c_str()) != 0))
+        {
+            cerr << "ERROR: State cannot be written to cache " << name << endl;
+            remove(tmpName.c_str());
+        }
+    }
+
+} // TopoOsciSim
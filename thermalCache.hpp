@@ -0,0 +1,73 @@
+#ifndef THERMALCACHE_H
+#define THERMALCACHE_H
+
+#include <iostream>
+#include <string>
+#include "parameters.hpp"
+#include "lattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Directory of thermalized lattices, one file per
+       (I, a, xdim, theta, boundary). A run starts from the nearest
+       state with the same xdim and boundary and deposits its final
+       state.
+    */
+    class ThermalCacheContainer
+    {
+
+    public:
+
+        // Cache directory (empty: no cache)
+        string directory;
+
+        // Parameters of the loaded state
+        double I;
+        double a;
+        double theta;
+
+        ThermalCacheContainer(const ParameterContainer& p);
+
+        bool enabled() { return !directory.empty(); }
+
+        /**
+           Return file name of state of lattice
+
+           @param lattice Lattice
+           @return        Full file name
+        */
+        string getFileName(const LatticeContainer& lattice);
+
+        /**
+           Distance of parameters of cached state to lattice
+
+           @return Sum of relative differences in I and a and
+                   difference in theta
+        */
+        static double getDistance(const LatticeContainer& lattice, double IIn, double aIn, double thetaIn);
+
+        /**
+           Set lattice to nearest cached state with same xdim and
+           boundary
+
+           @param lattice Lattice
+           @return        false if there is no such state
+        */
+        bool load(LatticeContainer& lattice);
+
+        /**
+           Deposit state of lattice atomically (temporary file and
+           rename)
+
+           @param lattice Lattice
+        */
+        void store(LatticeContainer& lattice);
+    };
+
+} // TopoOsciSim
+
+#endif // THERMALCACHE_H
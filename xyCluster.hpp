@@ -0,0 +1,252 @@
+#ifndef XYCLUSTER_H
+#define XYCLUSTER_H
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include "xyLattice.hpp"
+#include "latticeEquilibration.hpp"
+#include "profiler.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Wolff cluster algorithm of ClusterContainer on the
+       D-dimensional XY lattice with tiles of B^D sites. The cluster is
+       grown with a queue over the compile-time stencil instead of
+       walking left and right on the ring. Only the plain update: no
+       tracker, improved estimators, cached bond blocks or instanton
+       moves.
+    */
+    template<int D, int B>
+    class XYClusterContainer : public LatticeEquilibration
+    {
+
+    public:
+
+        // Pointer to XYLatticeContainer
+        XYLatticeContainer<D, B>* lattice;
+
+        // Starting position of cluster algorithm on the lattice
+        int start;
+
+        // Projection angle
+        double angle;
+
+        // clusterSize
+        int size;
+
+        // mean cluster bond probability
+        double bondProb;
+
+        // sites of cluster in order of addition (queue of sites to visit)
+        vector<int> cluster;
+
+        // flag for sites inside cluster
+        vector<char> inCluster;
+
+        FileObs fSize;
+        FileObs fProb;
+        FileObs fMeanPhiSq;
+
+        /**
+           Create XYClusterContainer on lattice
+
+           @param l pointer to XYLatticeContainer
+        */
+        XYClusterContainer(XYLatticeContainer<D, B>* l, const ParameterContainer& p);
+
+        /**
+           Return probability for bond between two sites
+
+           @param projection Projection of first site on angle (before flip)
+           @param site       Second site
+           @return Probability
+        */
+        double getBondProbability(double projection, int site);
+
+        /**
+           Grow cluster from start and flip all its sites
+
+           @param seed Seed number
+        */
+        void createCluster(mt19937_64& seed);
+
+        /**
+           Perform one cluster step (create cluster and flip in
+           cluster)
+
+           @param seed Seed number
+        */
+        void doStep(mt19937_64& seed);
+
+        void doStep(mt19937_64& seed, double deltaIn);
+
+        void writeInfosToFile();
+
+        // observables of the XY lattice are not tracked
+        void setTracker(ObservableTracker* t) {}
+
+        /**
+           Do nSteps steps and measure after every measureEvery-th step
+
+           @param seed         Seed number
+           @param nSteps       Number of steps
+           @param measureEvery Number of steps between measurements
+           @param sink         Gets measurements and diagnostics (NULL: no measurements)
+        */
+        void run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink);
+
+        // Nothing to do after each step of run
+        void finishStep() {}
+
+        // Set lattice mod 2pi and meanPhiSq
+        void prepareMeasurement();
+
+        // Names and values of the diagnostics of one step
+        vector<string> getInfoNames();
+        void appendInfos(vector<double>& values);
+    };
+
+
+    template<int D, int B>
+    XYClusterContainer<D, B>::XYClusterContainer(XYLatticeContainer<D, B>* l, const ParameterContainer& p) :
+        lattice     {l},
+        start       {0},
+        angle       {0},
+        size        {0},
+        bondProb    {0.},
+        inCluster   (l->volume, 0),
+        fSize ("ClusterSize", p),
+        fProb ("ClusterProb", p),
+        fMeanPhiSq ("MeanPhiSq", p)
+    {
+        cluster.reserve(lattice->volume);
+    }
+
+    template<int D, int B>
+    double XYClusterContainer<D, B>::getBondProbability(double projection, int site)
+    {
+        double arg = -2 * (lattice->I / lattice->a) * projection * cos( angle - lattice->phi[site] );
+        return (arg < 0) ? 1 - exp(arg) : 0.;
+    }
+
+    // Grow cluster from start with a queue and flip all its sites
+    template<int D, int B>
+    void XYClusterContainer<D, B>::createCluster(mt19937_64& seed)
+    {
+        uniform_real_distribution< > dist(0,1);
+        double probAdd = 0., projection;
+        int site, Nbonds = 0;
+
+        cluster.clear();
+        cluster.push_back(start);
+        inCluster[start] = 1;
+
+        for (unsigned int head=0; head<cluster.size(); head++)
+        {
+            site = cluster[head];
+
+            // flip site and remember its projection before the flip
+            projection = cos( angle - lattice->phi[site] );
+            lattice->phi[site] = M_PI - lattice->phi[site] + 2 * angle;
+
+            lattice->forEachNeighbour(site, [&](int neighbour)
+            {
+                if (inCluster[neighbour])
+                    return;
+
+                double prob = getBondProbability(projection, neighbour);
+                if (dist(seed) < prob)
+                {
+                    probAdd += prob;
+                    Nbonds++;
+                    inCluster[neighbour] = 1;
+                    cluster.push_back(neighbour);
+                }
+            });
+        }
+
+        size = cluster.size();
+        bondProb = (Nbonds > 0) ? probAdd / (double)Nbonds : 0.;
+    }
+
+    template<int D, int B>
+    void XYClusterContainer<D, B>::doStep(mt19937_64& seed)
+    {
+        // choose random reflection vector (in our case just an angle)
+        uniform_real_distribution< > dist_angle( 0 , 2*M_PI );
+        angle = dist_angle(seed);
+
+        //choose random start point in lattice
+        uniform_int_distribution< > dist_latticePoint( 0 , lattice->volume-1 );
+        start = dist_latticePoint(seed);
+
+        createCluster(seed);
+
+        // reset cluster flags in O(cluster size)
+        for (unsigned int i=0; i<cluster.size(); i++)
+            inCluster[cluster[i]] = 0;
+
+        lattice->algorithm = 'c';
+
+        PROFILE_COUNT(siteUpdates, size);
+        PROFILE_COUNT(clusters, 1);
+        PROFILE_COUNT(clusterSites, size);
+    }
+
+    template<int D, int B>
+    void XYClusterContainer<D, B>::doStep(mt19937_64& seed, double deltaIn)
+    {
+        doStep(seed);
+    }
+
+    template<int D, int B>
+    void XYClusterContainer<D, B>::writeInfosToFile()
+    {
+        // create files with first output
+        if (!fSize.f.is_open())
+        {
+            fSize.create();
+            fProb.create();
+            fMeanPhiSq.create();
+        }
+
+        fSize.printValueToFile(size);
+        fProb.printValueToFile(bondProb);
+        fMeanPhiSq.printValueToFile(lattice->meanPhiSq);
+    }
+
+    template<int D, int B>
+    void XYClusterContainer<D, B>::run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink)
+    {
+        runEquilibration(*this, seed, nSteps, measureEvery, sink);
+    }
+
+    template<int D, int B>
+    void XYClusterContainer<D, B>::prepareMeasurement()
+    {
+        lattice->mod2Pi();
+        lattice->computeMeanPhiSq();
+    }
+
+    template<int D, int B>
+    vector<string> XYClusterContainer<D, B>::getInfoNames()
+    {
+        return {"ClusterSize", "ClusterProb", "MeanPhiSq"};
+    }
+
+    template<int D, int B>
+    void XYClusterContainer<D, B>::appendInfos(vector<double>& values)
+    {
+        values.push_back(size);
+        values.push_back(bondProb);
+        values.push_back(lattice->meanPhiSq);
+    }
+
+} // TopoOsciSim
+
+#endif // XYCLUSTER_H
@@ -0,0 +1,484 @@
+#ifndef XYLATTICE_H
+#define XYLATTICE_H
+
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <array>
+#include <vector>
+#include "file.hpp"
+#include "parameters.hpp"
+#include "lattice.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    // base^n at compile time
+    constexpr int xyPower(int base, int n)
+    {
+        return (n == 0) ? 1 : base * xyPower(base, n-1);
+    }
+
+    template<int D, int B, int Mu, int N>
+    struct XYStencil;
+
+
+    /**
+       D-dimensional XY (O(2)) lattice with xdim sites in every
+       direction. Sites are stored tile by tile, tiles of B^D sites
+       (B = 1: plain row-major order, B has to divide xdim). The
+       neighbour stencil is generated from D and B at compile time:
+       inside a tile the neighbour in direction mu is at the constant
+       offset +-B^mu, only sites on a tile face move to the next tile
+       (stride of D tiles per lattice, wrapped at the lattice
+       boundary). No neighbour table is stored.
+    */
+    template<int D, int B>
+    class XYLatticeContainer
+    {
+
+    public:
+
+        // Number of neighbours of a site (forward directions 0..D-1, backward D..2D-1)
+        static const int Nneighbours = 2*D;
+
+        // Sites of a tile
+        static const int tileVolume = xyPower(B, D);
+
+        double I;
+        double a;
+        int xdim;
+        int volume;
+        double theta;
+        char algorithm;
+        char boundary;
+        double q;
+        double meanPhiSq;
+        vector<double> phi;
+        vector<double> corr;
+
+        // Tiles per direction and distance of neighbouring tiles in
+        // each direction
+        int nBlocks;
+        array<int, D> tileStride;
+
+        XYLatticeContainer(const ParameterContainer& p);
+
+        template<int DD, int BB>
+        friend ostream& operator<<(ostream& out, const XYLatticeContainer<DD, BB> &l);
+
+        /**
+           Return storage index of site
+
+           @param x Coordinates of site
+           @return  Storage index
+        */
+        int getSite(const array<int, D>& x) const;
+
+        /**
+           Return coordinates of site
+
+           @param site Storage index
+           @return     Coordinates of site
+        */
+        array<int, D> getCoordinates(int site) const;
+
+        /**
+           Return storage index of a site in the order of the
+           configuration files
+
+           @param n Lexicographic index sum_mu x[mu] xdim^mu
+           @return  Storage index of the site
+        */
+        int getLexicographicSite(int n) const;
+
+        /**
+           Return neighbour of site in direction Mu (Mu < D: forward,
+           Mu >= D: backward)
+
+           @param site Storage index
+           @return     Storage index of neighbour
+        */
+        template<int Mu>
+        int getNeighbour(int site) const;
+
+        /**
+           Call f(neighbour) for all neighbours of site in the order
+           of the directions (unrolled)
+
+           @param site Storage index
+           @param f    Function of storage index of neighbour
+        */
+        template<class F>
+        void forEachNeighbour(int site, F f) const { XYStencil<D, B, 0, Nneighbours>::apply(*this, site, f); }
+
+        // Like forEachNeighbour for the forward neighbours
+        template<class F>
+        void forEachForwardNeighbour(int site, F f) const { XYStencil<D, B, 0, D>::apply(*this, site, f); }
+
+        /**
+           Return angles of all neighbours of site
+
+           @param site   Storage index
+           @param angles Angles in the order of the directions
+        */
+        void getNeighbourAngles(int site, array<double, Nneighbours>& angles) const;
+
+        void setPeriodicBoundaries();
+        void setZero();
+        void setRandom(mt19937_64& seed);
+        double getActionSummand(int site);
+        double getLocalAction(int site);
+        double getLocalAction(int site, double phiTest);
+
+        /**
+           Return local action of a site with angle phiTest
+
+           @param angles  Angles of neighbours from getNeighbourAngles
+           @param phiTest Angle of site
+           @return        Action of the links of the site
+        */
+        double getLocalAction(const array<double, Nneighbours>& angles, double phiTest) const;
+
+        double getAction();
+        void mod2Pi();
+        void computeQ();
+        void computeCorr();
+        double computeMeanPhiSq();
+
+        void dumpHeader(FileConfig& Out);
+        void readHeader(FileConfig& In);
+        void dumpConf(FileConfig& Out);
+        bool readConf(FileConfig& In);
+    };
+
+
+    // Unrolled loop over the directions Mu ... N-1 of the stencil
+    template<int D, int B, int Mu, int N>
+    struct XYStencil
+    {
+        template<class F>
+        static void apply(const XYLatticeContainer<D, B>& l, int site, F& f)
+        {
+            f(l.template getNeighbour<Mu>(site));
+            XYStencil<D, B, Mu+1, N>::apply(l, site, f);
+        }
+    };
+
+    template<int D, int B, int N>
+    struct XYStencil<D, B, N, N>
+    {
+        template<class F>
+        static void apply(const XYLatticeContainer<D, B>& l, int site, F& f) {}
+    };
+
+
+    template<int D, int B>
+    XYLatticeContainer<D, B>::XYLatticeContainer(const ParameterContainer& p) :
+        I          { p.I     },
+        a          { p.a     },
+        xdim       { p.xdim  },
+        volume     { 1       },
+        theta      { p.theta },
+        algorithm  { '\0'    },
+        boundary   { '\0'    },
+        q          { 0.      },
+        meanPhiSq  { 0.      },
+        nBlocks    { p.xdim / B }
+    {
+        if (xdim % B != 0)
+        {
+            cerr << "ERROR: xdim " << xdim << " is not a multiple of the tile size " << B << endl;
+            exit(0);
+        }
+
+        for (int mu=0; mu<D; mu++)
+        {
+            tileStride[mu] = tileVolume * volume / xyPower(B, mu);
+            volume *= xdim;
+        }
+
+        phi.assign(volume, 0.);
+        corr.assign(xdim, 0.);
+    }
+
+    template<int D, int B>
+    ostream& operator<<(ostream& out, const XYLatticeContainer<D, B> &l)
+    {
+        for (int i=0; i<l.volume; i++)
+            out << " " << l.phi[i];
+        return out;
+    }
+
+    // Return storage index of site (tile index, then index inside tile)
+    template<int D, int B>
+    int XYLatticeContainer<D, B>::getSite(const array<int, D>& x) const
+    {
+        int tile = 0, inTile = 0, tileStrideMu = 1, inTileStride = 1;
+        for (int mu=0; mu<D; mu++)
+        {
+            tile   += (x[mu] / B) * tileStrideMu;
+            inTile += (x[mu] % B) * inTileStride;
+            tileStrideMu *= nBlocks;
+            inTileStride *= B;
+        }
+        return tile * tileVolume + inTile;
+    }
+
+    template<int D, int B>
+    array<int, D> XYLatticeContainer<D, B>::getCoordinates(int site) const
+    {
+        int tile = site / tileVolume, inTile = site % tileVolume;
+        array<int, D> x;
+        for (int mu=0; mu<D; mu++)
+        {
+            x[mu] = (tile % nBlocks) * B + inTile % B;
+            tile   /= nBlocks;
+            inTile /= B;
+        }
+        return x;
+    }
+
+    // Constant offset inside the tile, to the next tile (or around the
+    // lattice) on a tile face
+    template<int D, int B>
+    template<int Mu>
+    int XYLatticeContainer<D, B>::getNeighbour(int site) const
+    {
+        const int mu = Mu % D;
+        const int stride = xyPower(B, mu);
+        const int inTile = (site / stride) % B;
+
+        if (Mu < D)
+        {
+            if (inTile < B-1)
+                return site + stride;
+            int tile = (site / tileStride[mu]) % nBlocks;
+            return site - (B-1)*stride + ((tile < nBlocks-1) ? tileStride[mu] : -(nBlocks-1)*tileStride[mu]);
+        }
+        else
+        {
+            if (inTile > 0)
+                return site - stride;
+            int tile = (site / tileStride[mu]) % nBlocks;
+            return site + (B-1)*stride + ((tile > 0) ? -tileStride[mu] : (nBlocks-1)*tileStride[mu]);
+        }
+    }
+
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::getNeighbourAngles(int site, array<double, Nneighbours>& angles) const
+    {
+        int k = 0;
+        forEachNeighbour(site, [&](int neighbour) { angles[k++] = phi[neighbour]; });
+    }
+
+    // The stencil is periodic
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::setPeriodicBoundaries()
+    {
+        boundary = 'p';
+    }
+
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::setZero()
+    {
+        for (int i=0; i<volume; i++)
+            phi[i] = 0.;
+    }
+
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::setRandom(mt19937_64& seed)
+    {
+        uniform_real_distribution< > dist( 0 , 2*M_PI );
+        for (int i=0; i<volume; i++)
+            phi[i] = dist(seed);
+    }
+
+    // Action of all forward links of site
+    template<int D, int B>
+    double XYLatticeContainer<D, B>::getActionSummand(int site)
+    {
+        double sum = 0.;
+        forEachForwardNeighbour(site, [&](int neighbour) { sum += 1. - cos(phi[neighbour] - phi[site]); });
+        return I/a * sum;
+    }
+
+    template<int D, int B>
+    double XYLatticeContainer<D, B>::getLocalAction(int site)
+    {
+        return getLocalAction(site, phi[site]);
+    }
+
+    template<int D, int B>
+    double XYLatticeContainer<D, B>::getLocalAction(int site, double phiTest)
+    {
+        array<double, Nneighbours> angles;
+        getNeighbourAngles(site, angles);
+        return getLocalAction(angles, phiTest);
+    }
+
+    template<int D, int B>
+    double XYLatticeContainer<D, B>::getLocalAction(const array<double, Nneighbours>& angles, double phiTest) const
+    {
+        double sum = 0.;
+        for (int mu=0; mu<Nneighbours; mu++)
+            sum += 1. - cos(angles[mu] - phiTest);
+        return I/a * sum;
+    }
+
+    template<int D, int B>
+    double XYLatticeContainer<D, B>::getAction()
+    {
+        double sum = 0.;
+        for (int i=0; i<volume; i++)
+            sum += getActionSummand(i);
+        return sum;
+    }
+
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::mod2Pi()
+    {
+        for (int i=0; i<volume; i++)
+            phi[i] = phi[i] - 2 * M_PI * round(phi[i] / (2 * M_PI));
+    }
+
+    // Compute winding in direction 0, averaged over all lines in direction 0
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::computeQ()
+    {
+        double sum = 0.;
+        for (int i=0; i<volume; i++)
+            sum += LatticeContainer::getWrappedDifference(phi[getNeighbour<0>(i)] - phi[i]);
+        q = 1./(2*M_PI) * sum / (double)(volume / xdim);
+    }
+
+    // Compute spin correlation <cos(phi_x - phi_{x + r e_0})>
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::computeCorr()
+    {
+        for (int r=0; r<xdim; r++)
+            corr[r] = 0.;
+
+        int site;
+        for (int i=0; i<volume; i++)
+        {
+            site = i;
+            for (int r=0; r<xdim; r++)
+            {
+                corr[r] += cos(phi[i] - phi[site]);
+                site = getNeighbour<0>(site);
+            }
+        }
+
+        for (int r=0; r<xdim; r++)
+            corr[r] /= volume;
+    }
+
+    template<int D, int B>
+    double XYLatticeContainer<D, B>::computeMeanPhiSq()
+    {
+        double res = 0.;
+        for (int i=0; i<volume; i++)
+            res += phi[i] * phi[i];
+
+        meanPhiSq = res / (double)volume;
+        return meanPhiSq;
+    }
+
+    // Write Lattice infos to file
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::dumpHeader(FileConfig& Out)
+    {
+        int dim = D;
+        Out.f.write(reinterpret_cast<char*>(&I),    sizeof(I));
+        Out.f.write(reinterpret_cast<char*>(&a),    sizeof(a));
+        Out.f.write(reinterpret_cast<char*>(&xdim), sizeof(xdim));
+        Out.f.write(&boundary,                      sizeof(boundary));
+        Out.f.write(&algorithm,                     sizeof(algorithm));
+        Out.f.write(reinterpret_cast<char*>(&dim),  sizeof(dim));
+
+        if (!Out.f.good())
+            cerr << "ERROR in header writing to " << Out.name.fullName << endl;
+    }
+
+    // Read Lattice infos from file
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::readHeader(FileConfig& In)
+    {
+        int dim;
+        In.f.read(reinterpret_cast<char*>(&I),    sizeof(I));
+        In.f.read(reinterpret_cast<char*>(&a),    sizeof(a));
+        In.f.read(reinterpret_cast<char*>(&xdim), sizeof(xdim));
+        In.f.read(&boundary,                      sizeof(boundary));
+        In.f.read(&algorithm,                     sizeof(algorithm));
+        In.f.read(reinterpret_cast<char*>(&dim),  sizeof(dim));
+
+        if (boundary == 'p')
+            setPeriodicBoundaries();
+
+        if (!In.f.good())
+            cerr << "ERROR in header reading from file " << In.name.fullName << endl;
+        else if (dim != D)
+        {
+            cerr << "ERROR: configuration file " << In.name.fullName << " has dimension " << dim << endl;
+            exit(0);
+        }
+    }
+
+    // Return storage index of the site with lexicographic index n
+    // (x[0] fastest), the order of the configuration files
+    template<int D, int B>
+    int XYLatticeContainer<D, B>::getLexicographicSite(int n) const
+    {
+        array<int, D> x;
+        for (int mu=0; mu<D; mu++)
+        {
+            x[mu] = n % xdim;
+            n /= xdim;
+        }
+        return getSite(x);
+    }
+
+    // Write Lattice to file (in lexicographic order, independent of B)
+    template<int D, int B>
+    void XYLatticeContainer<D, B>::dumpConf(FileConfig& Out)
+    {
+        vector<double> buffer(volume);
+        for (int n=0; n<volume; n++)
+            buffer[n] = phi[getLexicographicSite(n)];
+        Out.f.write(reinterpret_cast<char*>(buffer.data()), volume * sizeof(double));
+
+        if (!Out.f.good())
+            cerr << "ERROR in configuration writing" << endl;
+    }
+
+    // Read Lattice from file (in lexicographic order)
+    template<int D, int B>
+    bool XYLatticeContainer<D, B>::readConf(FileConfig& In)
+    {
+        vector<double> buffer(volume);
+        In.f.read(reinterpret_cast<char*>(buffer.data()), volume * sizeof(double));
+        if (In.f.good())
+            for (int n=0; n<volume; n++)
+                phi[getLexicographicSite(n)] = buffer[n];
+
+        if (In.f.good())
+            ;
+        else if ((In.f.eof()) && (In.f.gcount() == 0))
+            cerr << "Regular configuration file end is reached" << endl;
+        else if (In.f.eof())
+        {
+            cerr << "ERROR: Unregular configuration file end is reached" << endl;
+            exit(0);
+        }
+        else
+            cerr << "ERROR in Configuration reading from file " << In.name.fullName << endl;
+
+        return (In.f.good());
+    }
+
+} // TopoOsciSim
+
+#endif // XYLATTICE_H
@@ -0,0 +1,168 @@
+#ifndef XYMETROPOLIS_H
+#define XYMETROPOLIS_H
+
+#include <iostream>
+#include <random>
+#include <array>
+#include "xyLattice.hpp"
+#include "latticeEquilibration.hpp"
+#include "profiler.hpp"
+
+using namespace std;
+
+namespace TopoOsciSim
+{
+
+    /**
+       Sequential Metropolis sweep of MetropolisContainer on the
+       D-dimensional XY lattice with tiles of B^D sites. Only the
+       plain update: no tracker, fastMath, instanton moves,
+       metadynamics or checkpoint state.
+    */
+    template<int D, int B>
+    class XYMetropolisContainer : public LatticeEquilibration
+    {
+
+    public:
+
+        // Pointer to XYLatticeContainer
+        XYLatticeContainer<D, B>* lattice;
+
+        // vicinity of old link to look for new one
+        double delta;
+
+        double acceptance;
+        FileObs fAcc;
+        FileObs fMeanPhiSq;
+
+        /**
+           Create XYMetropolisContainer on lattice
+
+           @param l pointer to XYLatticeContainer
+        */
+        XYMetropolisContainer(XYLatticeContainer<D, B>* l, const ParameterContainer& p);
+
+        /**
+           Do one sweep over the lattice in storage (tile) order
+
+           @param seed    Seed number
+           @param deltaIn Vicinity of old angle to look for new one
+        */
+        void doStep(mt19937_64& seed, double deltaIn);
+
+        void doStep(mt19937_64& seed);
+
+        void writeInfosToFile();
+
+        // observables of the XY lattice are not tracked
+        void setTracker(ObservableTracker* t) {}
+
+        /**
+           Do nSteps steps and measure after every measureEvery-th step
+
+           @param seed         Seed number
+           @param nSteps       Number of steps
+           @param measureEvery Number of steps between measurements
+           @param sink         Gets measurements and diagnostics (NULL: no measurements)
+        */
+        void run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink);
+
+        // Nothing to do after each step of run
+        void finishStep() {}
+
+        // Set lattice mod 2pi and meanPhiSq
+        void prepareMeasurement();
+
+        // Names and values of the diagnostics of one step
+        vector<string> getInfoNames();
+        void appendInfos(vector<double>& values);
+    };
+
+
+    template<int D, int B>
+    XYMetropolisContainer<D, B>::XYMetropolisContainer(XYLatticeContainer<D, B>* l, const ParameterContainer& p) :
+        lattice     {l},
+        delta       {p.deltaMetro},
+        acceptance  (0.),
+        fAcc        ("MetropolisAcc", p),
+        fMeanPhiSq  ("MeanPhiSq", p)
+    {}
+
+    template<int D, int B>
+    void XYMetropolisContainer<D, B>::doStep(mt19937_64& seed, double deltaIn)
+    {
+        uniform_real_distribution< > dist(0 , 1);
+
+        int acceptCount = 0;
+        double phiNew, deltaS;
+        array<double, XYLatticeContainer<D, B>::Nneighbours> angles;
+        for (int i=0; i<lattice->volume; i++)
+        {
+            phiNew = lattice->phi[i] + deltaIn * (2*dist(seed) - 1);
+
+            // neighbours from the compile-time stencil, once per site
+            lattice->getNeighbourAngles(i, angles);
+            deltaS = lattice->getLocalAction(angles, phiNew) - lattice->getLocalAction(angles, lattice->phi[i]);
+
+            if (dist(seed) <= exp(-deltaS))
+            {
+                lattice->phi[i] = phiNew;
+                acceptCount += 1;
+            }
+        }
+        lattice->algorithm = 'm';
+        acceptance = acceptCount / (double) lattice->volume;
+
+        PROFILE_COUNT(siteUpdates, lattice->volume);
+        PROFILE_COUNT(accepts, acceptCount);
+    }
+
+    template<int D, int B>
+    void XYMetropolisContainer<D, B>::doStep(mt19937_64& seed)
+    {
+        XYMetropolisContainer::doStep(seed, delta);
+    }
+
+    template<int D, int B>
+    void XYMetropolisContainer<D, B>::writeInfosToFile()
+    {
+        // create files with first output
+        if (!fAcc.f.is_open())
+        {
+            fAcc.create();
+            fMeanPhiSq.create();
+        }
+
+        fAcc.printValueToFile(acceptance);
+        fMeanPhiSq.printValueToFile(lattice->meanPhiSq);
+    }
+
+    template<int D, int B>
+    void XYMetropolisContainer<D, B>::run(mt19937_64& seed, int nSteps, int measureEvery, MeasurementSink* sink)
+    {
+        runEquilibration(*this, seed, nSteps, measureEvery, sink);
+    }
+
+    template<int D, int B>
+    void XYMetropolisContainer<D, B>::prepareMeasurement()
+    {
+        lattice->mod2Pi();
+        lattice->computeMeanPhiSq();
+    }
+
+    template<int D, int B>
+    vector<string> XYMetropolisContainer<D, B>::getInfoNames()
+    {
+        return {"MetropolisAcc", "MeanPhiSq"};
+    }
+
+    template<int D, int B>
+    void XYMetropolisContainer<D, B>::appendInfos(vector<double>& values)
+    {
+        values.push_back(acceptance);
+        values.push_back(lattice->meanPhiSq);
+    }
+
+} // TopoOsciSim
+
+#endif // XYMETROPOLIS_H